@@ -48,6 +48,16 @@ class AIMBattVoltTransform : public DataTransformer {
       return yy;
     }
 
+    /**
+     *
+     * inverseForm() - what inverse() works out to.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Linear, 0, 1000.0);
+    }
+
     /* standard destructor */
 
     virtual ~AIMBattVoltTransform() {
@@ -0,0 +1,132 @@
+#ifndef AIMCANSINK_HH
+#define AIMCANSINK_HH
+
+#include "OutputSink.hh"
+#include "AIMProtocol.hh"
+#include "CANSocket.hh"
+
+/* the CAN id the stream goes out on, unless can_id says otherwise */
+
+enum AIMCANDefaultId {AIMCANDefaultId=0x5F0};
+
+/**
+ *
+ * AIMCANSink - the output (SoloDL) channels on a CAN bus, in the AIM
+ * sequential CAN protocol (see aimSequential()), for the newer AIM
+ * loggers.  Unlike the UART every channel goes out every time, at
+ * rate_hz; at 50 Hz that's 250 frames a second, a few % of a 500
+ * kbit bus.  Each stream's frames go to the kernel in one sendmmsg()
+ * (see CANSocket).  Its section of the configuration has:
+ *
+ *   type      - aimcan
+ *   interface - the SocketCAN interface, default can0
+ *   can_id    - the (11 bit) CAN id, default 0x5F0
+ *   rate_hz   - streams a second, 1..the sender's tick rate, default
+ *               the tick rate
+ *
+ * It isn't on the cable, so it doesn't need to be in [PortMapper], and
+ * it stays open when the cable is unplugged.
+ *
+ */
+
+class AIMCANSink : public OutputSink {
+
+  private:
+
+    CANSocket *port;
+
+    string ifName;
+
+    canid_t canId;
+
+    /* the frames of one stream, only the data changes */
+
+    struct can_frame frames[AIMSeqFrames];
+
+    /* CAN frames sent, streams that didn't all go out */
+
+    std::atomic<unsigned long> canFrames;
+    std::atomic<unsigned long> dropped;
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    AIMCANSink(const string & sinkName) : OutputSink("AIMCANSink", sinkName),
+      port(NULL), ifName("can0"), canId(AIMCANDefaultId), canFrames(0), dropped(0) {
+
+    }
+
+    /**
+     *
+     * configure() - read interface, can_id and rate_hz from the
+     * sink's section.
+     *
+     * @param hz int - the sender's tick rate.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool configure(int hz);
+
+    /* it's on the CAN bus, not the cable */
+
+    virtual bool onCable(void) const {
+      return false;
+    }
+
+    using OutputSink::open;
+
+    /**
+     *
+     * open() - open the CAN socket.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool open(void);
+
+    /**
+     *
+     * close() - close the CAN socket.
+     *
+     */
+
+    virtual void close(void);
+
+    virtual bool isOpen(void) {
+      return port != NULL;
+    }
+
+    /**
+     *
+     * send() - if a stream is due on this tick, send it.
+     *
+     * @param frame SampleFrame - the current values.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool send(const SampleFrame & frame);
+
+    /**
+     *
+     * describe() - CAN frames sent and streams dropped, too.
+     *
+     */
+
+    virtual string describe(void);
+
+    /* standard destructor */
+
+    virtual ~AIMCANSink(void) {
+      close();
+    }
+};
+
+#endif
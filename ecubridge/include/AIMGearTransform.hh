@@ -51,6 +51,26 @@ class AIMGearTransform : public DataTransformer {
       return x;
     }
 
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return TransformForm(Form::Clamp, 3);
+    }
+
+    /**
+     *
+     * inverseForm() - what inverse() works out to.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Clamp, 3);
+    }
+
     /* standard destructor */
 
     virtual ~AIMGearTransform() {
@@ -47,6 +47,16 @@ class AIMLambdaTransform : public DataTransformer {
       return yy;
     }
 
+    /**
+     *
+     * inverseForm() - what inverse() works out to.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Linear, 0, 1000.0);
+    }
+
     /* standard destructor */
 
     virtual ~AIMLambdaTransform() {
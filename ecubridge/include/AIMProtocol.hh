@@ -0,0 +1,325 @@
+#ifndef AIMPROTOCOL_HH
+#define AIMPROTOCOL_HH
+
+/**
+ *
+ * AIM UART protocol - what the SoloDL expects to see.  Every value is
+ * sent as its own 5 byte packet:
+ *
+ *   channel id  - see AIMChannel
+ *   0xA3        - the header
+ *   value       - 2 bytes, high byte first (already in AIM units)
+ *   checksum    - sum of the 4 bytes before it, mod 256
+ *
+ * and each channel is sent at its own rate (see AIMFreq).  All of it
+ * is known at compile time, so it's here as constexpr tables and
+ * functions; the sender only adds the two data bytes to a checksum
+ * that is already worked out.  See prototype/AimWriter.py for the
+ * reference implementation, and test/aimtest.cc.
+ *
+ */
+
+enum SoloDLChannelMax {SoloDLChannelMax=15};
+
+/* the header byte, and how big a packet is */
+
+enum AIMHeader {AIMHeader=0xA3};
+enum AIMPacketSize {AIMPacketSize=5};
+
+/**
+ *
+ * Channel ids (in order) for the supported data channel
+ * types
+ *
+ */
+
+enum class AIMChannel {
+  RPM           = 1,
+  WHEELSPEED    = 5,
+  OILPRESS      = 9,
+  OILTEMP       = 13,
+  WATERTEMP     = 17,
+  FUELPRESS     = 21,
+  BATTVOLT      = 33,
+  THROTANG      = 45,
+  MANIFPRESS    = 69,
+  AIRCHARGETEMP = 97,
+  EXHTEMP       = 101,
+  LAMBDA        = 105,
+  FUELTEMP      = 109,
+  GEAR          = 113,
+  ERRORFLAG     = 125,
+};
+
+/**
+ *
+ * Channel sample rates (in Hz. and in order)
+ *
+ */
+
+enum class AIMFreq {
+  RPM           = 10,
+  WHEELSPEED    = 10,
+  OILPRESS      = 5,
+  OILTEMP       = 2,
+  WATERTEMP     = 2,
+  FUELPRESS     = 5,
+  BATTVOLT      = 5,
+  THROTANG      = 10,
+  MANIFPRESS    = 10,
+  AIRCHARGETEMP = 2,
+  EXHTEMP       = 2,
+  LAMBDA        = 10,
+  FUELTEMP      = 2,
+  GEAR          = 5,
+  ERRORFLAG     = 2,
+};
+
+/**
+ *
+ * AIMIds - the SoloDL channel id of each of our channels, [1]..[15]
+ * (see SoloDLPort::writeSamples() for the order).
+ *
+ */
+
+constexpr unsigned char AIMIds[SoloDLChannelMax+1] = {
+  0,
+  (unsigned char)AIMChannel::RPM,
+  (unsigned char)AIMChannel::WHEELSPEED,
+  (unsigned char)AIMChannel::OILPRESS,
+  (unsigned char)AIMChannel::OILTEMP,
+  (unsigned char)AIMChannel::WATERTEMP,
+  (unsigned char)AIMChannel::FUELPRESS,
+  (unsigned char)AIMChannel::BATTVOLT,
+  (unsigned char)AIMChannel::THROTANG,
+  (unsigned char)AIMChannel::MANIFPRESS,
+  (unsigned char)AIMChannel::AIRCHARGETEMP,
+  (unsigned char)AIMChannel::EXHTEMP,
+  (unsigned char)AIMChannel::LAMBDA,
+  (unsigned char)AIMChannel::FUELTEMP,
+  (unsigned char)AIMChannel::GEAR,
+  (unsigned char)AIMChannel::ERRORFLAG
+};
+
+/* AIMRates - the protocol rate (Hz) of each channel, same order */
+
+constexpr int AIMRates[SoloDLChannelMax+1] = {
+  0,
+  (int)AIMFreq::RPM,
+  (int)AIMFreq::WHEELSPEED,
+  (int)AIMFreq::OILPRESS,
+  (int)AIMFreq::OILTEMP,
+  (int)AIMFreq::WATERTEMP,
+  (int)AIMFreq::FUELPRESS,
+  (int)AIMFreq::BATTVOLT,
+  (int)AIMFreq::THROTANG,
+  (int)AIMFreq::MANIFPRESS,
+  (int)AIMFreq::AIRCHARGETEMP,
+  (int)AIMFreq::EXHTEMP,
+  (int)AIMFreq::LAMBDA,
+  (int)AIMFreq::FUELTEMP,
+  (int)AIMFreq::GEAR,
+  (int)AIMFreq::ERRORFLAG
+};
+
+/**
+ *
+ * AIMCANScale - how a channel's UART value becomes its PROT_CAN value;
+ * the two protocols don't share units (see the tables in
+ * docs/AiM_SequentialCAN+UART_100_eng.pdf):
+ *
+ *   can = round(uart / div) + offset
+ *
+ * i.e. pressures are x/1000 bar on the UART but 0.1 bar on CAN (div
+ * 100), temperatures are x/10-100 on the UART but 0.1 deg C (offset
+ * -1000) or, for EGT, 1 deg C on CAN, and the UART's gear 1 is
+ * neutral where it's 0 on CAN.  The rest are the same on both.  A
+ * negative result (below 0 deg C, or reverse gear) goes out as a
+ * 16 bit two's complement value.
+ *
+ */
+
+struct AIMCANScale {
+  int div;
+  int offset;
+};
+
+/* AIMCANScales - the AIMCANScale of each channel, same order as AIMIds */
+
+constexpr AIMCANScale AIMCANScales[SoloDLChannelMax+1] = {
+  {1,   0},
+  {1,   0},       /* RPM - 1 RPM */
+  {1,   0},       /* WHEELSPEED - 0.1 km/h */
+  {100, 0},       /* OILPRESS - 0.1 bar */
+  {1,   -1000},   /* OILTEMP - 0.1 deg C */
+  {1,   -1000},   /* WATERTEMP - 0.1 deg C */
+  {100, 0},       /* FUELPRESS - 0.1 bar */
+  {1,   0},       /* BATTVOLT - 0.01 V */
+  {1,   0},       /* THROTANG - 0.1 % */
+  {1,   0},       /* MANIFPRESS - 1 mbar */
+  {1,   -1000},   /* AIRCHARGETEMP - 0.1 deg C */
+  {10,  -100},    /* EXHTEMP - 1 deg C */
+  {1,   0},       /* LAMBDA - 0.001 */
+  {1,   -1000},   /* FUELTEMP - 0.1 deg C */
+  {1,   -1},      /* GEAR - 0 is neutral */
+  {1,   0}        /* ERRORFLAG */
+};
+
+/**
+ *
+ * aimCANValue() - a channel's UART value (the 16 bits the UART would
+ * carry) in PROT_CAN units, as the 16 bits that go out on CAN.
+ *
+ */
+
+constexpr unsigned int aimCANValue(int chan, unsigned int value) {
+  return (unsigned int)((int)(((value & 0xFFFF) + AIMCANScales[chan].div / 2) / AIMCANScales[chan].div)
+    + AIMCANScales[chan].offset) & 0xFFFF;
+}
+
+/**
+ *
+ * aimIdSum() - the checksum of a channel's constant bytes (its id
+ * and the header).
+ *
+ */
+
+constexpr unsigned char aimIdSum(int chan) {
+  return (unsigned char)((AIMIds[chan] + AIMHeader) & 0xFF);
+}
+
+/* AIMIdSums - aimIdSum() of every channel, same order */
+
+constexpr unsigned char AIMIdSums[SoloDLChannelMax+1] = {
+  0,
+  aimIdSum(1),  aimIdSum(2),  aimIdSum(3),  aimIdSum(4),  aimIdSum(5),
+  aimIdSum(6),  aimIdSum(7),  aimIdSum(8),  aimIdSum(9),  aimIdSum(10),
+  aimIdSum(11), aimIdSum(12), aimIdSum(13), aimIdSum(14), aimIdSum(15)
+};
+
+/**
+ *
+ * aimChecksum() - the checksum byte of a channel's packet carrying
+ * 'value'.
+ *
+ */
+
+constexpr unsigned char aimChecksum(int chan, unsigned int value) {
+  return (unsigned char)((AIMIdSums[chan] + ((value >> 8) & 0xFF) + (value & 0xFF)) & 0xFF);
+}
+
+/**
+ *
+ * aimLoad() - packets a second the protocol rates add up to (for
+ * channels chan..SoloDLChannelMax).
+ *
+ */
+
+constexpr int aimLoad(int chan=1) {
+  return (chan > SoloDLChannelMax) ? 0 : (AIMRates[chan] + aimLoad(chan+1));
+}
+
+/**
+ *
+ * AIMPacket - one whole packet, for when the channel and value are
+ * known at compile time (the tests, or a constant channel).
+ *
+ */
+
+struct AIMPacket {
+  unsigned char bytes[AIMPacketSize];
+};
+
+template<int Chan>
+constexpr AIMPacket aimPacket(unsigned int value) {
+
+  static_assert((Chan >= 1) && (Chan <= SoloDLChannelMax), "AIM channels are 1..15");
+
+  return AIMPacket{{
+    AIMIds[Chan],
+    (unsigned char)AIMHeader,
+    (unsigned char)((value >> 8) & 0xFF),
+    (unsigned char)(value & 0xFF),
+    aimChecksum(Chan, value)
+  }};
+}
+
+/**
+ *
+ * aimEncode() - write a channel's packet carrying 'value' to 'p'
+ * (AIMPacketSize bytes).  The sender's version of aimPacket(), no
+ * branches and nothing to work out but the data bytes.
+ *
+ */
+
+inline void aimEncode(unsigned char *p, int chan, unsigned int value) {
+
+  unsigned char hi = (value >> 8) & 0xFF;
+  unsigned char lo = value & 0xFF;
+
+  p[0] = AIMIds[chan];
+  p[1] = AIMHeader;
+  p[2] = hi;
+  p[3] = lo;
+  p[4] = (AIMIdSums[chan] + hi + lo) & 0xFF;
+}
+
+/**
+ *
+ * AIM sequential CAN protocol (PROT_CAN) - the same 15 channels, in
+ * their own units (see aimCANValue()), but all of them every time, as
+ * one 35 byte data stream:
+ *
+ *   0..29  - channels 1..15, 2 bytes each, low byte first (AIM CAN
+ *            is little endian)
+ *   30     - # of data bytes (30)
+ *   31..33 - the markers 0xFC 0xFB 0xFA
+ *   34     - checksum, sum of bytes 0..33 mod 256
+ *
+ * The stream is cut into 8 byte CAN frames (the last one is 3 bytes)
+ * all sent on one CAN id; the logger finds the markers and knows the
+ * next frame starts a new stream.  See docs/AiM_SequentialCAN+UART_100_eng.pdf
+ *
+ */
+
+enum AIMSeqDataBytes {AIMSeqDataBytes=2*SoloDLChannelMax};
+enum AIMSeqSize {AIMSeqSize=AIMSeqDataBytes+5};
+enum AIMSeqFrames {AIMSeqFrames=(AIMSeqSize+7)/8};
+
+constexpr unsigned char AIMSeqMarkers[3] = {0xFC, 0xFB, 0xFA};
+
+/* the checksum of the constant tail (count and markers) */
+
+constexpr unsigned char AIMSeqTailSum =
+  (unsigned char)((AIMSeqDataBytes + AIMSeqMarkers[0] + AIMSeqMarkers[1] + AIMSeqMarkers[2]) & 0xFF);
+
+/**
+ *
+ * aimSequential() - write the data stream for values[1]..[15] to 's'
+ * (AIMSeqSize bytes); the values are already in PROT_CAN units.
+ *
+ */
+
+inline void aimSequential(unsigned char *s, const unsigned int *values) {
+
+  unsigned int sum = AIMSeqTailSum;
+
+  for(int chan=1; chan<=SoloDLChannelMax; chan++) {
+
+    unsigned char lo = values[chan] & 0xFF;
+    unsigned char hi = (values[chan] >> 8) & 0xFF;
+
+    s[2*(chan-1)]   = lo;
+    s[2*(chan-1)+1] = hi;
+
+    sum += lo + hi;
+  }
+
+  s[AIMSeqDataBytes]   = AIMSeqDataBytes;
+  s[AIMSeqDataBytes+1] = AIMSeqMarkers[0];
+  s[AIMSeqDataBytes+2] = AIMSeqMarkers[1];
+  s[AIMSeqDataBytes+3] = AIMSeqMarkers[2];
+  s[AIMSeqDataBytes+4] = sum & 0xFF;
+}
+
+#endif
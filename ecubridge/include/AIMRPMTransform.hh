@@ -41,6 +41,26 @@ class AIMRPMTransform : public DataTransformer {
       return x;
     }
 
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return TransformForm(Form::Identity);
+    }
+
+    /**
+     *
+     * inverseForm() - what inverse() works out to.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Identity);
+    }
+
     /* standard destructor */
 
     virtual ~AIMRPMTransform() {
@@ -47,6 +47,17 @@ class AIMWaterTempTransform : public DataTransformer {
       return yy;
     }
 
+    /**
+     *
+     * inverseForm() - what inverse() works out to; (x + 100) * 10
+     * is x * 10 + 1000 exactly, for any x.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Linear, 0, 10.0, 1000.0);
+    }
+
     /* standard destructor */
 
     virtual ~AIMWaterTempTransform() {
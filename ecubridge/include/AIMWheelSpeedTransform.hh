@@ -49,6 +49,26 @@ class AIMWheelSpeedTransform : public DataTransformer {
       return yy;
     }
 
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return TransformForm(Form::Identity);
+    }
+
+    /**
+     *
+     * inverseForm() - what inverse() works out to.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Identity);
+    }
+
     /* standard destructor */
 
     virtual ~AIMWheelSpeedTransform() {
@@ -0,0 +1,239 @@
+#ifndef CANINPUT_HH
+#define CANINPUT_HH
+
+#include "Object.hh"
+#include "ChannelManager.hh"
+#include "CANSocket.hh"
+
+#include <algorithm>
+#include <atomic>
+
+/* the most frames we pick up in one read */
+
+enum CANInputBatch {CANInputBatch=32};
+
+/**
+ *
+ * CANField - where one input channel's value is in which CAN frame.
+ * Bits are counted so a byte aligned field always starts at byte * 8:
+ *
+ *   little endian (Intel)    - start is the field's lowest bit,
+ *                              counting from bit 0 of byte 0
+ *   big endian               - start is the field's highest bit,
+ *                              counting from the top bit of byte 0
+ *
+ * A .dbc file's Motorola start bit (the highest bit, numbered byte * 8
+ * + bit, with bit 0 the low bit of its byte) is turned into the big
+ * endian one when it's parsed (see CANInput::parseField()); Intel is
+ * the same either way.
+ *
+ */
+
+struct CANField {
+
+  /* the frame's id (CAN_EFF_FLAG set for an extended id) */
+
+  canid_t id;
+
+  /* the input channel, 1..CMMaxChannels */
+
+  int chan;
+
+  int start;
+  int bits;
+
+  bool bigEndian;
+};
+
+/**
+ *
+ * CANInput - input channels from a CAN bus (sensors or an ECU that
+ * talk CAN), alongside the DL-32.  The [can input] section maps CAN
+ * ids and bit fields to input channels:
+ *
+ *   interface = can0
+ *   chan_6    = 0x5F3, 16, 16, little
+ *
+ * i.e. channel 6 is the 16 bits starting at bit 16 (bytes 2 and 3,
+ * low byte first) of frame 0x5F3.  Only the mapped ids get past the
+ * kernel's filter (CAN_RAW_FILTER) so the rest of the bus traffic
+ * never wakes the acquisition thread, and frames are picked up in
+ * batches (see CANSocket::receive()).  The values go in the raw input
+ * like the DL-32's do, through the same input filters and patches.
+ *
+ * Threads: everything but describe() is the acquisition thread's.
+ *
+ */
+
+class CANInput : public Object {
+
+  private:
+
+    string ifName;
+
+    CANSocket *port;
+
+    /* the mapped fields, and the distinct ids they're in */
+
+    vector<CANField> fields;
+    vector<canid_t>  ids;
+
+    struct can_frame batch[CANInputBatch];
+
+    /* frames read, values decoded, receive() calls */
+
+    std::atomic<unsigned long> frames;
+    std::atomic<unsigned long> decoded;
+    std::atomic<unsigned long> reads;
+
+    /* isOpen(), for describe() */
+
+    std::atomic<bool> opened;
+
+    /**
+     *
+     * parseField() - (configure() helper) parse a chan_N setting:
+     *
+     *   id, start bit, # of bits [, little|big|motorola]
+     *
+     * An id with an 'x' on the end (0x5F3x) is an extended id, so are
+     * any above 0x7FF.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool parseField(int chan, const string & spec, CANField & field);
+
+    CANInput(const CANInput &);
+    CANInput &operator=(const CANInput &);
+
+  protected:
+
+  public:
+
+    /* standard constructor, configures from [can input] */
+
+    CANInput(void);
+
+    /**
+     *
+     * configure() - read the interface and the channel mapping from
+     * [can input]; no mapped channels means no CAN input (see
+     * isEnabled()).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool configure(void);
+
+    /**
+     *
+     * isEnabled() - true if any channels are mapped.
+     *
+     */
+
+    bool isEnabled(void) const {
+      return !fields.empty();
+    }
+
+    /**
+     *
+     * open() - open the CAN socket and set its filter.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool open(void);
+
+    /**
+     *
+     * close() - close the CAN socket.
+     *
+     */
+
+    void close(void);
+
+    bool isOpen(void) const {
+      return port != NULL;
+    }
+
+    int getHandle(void) const {
+      return (port != NULL) ? port->getHandle() : -1;
+    }
+
+    /**
+     *
+     * extract() - a field's value from a frame.
+     *
+     * @param frame can_frame - the frame.
+     *
+     * @param field CANField - the field.
+     *
+     * @param value unsigned int - the value.
+     *
+     * @return bool - exactly false if the frame is too short.
+     *
+     */
+
+    static bool extract(const struct can_frame & frame, const CANField & field, unsigned int & value);
+
+    /**
+     *
+     * decode() - put every field the frame carries in 'samples'.
+     *
+     * @param frame can_frame - the frame.
+     *
+     * @param samples unsigned int array - the input channels, at
+     * least CMMaxChannels+1.
+     *
+     * @param which unsigned int pointer - if not NULL, the bit for each
+     * channel set (1 << chan) is turned on.
+     *
+     * @return int - the # of channels set.
+     *
+     */
+
+    int decode(const struct can_frame & frame, unsigned int *samples, unsigned int *which = NULL);
+
+    /**
+     *
+     * pollSamples() - read whatever frames are waiting, without
+     * waiting, and decode them into 'samples' (later frames win).
+     *
+     * @param samples unsigned int array - the input channels, at
+     * least CMMaxChannels+1.
+     *
+     * @param fresh bool - set true if any channel was set.
+     *
+     * @param which unsigned int pointer - if not NULL, set to which
+     * channels were set (bit i for channel i, see ChannelManager::load()).
+     *
+     * @param stamp uint64_t pointer - if not NULL, and a channel was
+     * set, set to the monotonic time the (last) frames that set them
+     * were read.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool pollSamples(unsigned int *samples, bool & fresh, unsigned int *which = NULL, uint64_t *stamp = NULL);
+
+    /**
+     *
+     * describe() - a status line for "status".
+     *
+     */
+
+    string describe(void);
+
+    /* standard destructor */
+
+    virtual ~CANInput(void) {
+      close();
+    }
+};
+
+#endif
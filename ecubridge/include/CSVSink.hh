@@ -0,0 +1,67 @@
+#ifndef CSVSINK_HH
+#define CSVSINK_HH
+
+#include "SerialSink.hh"
+
+/**
+ *
+ * CSVSink - plain text, one line per frame, for a serial logger or a
+ * laptop with a terminal program:
+ *
+ *   seq,ms,chan_1,...,chan_15
+ *
+ * where ms is the (monotonic) time the DL-32 data arrived in
+ * milliseconds.  Lines end in CR LF.
+ *
+ */
+
+class CSVSink : public SerialSink {
+
+  protected:
+
+    /**
+     *
+     * encode() - one line of all the channels.
+     *
+     */
+
+    virtual size_t encode(const SampleFrame & frame, unsigned char *buf, size_t size) {
+
+      const unsigned int *data = values(frame);
+
+      char  *line = (char *)buf;
+      size_t n    = 0;
+
+      n += snprintf(line + n, size - n, "%lu,%llu", frame.seq,
+        (unsigned long long)(frame.stamp / 1000000ULL));
+
+      for(int chan=1; (chan<=CMMaxChannels) && (n < size); chan++) {
+        n += snprintf(line + n, size - n, ",%u", data[chan]);
+      }
+
+      if(n + 2 >= size) {
+        return 0;
+      }
+
+      line[n++] = '\r';
+      line[n++] = '\n';
+
+      return n;
+    }
+
+  public:
+
+    /* standard constructor */
+
+    CSVSink(const string & sinkName) : SerialSink("CSVSink", sinkName) {
+
+    }
+
+    /* standard destructor */
+
+    virtual ~CSVSink(void) {
+
+    }
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef CHANNELEXPRESSION_HH
+#define CHANNELEXPRESSION_HH
+
+#include "Object.hh"
+
+/* the most instructions, and stack, a compiled expression can use */
+
+enum ExprMaxCode {ExprMaxCode=64};
+enum ExprMaxStack {ExprMaxStack=16};
+
+/* the channels an expression can use, chan_1..chan_ExprMaxChannel */
+
+enum ExprMaxChannel {ExprMaxChannel=15};
+
+/**
+ *
+ * ExprOp - one instruction of a compiled expression; a stack machine,
+ * Const and Chan push, the rest pop their operands and push the
+ * result.  Comparisons and logic give 1 or 0.
+ *
+ */
+
+enum class ExprOp : unsigned char {
+  Const,
+  Chan,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Neg,
+  Not,
+  Lt,
+  Le,
+  Gt,
+  Ge,
+  Eq,
+  Ne,
+  And,
+  Or,
+  Min,
+  Max,
+  Abs
+};
+
+struct ExprCode {
+  ExprOp op;
+  int    chan;
+  double value;
+};
+
+/**
+ *
+ * ChannelExpression - arithmetic over the (normal) channel values, for
+ * channels we don't have a sensor for but can work out; i.e.
+ *
+ *   chan_1 / max(chan_2, 1)
+ *   (chan_4 > 120) + 2 * (chan_3 < 10)
+ *
+ * Numbers, chan_N, ( ), + - * /, unary - and !, < <= > >= == !=,
+ * && ||, and min(a, b), max(a, b), abs(a); the usual C precedence.
+ * Dividing by 0 gives 0.
+ *
+ * compile() parses it once into a short bytecode program, folding
+ * anything that doesn't depend on a channel into a constant as it
+ * goes; eval() just runs the program, no allocation.  The result is
+ * rounded, and kept to 0..4294967295.
+ *
+ */
+
+class ChannelExpression : public Object {
+
+  private:
+
+    /* the program */
+
+    ExprCode code[ExprMaxCode];
+    int      length;
+
+    /* the channels it uses (bit N for chan_N) */
+
+    unsigned int channels;
+
+    /* while compiling: the text, where we are, and the stack depth */
+
+    string text;
+    size_t at;
+    int    depth;
+    int    deepest;
+
+    /* (compile() helpers) recursive descent, lowest precedence first */
+
+    bool orExpr(void);
+    bool andExpr(void);
+    bool equality(void);
+    bool relation(void);
+    bool sum(void);
+    bool term(void);
+    bool unary(void);
+    bool primary(void);
+
+    /* (compile() helpers) the next token, if it's 'what' take it */
+
+    void skipSpace(void);
+    bool accept(const string & what);
+
+    /**
+     *
+     * emit() - (compile() helper) add an instruction, and fold it into
+     * a constant right away if all of its operands are constants.
+     *
+     */
+
+    bool emit(ExprOp op, int chan=0, double value=0.0);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    ChannelExpression(void);
+
+    /**
+     *
+     * compile() - parse and compile an expression.
+     *
+     * @param expression string - the expression.
+     *
+     * @return bool - exactly false on error (see getError()).
+     *
+     */
+
+    bool compile(const string & expression);
+
+    /**
+     *
+     * eval() - run the program.
+     *
+     * @param normal unsigned int array - the channel values, chan_N is
+     * normal[N].
+     *
+     * @return unsigned int - the (rounded) result.
+     *
+     */
+
+    unsigned int eval(const unsigned int *normal) const;
+
+    /* the channels used (bit N for chan_N) */
+
+    unsigned int uses(void) const {
+      return channels;
+    }
+
+    /* # of instructions, 1 if it's folded down to a constant */
+
+    int size(void) const {
+      return length;
+    }
+
+    /* what was compiled */
+
+    const string & getText(void) const {
+      return text;
+    }
+
+    /* standard destructor */
+
+    virtual ~ChannelExpression(void) {
+
+    }
+};
+
+#endif
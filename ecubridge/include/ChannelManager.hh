@@ -20,15 +20,22 @@
 #include "AIMThrotAngTransform.hh"
 #include "AIMWaterTempTransform.hh"
 #include "AIMWheelSpeedTransform.hh"
+#include "CurveTransform.hh"
+#include "StreamTransform.hh"
 #include "DL32Chan1Transform.hh"
 #include "DL32Chan2Transform.hh"
 #include "DL32Chan3Transform.hh"
 #include "DL32Chan4Transform.hh"
 #include "DL32Chan5Transform.hh"
+#include "LookupTransform.hh"
 #include "ManualTransform.hh"
 #include "NullTransform.hh"
 #include "PassthroughTransform.hh"
 
+/* derived channels */
+
+#include "ChannelExpression.hh"
+
 /**
  *
  * ChannelManager - handles mapping DL-32 Data to the SoloDL through
@@ -80,6 +87,72 @@
 
 enum CMMaxChannels {CMMaxChannels=15};
 
+/* load()'s fresh mask (bit i is input channel i), every channel */
+
+enum CMAllFresh {CMAllFresh=0xFFFF};
+
+/**
+ *
+ * CMKernel - one compiled step of a channel (see compile()):
+ *
+ *   Copy   - y = x
+ *   Const  - y = value
+ *   Arith  - a Curve (see curveY()); scaling, clamps, deadbands,
+ *            polynomials and piecewise curves all come down to that,
+ *            and they all run in one pass
+ *   Lookup - table[x] for x < LookupSize, past that a Call
+ *   Call   - call the transformers, the chain couldn't be folded
+ *   Stream - call the transformers, but only for a new sample (see
+ *            Form::Stream), otherwise it's the last value again
+ *
+ */
+
+enum class CMKernel : unsigned char {
+  Copy,
+  Const,
+  Arith,
+  Lookup,
+  Call,
+  Stream
+};
+
+/**
+ *
+ * CMStage - the compiled kernels for one side of all the channels,
+ * kept as parallel arrays so load() walks straight through them.
+ * Every channel starts out as a copy, the Arith channels are then
+ * done in one pass from the 'curves' list, and the rest from the
+ * 'others' list.
+ *
+ */
+
+struct CMStage {
+  CMKernel     kind[CMMaxChannels+1];
+  unsigned int value[CMMaxChannels+1];
+  unsigned int center[CMMaxChannels+1];
+  unsigned int band[CMMaxChannels+1];
+  double       coef[4][CMMaxChannels+1];
+  double       knot[CurveMaxKnots][CMMaxChannels+1];
+  double       slope[CurveMaxKnots][CMMaxChannels+1];
+  double       low[CMMaxChannels+1];
+  double       high[CMMaxChannels+1];
+
+  const unsigned int *table[CMMaxChannels+1];
+
+  /* the most knots, and polynomial terms, any curve has; any deadbands? */
+
+  int  knots;
+  int  terms;
+  bool deadbands;
+
+  /* the Arith channels, and the Const, Lookup, Call and Stream channels */
+
+  int curves[CMMaxChannels];
+  int ncurves;
+  int others[CMMaxChannels];
+  int count;
+};
+
 class ChannelManager : public Object {
 
   private:
@@ -129,6 +202,77 @@ class ChannelManager : public Object {
 
     DataTransformer *outputTrans[CMMaxChannels+1];
 
+    /**
+     *
+     * normalStage - input transform + input filter, compiled: input[i]
+     * to normal[i].
+     *
+     * outputStage - output filter + output transform (inverse),
+     * compiled: normal[patchTableInverted[i]] to output[i].
+     *
+     */
+
+    CMStage normalStage;
+    CMStage outputStage;
+
+    /*
+     * the lookup tables compile() works out for chains it can't fold
+     * any other way (allocated the first time a channel needs one).
+     *
+     */
+
+    vector<unsigned int> normalTables[CMMaxChannels+1];
+    vector<unsigned int> outputTables[CMMaxChannels+1];
+
+    /**
+     *
+     * derived - channels worked out from the other channels (see
+     * [derived]), their expression or NULL; derivedList has them in
+     * the order they're worked out (lowest channel first).  If their
+     * input filter is a streaming one, derivedStream (see compile()).
+     *
+     */
+
+    ChannelExpression *derived[CMMaxChannels+1];
+    bool               derivedStream[CMMaxChannels+1];
+    int                derivedList[CMMaxChannels];
+    int                derivedCount;
+
+    /* the last value of each Stream channel, for when there's no new sample */
+
+    unsigned int normalHeld[CMMaxChannels+1];
+    unsigned int outputHeld[CMMaxChannels+1];
+
+    /*
+     * input channels (bit i) that are a constant going into a Stream
+     * channel (a null or manual one); nothing ever makes them a new
+     * sample, so they are one every time (see compile()).
+     *
+     */
+
+    unsigned int steadyFresh;
+
+    /**
+     *
+     * run() - load(), and for curve(): 'settled' shows streaming filters
+     * as what they settle to (their input), without touching them.
+     *
+     */
+
+    bool run(unsigned int *input, unsigned int *normal, unsigned int *output,
+             unsigned int fresh, bool settled);
+
+    /**
+     *
+     * compile() - fold each channel's transformers into one kernel per
+     * stage.  Has to be re-done after anything that changes a
+     * transformer or the patch table.  Chains that won't fold are
+     * worked out for every x < LookupSize, into a lookup table.
+     *
+     */
+
+    void compile(void);
+
     /**
      *
      * invertPatchTable() - internal helper function, when we swap channels
@@ -139,6 +283,82 @@ class ChannelManager : public Object {
 
     bool invertPatchTable(void);
 
+    /**
+     *
+     * makeTable() - (configure() helper) a LookupTransform from the
+     * [table <name>] section:
+     *
+     *   step   - input counts between the points
+     *   values - the outputs at 0, step, 2*step, ...
+     *
+     * @param ini IniFile - the settings to use.
+     *
+     * @param tableName string - the table's name.
+     *
+     * @return DataTransformer - exactly NULL on error.
+     *
+     */
+
+    DataTransformer *makeTable(IniFile & ini, const string & tableName);
+
+    /**
+     *
+     * makeCurve() - (configure() helper) a CurveTransform from a filter
+     * setting, one of:
+     *
+     *   piecewise, x:y, x:y, ...
+     *   poly, c0, c1 [, c2 [, c3]]
+     *   clamp, low, high
+     *   deadband, center, band
+     *
+     * @param args vector of string - the setting, split up.
+     *
+     * @return DataTransformer - exactly NULL on error.
+     *
+     */
+
+    DataTransformer *makeCurve(const vector<string> & args);
+
+    /**
+     *
+     * makeStream() - (configure() helper) a StreamTransform from a
+     * filter setting, one of:
+     *
+     *   ema, alpha
+     *   average, n
+     *   median, n
+     *   rate, step
+     *   debounce, n
+     *
+     * @param args vector of string - the setting, split up.
+     *
+     * @return DataTransformer - exactly NULL on error.
+     *
+     */
+
+    DataTransformer *makeStream(const vector<string> & args);
+
+    /**
+     *
+     * configureDerived() - (configure() helper) compile the [derived]
+     * expressions.
+     *
+     * @param ini IniFile - the settings to use.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool configureDerived(IniFile & ini);
+
+    /**
+     *
+     * init() - (constructor helper) empty transforms and patch tables.
+     *
+     */
+
+    void init(void);
+
   protected:
 
   public:
@@ -147,6 +367,19 @@ class ChannelManager : public Object {
 
     ChannelManager(void);
 
+    /**
+     *
+     * ChannelManager() - configure from the given settings instead of
+     * the program's configuration (ConfigManager).  Used for reloading,
+     * where we build a new ChannelManager from a fresh read of the .ini
+     * file while the current one keeps running.
+     *
+     * @param ini IniFile - the settings to use.
+     *
+     */
+
+    ChannelManager(IniFile & ini);
+
     /**
      *
      * configure() - reset everything and start fresh.  This
@@ -161,6 +394,18 @@ class ChannelManager : public Object {
 
     bool configure(void);
 
+    /**
+     *
+     * configure() - same, but from the given settings.
+     *
+     * @param ini IniFile - the settings to use.
+     *
+     * @return bool - exactly false if something goes wrong.
+     *
+     */
+
+    bool configure(IniFile & ini);
+
     /**
      *
      * load() - taking raw inputs from sampling device (i.e. DL-32),
@@ -183,13 +428,42 @@ class ChannelManager : public Object {
      * of the normal data,  this is our official data to send to the SoloDL
      * without any further processing.
      *
+     * @param fresh unsigned int - which input channels (bit i for channel
+     * i) have a new sample; streaming filters only take new samples, the
+     * others just give their last value again.
+     *
      * @return bool - exactly false if there is some kidn of error.
      *
      */
 
     bool load(unsigned int *input,
               unsigned int *normal,
-              unsigned int *output);
+              unsigned int *output,
+              unsigned int fresh = CMAllFresh);
+
+    /**
+     *
+     * loadChained() - same as load(), but by calling each channel's
+     * transformers one at a time, the way they are configured.  Slow;
+     * for checking and timing load() (see test/cmbench.cc).  Streaming
+     * filters take every channel as a new sample.
+     *
+     * @return bool - exactly false if there is some kind of error.
+     *
+     */
+
+    bool loadChained(unsigned int *input,
+                     unsigned int *normal,
+                     unsigned int *output);
+
+    /**
+     *
+     * compiled() - how many of the 30 channel stages compiled to
+     * something other than a Call (or Stream).
+     *
+     */
+
+    int compiled(void);
 
     /**
      *
@@ -215,6 +489,25 @@ class ChannelManager : public Object {
 
     bool transform(int channel, unsigned int input, unsigned int & output);
 
+    /**
+     *
+     * curve() - the channel's transfer function; what load() would do to
+     * every input from 0 to LookupSize-1, for plotting.  Streaming
+     * filters are shown settled (as their input), and aren't disturbed.
+     *
+     * @param channel int - the (output side) channel, 1..15.
+     *
+     * @param normal vector of unsigned int - the normal value for each
+     * input (of the input channel patched to it).
+     *
+     * @param output vector of unsigned int - the output for each input.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool curve(int channel, vector<unsigned int> & normal, vector<unsigned int> & output);
+
     /**
      *
      * setOutputFilter() - install a new filter (output side).  You must
@@ -152,6 +152,24 @@ class CommandPort : public Object {
 
     bool accept(void);
 
+    /**
+     *
+     * accept() - open connection to the waiting client, and
+     * hand back its descriptor rather than making it "the"
+     * client, so any number of clients can be in flight and
+     * handled by other threads.  The client gets send and
+     * receive timeouts, so it can't hold up whoever is talking
+     * to it for more than the read timeout.
+     *
+     * @param clientFd int - the new client, use it with the
+     * receive(), send() and drop() that take a descriptor.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool accept(int & clientFd);
+
     /**
      *
      * drop() - if we have a client connected, then drop them.
@@ -162,6 +180,18 @@ class CommandPort : public Object {
 
     bool drop(void);
 
+    /**
+     *
+     * drop() - drop the given client.
+     *
+     * @param clientFd int - the client (see accept()).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool drop(int clientFd);
+
     /**
      *
      * receive() - read exactly one line of input
@@ -177,6 +207,22 @@ class CommandPort : public Object {
 
     bool receive(string & line);
 
+    /**
+     *
+     * receive() - read exactly one line of input from the
+     * given client.  If the client doesn't finish its line
+     * within the read timeout we give up on it.
+     *
+     * @param clientFd int - the client (see accept()).
+     *
+     * @param line string - the command line we are passing back.
+     *
+     * @return bool - exactly false on any error.
+     *
+     */
+
+    bool receive(int clientFd, string & line);
+
     /**
      *
      * send() - send our response to the client, normally
@@ -192,6 +238,20 @@ class CommandPort : public Object {
 
     bool send(const string & line);
 
+    /**
+     *
+     * send() - send a response to the given client.
+     *
+     * @param clientFd int - the client (see accept()).
+     *
+     * @param line string - the line of text to send.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool send(int clientFd, const string & line);
+
     /**
      *
      * waitForClient() - wait for the next client to arrive,
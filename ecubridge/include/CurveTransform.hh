@@ -0,0 +1,202 @@
+#ifndef CURVETRANSFORM_HH
+#define CURVETRANSFORM_HH
+
+#include "DataTransformer.hh"
+
+#include <cmath>
+
+/**
+ *
+ * CurveTransform - a sensor calibration that is just arithmetic, set up
+ * as one of:
+ *
+ *   piecewise - straight lines through up to CurveMaxKnots points,
+ *               held flat before the first and after the last
+ *   poly      - a polynomial of up to 3rd degree; the coefficients
+ *               are kept in 32.32 fixed point, the result is rounded
+ *   clamp     - x, kept to low..high
+ *   deadband  - x, but center if x is within band of it
+ *
+ * They are all Curve forms (see curveY()), so the ChannelManager can
+ * run them for every channel in one pass.
+ *
+ */
+
+class CurveTransform : public DataTransformer {
+
+  private:
+
+    TransformForm form;
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    CurveTransform(void) : form(Form::Curve) {
+      setName("Curve");
+    }
+
+    /**
+     *
+     * piecewise() - straight lines through the given points.
+     *
+     * @param xs vector of unsigned int - the inputs, in increasing order.
+     *
+     * @param ys vector of unsigned int - the output at each input.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool piecewise(const vector<unsigned int> & xs, const vector<unsigned int> & ys) {
+
+      size_t n = xs.size();
+
+      if((n < 2) || (n > CurveMaxKnots) || (ys.size() != n)) {
+        return false;
+      }
+
+      for(size_t k=1; k<n; k++) {
+        if(xs[k] <= xs[k-1]) {
+          return false;
+        }
+      }
+
+      /* each knot changes the slope by the difference */
+
+      double before = 0.0;
+
+      form.coef[0] = (double)ys[0] + 0.5;
+      form.coef[1] = 0.0;
+      form.knots   = (int)n;
+
+      for(size_t k=0; k<n; k++) {
+
+        double after = 0.0;
+
+        if(k+1 < n) {
+          after = ((double)ys[k+1] - (double)ys[k]) / ((double)xs[k+1] - (double)xs[k]);
+        }
+
+        form.knot[k]  = (double)xs[k];
+        form.slope[k] = after - before;
+
+        before = after;
+      }
+
+      setName("Piecewise");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * poly() - coefs[0] + coefs[1]x + coefs[2]x^2 + coefs[3]x^3.
+     *
+     * @param coefs vector of double - 1 to 4 coefficients, lowest
+     * power first.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool poly(const vector<double> & coefs) {
+
+      if((coefs.size() < 1) || (coefs.size() > 4)) {
+        return false;
+      }
+
+      for(int k=0; k<4; k++) {
+
+        double c = (k < (int)coefs.size()) ? coefs[k] : 0.0;
+
+        form.coef[k] = (double)llround(c * 4294967296.0) / 4294967296.0;
+      }
+
+      form.coef[0] += 0.5;
+
+      setName("Poly");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * clamp() - keep x to low..high.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool clamp(unsigned int low, unsigned int high) {
+
+      if(low > high) {
+        return false;
+      }
+
+      form.low  = low;
+      form.high = high;
+
+      setName("Clamp");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * deadband() - center, for any x within band of it.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool deadband(unsigned int center, unsigned int band) {
+
+      form.center = center;
+      form.band   = band;
+
+      setName("Deadband");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * y() - transform 'x' by whatever transformation
+     * function we implement.
+     *
+     */
+
+    virtual unsigned int y(unsigned int x) {
+      return curveY(form, x);
+    }
+
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return form;
+    }
+
+    /* standard destructor */
+
+    virtual ~CurveTransform() {
+
+    }
+};
+
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef DL32PARSER_HH
+#define DL32PARSER_HH
+
+#include "Object.hh"
+
+enum DL32ChannelMax {DL32ChannelMax=5};
+enum DL32ParserMaxFrames {DL32ParserMaxFrames=8};
+
+/**
+ *
+ * DL32Frame - one complete packet from the DL-32; the channel
+ * values (channel 1 is samples[1]) and when the packet finished
+ * arriving (monotonic nanoseconds).
+ *
+ */
+
+struct DL32Frame {
+
+  unsigned int samples[DL32ChannelMax+1];
+  int          channels;
+  uint64_t     stamp;
+};
+
+/**
+ *
+ * DL32Parser - a streaming parser for the DL-32's serial packets.  We
+ * feed() it whatever bytes the port had for us, in any sized pieces;
+ * a packet split across two reads is just picked up where it left off.
+ * Every complete packet goes into a small queue of frames that we take
+ * with next().
+ *
+ * A packet is a 2 byte header, and then 'length' 2 byte words:
+ *
+ *   header  - 1010 001L  1LLL LLLL (L is the length in words)
+ *   words   - 00DD DDDD  0DDD DDDD for DL-32 (aux) data, sub-packets
+ *             from the LM-1 (1...) and LC-1 (01..) are skipped.
+ *
+ * Bytes that don't fit a header while we are hunting for one are
+ * skipped (and counted), every time we have to go hunting after being
+ * in sync counts as a resync.
+ *
+ * Only used from one thread, no locking.
+ *
+ */
+
+class DL32Parser : public Object {
+
+  private:
+
+    /* where we are in the current packet */
+
+    enum ParseState {
+      HUNT,
+      HEADER,
+      PAYLOAD
+    };
+
+    ParseState state;
+
+    /* the 1st header byte, while we wait for the 2nd */
+
+    unsigned char header;
+
+    /* the payload of the current packet, and how much we have */
+
+    unsigned char payload[512];
+    size_t        length;
+    size_t        have;
+
+    /* true while we are skipping bytes looking for a header */
+
+    bool hunting;
+
+    /*
+     * frames - complete frames not taken yet (a ring), if nobody
+     * takes them the oldest are overwritten.
+     *
+     */
+
+    DL32Frame frames[DL32ParserMaxFrames];
+    size_t    head;
+    size_t    count;
+
+    /* counters */
+
+    unsigned long parsed;
+    unsigned long resyncs;
+    unsigned long skipped;
+    unsigned long overwritten;
+
+    /**
+     *
+     * emit() - (feed() helper) the current packet is complete, decode
+     * it into the frame queue.
+     *
+     */
+
+    void emit(uint64_t stamp);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    DL32Parser(void) : Object("DL32Parser") {
+      reset();
+      makeReady();
+    }
+
+    /**
+     *
+     * reset() - forget any partial packet, queued frames and
+     * counters.
+     *
+     */
+
+    void reset(void);
+
+    /**
+     *
+     * feed() - parse more bytes from the DL-32.
+     *
+     * @param bytes unsigned char array - the bytes.
+     *
+     * @param n size_t - how many.
+     *
+     * @param stamp uint64_t - when the bytes arrived, any packets they
+     * complete get this as their stamp.
+     *
+     * @return size_t - the # of frames completed by these bytes.
+     *
+     */
+
+    size_t feed(const unsigned char *bytes, size_t n, uint64_t stamp);
+
+    /**
+     *
+     * next() - take the oldest complete frame.
+     *
+     * @param frame DL32Frame - the frame.
+     *
+     * @return bool - exactly false if there are none.
+     *
+     */
+
+    bool next(DL32Frame & frame);
+
+    /**
+     *
+     * latest() - take the newest complete frame, and throw away
+     * any older ones.
+     *
+     * @param frame DL32Frame - the frame.
+     *
+     * @return bool - exactly false if there are none.
+     *
+     */
+
+    bool latest(DL32Frame & frame);
+
+    /* # of complete frames waiting */
+
+    size_t pending(void) const {
+      return count;
+    }
+
+    /* true if we are part way through a packet */
+
+    bool partial(void) const {
+      return (state != HUNT);
+    }
+
+    /* counters since the last reset() */
+
+    unsigned long getParsed(void) const {
+      return parsed;
+    }
+
+    unsigned long getResyncs(void) const {
+      return resyncs;
+    }
+
+    unsigned long getSkipped(void) const {
+      return skipped;
+    }
+
+    unsigned long getOverwritten(void) const {
+      return overwritten;
+    }
+
+    /* standard destructor */
+
+    virtual ~DL32Parser(void) {
+
+    }
+};
+
+#endif
@@ -2,8 +2,8 @@
 #define DL32PORT_HH
 
 #include "RS232Port.hh"
-
-enum DL32ChannelMax {DL32ChannelMax=5};
+#include "DL32Parser.hh"
+#include "SerialCapture.hh"
 
 class DL32Port : public RS232Port {
 
@@ -11,14 +11,44 @@ class DL32Port : public RS232Port {
 
     /**
      *
-     * payload - the input area for capturing bytes from the
-     * DL-32.  We typically get a small package with
-     * a few words of data, nothing so huge.
+     * chunk - what we read from the port in one go; whatever the
+     * DL-32 has sent us so far (it's a slow port, a packet is only
+     * ~12 bytes).
+     *
+     */
+
+    unsigned char chunk[512];
+
+    /**
+     *
+     * parser - turns the bytes into frames, keeps partial packets
+     * between reads.
+     *
+     */
+
+    DL32Parser parser;
+
+    /* # of read() calls, to compare against frames parsed */
+
+    unsigned long reads;
+
+    /**
+     *
+     * capture - if we're recording the raw byte stream (see
+     * startCapture()), NULL otherwise.
+     *
+     */
+
+    SerialCapture *capture;
+
+    /**
+     *
+     * took() - (read helper) we read 'n' bytes into chunk at 'stamp',
+     * parse them (and capture them).
      *
      */
 
-    char payload[2048];
-    char buffer[256];
+    void took(size_t n, uint64_t stamp);
 
     /**
      *
@@ -36,14 +66,26 @@ class DL32Port : public RS232Port {
     /*
      * standard constructor, if you given valid parameters, they will
      * be passed to openPort() to construct and open at the same time.
+     * With 'nonBlocking' the port is opened O_NONBLOCK, for use with
+     * pollSamples() from an event loop.
      *
      */
 
-    DL32Port(const string & path="") :
-      RS232Port(path, "19200,8,N,1", true) {
+    DL32Port(const string & path="", bool nonBlocking=false) :
+      RS232Port(path, "19200,8,N,1", true), reads(0), capture(NULL) {
 
       setClassName("DL32Port");
 
+      if(isReady() && nonBlocking) {
+        if(!setNonBlocking(true)) {
+          unReady();
+        }
+      }
+
+      if(isReady() && !configureLatency("dl32")) {
+        unReady();
+      }
+
       if(!isReady()) {
 
         /* there was a problem opening the port */
@@ -56,7 +98,7 @@ class DL32Port : public RS232Port {
       }
     }
 
-    DL32Port(const DL32Port & obj) {
+    DL32Port(const DL32Port & obj) : reads(0), capture(NULL) {
 
       operator=(obj);
 
@@ -81,15 +123,111 @@ class DL32Port : public RS232Port {
      * go up to DL32ChannelMax, so samples must
      * be at least DL32ChannelMax+1 in size.
      *
+     * @param stamp uint64_t pointer - if not NULL,
+     * set to the monotonic time (nanoseconds) at
+     * which the packet finished arriving.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool readSamples(unsigned int *samples, uint64_t *stamp = NULL);
+
+    /**
+     *
+     * pollSamples() - (non-blocking port) take whatever bytes the port
+     * has right now, and never wait for more.  If that finished one or
+     * more packets, the oldest goes in 'samples' (take the rest with
+     * nextSamples()), otherwise a partial packet is kept for next time
+     * and 'samples' isn't touched.  Reads until the port is empty, so
+     * its safe with edge triggered epoll.
+     *
+     * @param samples int array - the array of channel data, at least
+     * DL32ChannelMax+1 in size.
+     *
+     * @param fresh bool - set to true if we got a new packet.
+     *
+     * @param stamp uint64_t pointer - if not NULL, and we got a new
+     * packet, set to the monotonic time it finished arriving.
+     *
      * @return bool - exactly false on error.
      *
      */
 
-    bool readSamples(unsigned int *samples);
+    bool pollSamples(unsigned int *samples, bool & fresh, uint64_t *stamp = NULL);
+
+    /**
+     *
+     * nextSamples() - after pollSamples(), take the next packet that
+     * came in with the same read, so streaming filters get to see
+     * every sample and not just the newest.
+     *
+     * @param samples int array - the array of channel data, at least
+     * DL32ChannelMax+1 in size.
+     *
+     * @param stamp uint64_t pointer - if not NULL, set to the
+     * monotonic time the packet finished arriving.
+     *
+     * @return bool - exactly false if there are no more.
+     *
+     */
+
+    bool nextSamples(unsigned int *samples, uint64_t *stamp = NULL);
+
+    /**
+     *
+     * getParser() - the packet parser, for its counters.
+     *
+     */
+
+    const DL32Parser & getParser(void) const {
+      return parser;
+    }
+
+    /**
+     *
+     * getReads() - the # of read() calls we've made on the port.
+     *
+     */
+
+    unsigned long getReads(void) const {
+      return reads;
+    }
+
+    /**
+     *
+     * startCapture() - record the raw bytes we read from the DL-32, with
+     * their timestamps, to a capture file (see SerialCapture) until
+     * stopCapture().  The ecureplay tool can play it back.
+     *
+     * @param fileName string - the capture file.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool startCapture(const string & fileName);
+
+    /**
+     *
+     * stopCapture() - stop recording, and close the capture file.
+     *
+     * @return unsigned long - the # of reads that were recorded.
+     *
+     */
+
+    unsigned long stopCapture(void);
+
+    /* true if we're capturing */
+
+    bool isCapturing(void) const {
+      return capture != NULL;
+    }
 
     /* standard destructor */
 
     virtual ~DL32Port(void) {
+      stopCapture();
 
     }
 };
@@ -27,6 +27,117 @@ enum class Transform {
   DL32Chan5         = 23
 };
 
+/* the inputs a lookup table covers; the DL-32 sends 12 bit words */
+
+enum LookupSize {LookupSize=4096};
+
+/* the most breakpoints (knots) a piecewise curve can have */
+
+enum CurveMaxKnots {CurveMaxKnots=16};
+
+/**
+ *
+ * TransformForm - what a transformer's y() (or inverse()) works out to,
+ * so the ChannelManager can compile a channel's chain of transformers
+ * into one step (see ChannelManager::compile()):
+ *
+ *   Opaque   - anything else (but only ever a function of x), it has
+ *              to be called
+ *   Constant - always value
+ *   Identity - always x
+ *   Linear   - (unsigned int)(x * scale + offset)
+ *   Clamp    - x, but at most value
+ *   Lookup   - table[x] for x < LookupSize, called past that
+ *   Curve    - see curveY()
+ *   Stream   - depends on the samples before x too (a streaming
+ *              filter), so it has to be called exactly once per new
+ *              sample, never just to see what it does.  For a steady
+ *              x it settles to x.
+ *
+ */
+
+enum class Form {
+  Opaque,
+  Constant,
+  Identity,
+  Linear,
+  Clamp,
+  Lookup,
+  Curve,
+  Stream
+};
+
+struct TransformForm {
+
+  Form         kind;
+  unsigned int value;
+  double       scale;
+  double       offset;
+
+  const unsigned int *table;
+
+  /* Curve: deadband, then polynomial + hinges, then clamp */
+
+  unsigned int center;
+  unsigned int band;
+  double       coef[4];
+  int          knots;
+  double       knot[CurveMaxKnots];
+  double       slope[CurveMaxKnots];
+  double       low;
+  double       high;
+
+  TransformForm(Form kind=Form::Opaque, unsigned int value=0, double scale=1.0, double offset=0.0) :
+    kind(kind), value(value), scale(scale), offset(offset), table(NULL),
+    center(0), band(0), knots(0), low(0.0), high(4294967295.0) {
+
+    coef[0] = 0.0;
+    coef[1] = 1.0;
+    coef[2] = 0.0;
+    coef[3] = 0.0;
+
+    for(int k=0; k<CurveMaxKnots; k++) {
+      knot[k]  = 0.0;
+      slope[k] = 0.0;
+    }
+  }
+};
+
+/**
+ *
+ * curveY() - evaluate a Curve form:
+ *
+ *   x' = center if x is within band of it, otherwise x
+ *   p  = coef[0] + coef[1]x' + coef[2]x'^2 + coef[3]x'^3
+ *        + sum of slope[k] * max(0, x' - knot[k])
+ *   y  = p, kept to low..high, then truncated
+ *
+ * A piecewise linear curve is a sum of hinges like that, so it needs
+ * no searching; coef[0] carries any rounding (+0.5).  ChannelManager
+ * does exactly the same arithmetic for all the channels at once.
+ *
+ */
+
+inline unsigned int curveY(const TransformForm & form, unsigned int x) {
+
+  unsigned int off = (x > form.center) ? (x - form.center) : (form.center - x);
+  double       xx  = (double)((off <= form.band) ? form.center : x);
+
+  double p = form.coef[0] + xx * (form.coef[1] + xx * (form.coef[2] + xx * form.coef[3]));
+
+  for(int k=0; k<form.knots; k++) {
+
+    double over = xx - form.knot[k];
+
+    p += form.slope[k] * ((over > 0.0) ? over : 0.0);
+  }
+
+  p = (p < form.low)  ? form.low  : p;
+  p = (p > form.high) ? form.high : p;
+
+  return (unsigned int)p;
+}
+
 /**
  *
  * DataTransformer classes are used to transform input
@@ -117,6 +228,27 @@ class DataTransformer {
       return 0;
     }
 
+    /**
+     *
+     * yForm() - what y() works out to, if its that simple.  Sub-classes
+     * that override y() must override this too (or leave it Opaque).
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return TransformForm();
+    }
+
+    /**
+     *
+     * inverseForm() - same for inverse().
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm();
+    }
+
     /**
      *
      * setParam() - given a parameter (by index)
@@ -4,11 +4,40 @@
 #include "Object.hh"
 #include "ChannelManager.hh"
 #include "DL32Port.hh"
+#include "CANInput.hh"
 #include "SoloDLPort.hh"
+#include "SoloDLSink.hh"
+#include "TelemetrySink.hh"
+#include "CSVSink.hh"
+#include "AIMCANSink.hh"
 #include "PortMapper.hh"
 #include "DataTapWriter.hh"
 #include "CommandPort.hh"
 #include "USBCable.hh"
+#include "TripleBuffer.hh"
+#include "SampleFrame.hh"
+#include "Histogram.hh"
+#include "Tracer.hh"
+#include "WorkQueue.hh"
+#include "SpscRing.hh"
+#include "PhaseEstimator.hh"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/* queued to the command worker in place of a client, to do a SIGHUP reload */
+
+enum ECUReloadClient {ReloadClient=-1};
 
 /**
  *
@@ -58,11 +87,32 @@
  *   of a DL32 channel or configure what a given input or
  *   output transform should be.
  *
+ * The work is split over two threads.  The acquisition thread
+ * (the one that calls loop()) reads the DL-32, handles commands
+ * and USB events, and runs each sample through the ChannelManager.
+ * The sender thread wakes on an absolute tick and writes the
+ * most recent frame to the SoloDL (and the data taps).  The two
+ * threads hand frames over through a lock free triple buffer, so a
+ * slow command or DL-32 read can never hold up a SoloDL send.
+ *
+ * Data tap publishing (formatting and sending the tap lines) is done
+ * by a background publisher thread, fed through a lock free ring by
+ * the sender.  If the publisher falls behind, tap frames are dropped
+ * (and counted) rather than holding up the sender.
+ *
+ * Commands are read, parsed and run by a third (command worker)
+ * thread.  The acquisition thread only accepts the client and queues
+ * it; if the queue is full the client is told we're busy.  Commands
+ * that touch the ChannelManager (channels, patch, filter) are passed
+ * back to the acquisition thread and applied at the top of its next
+ * cycle, so the ChannelManager is only ever used from one thread.
+ *
  * All of this happens within a 100ms cycle; the SoloDL expects
  * to be updated 10 times a second; some channels use a full 10hz
- * but others use 2hz or 5hz.  Other sample rates are possible,
- * but for now we only support those because their protocol calls
- * for it, and its easier to implement just those sample rates.
+ * but others use 2hz or 5hz.  Those are the default rates, but any
+ * per channel rate up to the tick rate can be configured; the sender
+ * ticks faster than 10hz (50hz by default) and the SoloDL output
+ * schedule spreads each 100ms worth of packets over several ticks.
  *
  * The DL32 outputs data every 86ms or so.  We don't buffer DL32
  * data; if we skip a sample here and there, its fine, more samples
@@ -76,13 +126,37 @@ class ECUBridge : public Object {
 
     struct stats_t {
 
-      long rx;
-      long tx;
-      long cmds;
-      long uptime;
+      std::atomic<long> rx;
+      std::atomic<long> tx;
+      std::atomic<long> cmds;
+      std::atomic<long> uptime;
+      std::atomic<long> late;
+      std::atomic<long> busy;
+      std::atomic<long> shifted;
+
+      /* DL-32 port; read() calls, resyncs, skipped bytes */
+
+      std::atomic<long> reads;
+      std::atomic<long> resyncs;
+      std::atomic<long> skipped;
 
     } stats;
 
+    /**
+     *
+     * timing histograms (microseconds), all recorded by the sender:
+     *
+     *   latencyHist - age of the newest input data (DL-32 or CAN)
+     *                 when it was sent (acquisition to transmit).
+     *   periodHist  - time between successive SoloDL writes.
+     *   wakeHist    - how late the sender woke up vs its deadline.
+     *
+     */
+
+    Histogram latencyHist;
+    Histogram periodHist;
+    Histogram wakeHist;
+
     /**
      *
      * cable - the USB Cable (the FTDI quad cable), will tell us
@@ -114,11 +188,13 @@ class ECUBridge : public Object {
 
     /**
      *
-     * solodl - the dashboard monitor/camera
+     * sinks - where the data goes; the SoloDL (the dashboard
+     * monitor/camera) first, then any from [ECU Bridge] sinks on the
+     * cable's spare ports.  Fixed once configure() is done.
      *
      */
 
-    SoloDLPort *solodl;
+    vector<OutputSink*> sinks;
 
     /**
      *
@@ -129,6 +205,16 @@ class ECUBridge : public Object {
 
     DL32Port *dl32;
 
+    /**
+     *
+     * canInput - input channels from a CAN bus (see [can input]), NULL
+     * if none are mapped.  Not on the USB cable, so its open the whole
+     * time we run.
+     *
+     */
+
+    CANInput *canInput;
+
     /**
      *
      * portMapper - port mapper tells us where our devices
@@ -147,63 +233,466 @@ class ECUBridge : public Object {
 
     ChannelManager *channelMgr;
 
+    /**
+     *
+     * freshMgr - a reloaded ChannelManager (see reloadChannels())
+     * waiting to be swapped in for channelMgr, NULL if none.  Whoever
+     * takes it out of here (with exchange()) owns it.
+     *
+     */
+
+    std::atomic<ChannelManager *> freshMgr;
+
+    /**
+     *
+     * reloadPending - SIGHUP asked for a reload (see requestReload()),
+     * the acquisition thread passes it on to the command worker.
+     *
+     */
+
+    std::atomic<bool> reloadPending;
+
     /**
      *
      * running - true if we are already in
-     * the main loop().
+     * the main loop().  The status command
+     * reads it from the command worker.
      *
      */
 
-    bool running;
+    std::atomic<bool> running;
 
     /**
      *
-     * breakbreak - flag to tell me to stop looping.
+     * breakbreak - flag to tell me to stop looping (both
+     * threads watch it, and it may be set from a signal).
      *
      */
 
-    bool breakbreak;
+    std::atomic<bool> breakbreak;
 
     /**
      *
-     * timevalSubtract() - get an accurate "delta" for two
-     * timeval structs (the kind we typically use with select()
-     * calls etc.).  This allows us to get deltas without having
-     * to worry about microsecond rollove retc.  That mess is
-     * all handled here.
+     * frames - the hand off from the acquisition thread (writer)
+     * to the sender thread (reader); always the latest frame.
      *
-     * @param result timeval - the delta being passed back
+     */
+
+    TripleBuffer<SampleFrame> frames;
+
+    /**
+     *
+     * portLock - held by the acquisition thread while it is
+     * closing or re-opening the serial ports (USB unplug/plug),
+     * the sender only ever try_lock()'s it, so it never waits.
+     *
+     */
+
+    std::mutex portLock;
+
+    /**
+     *
+     * real time settings for the sender thread (from the [ECU Bridge]
+     * section); the CPU to pin to (-1 for any), the SCHED_FIFO priority
+     * (0 for normal scheduling) and if we should mlockall().
+     *
+     */
+
+    int  senderCpu;
+    int  senderPriority;
+    bool lockMemory;
+
+    /**
+     *
+     * sendHz - the sender's tick rate, this is the SoloDL output
+     * schedule's tick rate (see SoloDLPort::configuredTickHz()).
+     *
+     */
+
+    int sendHz;
+
+    /**
+     *
+     * phase lock settings (from the [ECU Bridge] section); if we should
+     * line send ticks up with the DL-32 frames at all, how long after a
+     * predicted frame arrival to send (ns), and the most we may move a
+     * tick off its fixed cadence (ns).  See sendLoop().
+     *
+     */
+
+    bool     phaseLock;
+    uint64_t phaseGuard;
+    uint64_t phaseMaxShift;
+
+    /**
      *
-     * @param x timeval - argument 1
+     * phase - what the sender learned about the DL-32 frame timing,
+     * published for "status" (the estimator itself is private to the
+     * sender thread).  Period and jitter are in microseconds.
      *
-     * @param y timeval - argument 2
+     */
+
+    struct phase_t {
+
+      std::atomic<bool> locked;
+      std::atomic<long> period;
+      std::atomic<long> jitter;
+
+    } phase;
+
+    /**
      *
-     * @return bool - exactliy true is returned if x is less
-     * than y.
+     * epfd - the epoll set we wait on in loop(), it holds
+     * the DL-32, the command port, the USB cable and our
+     * send timer.
      *
      */
 
-    bool timevalSubtract(struct timeval *result,
-                         struct timeval *x,
-                         struct timeval *y);
+    int epfd;
 
     /**
      *
-     * setFD() - helper to add a descriptor to
-     * a select() file descriptor set
+     * timerfd - CLOCK_MONOTONIC timer that we arm with absolute
+     * deadlines (TFD_TIMER_ABSTIME) for each SoloDL send tick.
      *
      */
 
-    bool setFD(int fd, fd_set *fds, int *max);
+    int timerfd;
 
     /**
      *
-     * clrFD() - helper to remove a descriptor from
-     * a select() file descriptor set
+     * clients - accepted command clients waiting for the command
+     * worker; bounded by the [ECU Bridge] command_queue setting.
      *
      */
 
-    bool clrFD(int fd, fd_set *fds, int *max);
+    WorkQueue<int> clients;
+
+    int commandQueue;
+
+    /**
+     *
+     * LoopJob - a command the worker wants run on the acquisition
+     * thread, the worker waits (on jobDone) until its done.
+     *
+     */
+
+    struct LoopJob {
+
+      string command;
+      string result;
+      bool   ok;
+      bool   done;
+
+      /*
+       * a "channels,curve" job (curveChannel 1..15) only has the table
+       * worked out on the acquisition thread, into normal/output; the
+       * worker does the rest (see channelCurve()).
+       *
+       */
+
+      int                  curveChannel;
+      vector<unsigned int> normal;
+      vector<unsigned int> output;
+    };
+
+    /**
+     *
+     * jobs - LoopJob's waiting for the acquisition thread, guarded
+     * by jobLock.  jobsOpen is false once the acquisition thread
+     * is no longer going to run them.  activeClient is the client
+     * the worker is currently talking to (-1 if none), so we can
+     * cut it off when stopping.
+     *
+     */
+
+    std::mutex              jobLock;
+    std::condition_variable jobDone;
+    std::deque<LoopJob *>   jobs;
+    bool                    jobsOpen;
+    int                     activeClient;
+
+    /**
+     *
+     * wakefd - eventfd the worker pokes to get the acquisition
+     * thread to look at the jobs.
+     *
+     */
+
+    int wakefd;
+
+    /**
+     *
+     * taps - frames (as actually sent) on their way from the sender to
+     * the tap publisher.  ~3 seconds worth at 10hz.
+     *
+     */
+
+    SpscRing<SampleFrame, 32> taps;
+
+    /**
+     *
+     * dl32Serial - the effective latency settings of the DL-32 port
+     * (see RS232Port::describeLatency()), noted when the port is
+     * opened, for "status".  Guarded by serialLock.  The sinks keep
+     * their own (see OutputSink::describe()).
+     *
+     */
+
+    std::mutex serialLock;
+    string     dl32Serial;
+
+    /**
+     *
+     * noteSerial() - (acquisition thread) update dl32Serial from the
+     * port we have open right now.
+     *
+     */
+
+    void noteSerial(void);
+
+    /**
+     *
+     * openSinks() - (acquisition thread) open the sinks' ports.  The
+     * spare ports are optional, if one of them can't be opened we
+     * just warn about it.
+     *
+     * @param cabled bool - the sinks on the USB cable (when it's
+     * plugged in), or the ones that aren't (once, at start up); see
+     * OutputSink::onCable().
+     *
+     * @return bool - exactly false if the SoloDL can't be opened.
+     *
+     */
+
+    bool openSinks(bool cabled);
+
+    /**
+     *
+     * closeSinks() - (acquisition thread) close the ports of the sinks
+     * on the USB cable (it was unplugged); the others stay open.
+     *
+     */
+
+    void closeSinks(void);
+
+    /**
+     *
+     * watch() - helper to add a descriptor to our epoll
+     * set (we only ever care about it being readable).
+     *
+     * @param fd int - the descriptor to watch.
+     *
+     * @param edge bool - edge triggered; we're only told when new
+     * data arrives, so we have to read until its empty every time.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool watch(int fd, bool edge=false);
+
+    /**
+     *
+     * unwatch() - helper to remove a descriptor from our
+     * epoll set.
+     *
+     * @param fd int - the descriptor to stop watching.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool unwatch(int fd);
+
+    /**
+     *
+     * armTimer() - set the send timer to fire at the given
+     * absolute CLOCK_MONOTONIC time.
+     *
+     * @param deadline uint64_t - when to fire (nanoseconds, see
+     * monotonic_ns()).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool armTimer(uint64_t deadline);
+
+    /**
+     *
+     * publishFrame() - (acquisition thread) run the given raw data
+     * through the channel manager and publish the result as the
+     * latest frame for the sender.
+     *
+     * @param raw unsigned int array - the raw input [1]..[15].
+     *
+     * @param stamp uint64_t - when the newest raw input arrived (see
+     * DL32Port::pollSamples() and CANInput::pollSamples()), 0 if never.
+     *
+     * @param dl32Stamp uint64_t - when the newest DL-32 packet arrived,
+     * 0 if never.
+     *
+     * @param fresh unsigned int - which channels are new samples (see
+     * ChannelManager::load()), 0 if it's just the same input again.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool publishFrame(const unsigned int *raw, uint64_t stamp, uint64_t dl32Stamp, unsigned int fresh);
+
+    /**
+     *
+     * realTime() - (sender thread) apply the configured CPU pinning
+     * and SCHED_FIFO priority to the calling thread.  Problems are
+     * only warned about, we can still run without them.
+     *
+     */
+
+    void realTime(void);
+
+    /**
+     *
+     * sendLoop() - the sender thread; on every absolute tick (the
+     * SoloDL tick rate, see [solodl] tick_hz) hand the latest frame
+     * to every output sink, and at ~10hz to the data taps.  With phase
+     * lock on, the tick nearest a predicted DL-32 frame is moved to
+     * just after it, so fresh data goes out right away.
+     *
+     */
+
+    void sendLoop(void);
+
+    /**
+     *
+     * commandLoop() - the command worker thread; take clients off
+     * the queue, read their command, run it, and reply.
+     *
+     */
+
+    void commandLoop(void);
+
+    /**
+     *
+     * isLoopCommand() - true if the given command has to be run on
+     * the acquisition thread (it uses the ChannelManager or the DL-32).
+     *
+     */
+
+    bool isLoopCommand(const string & command);
+
+    /**
+     *
+     * onLoop() - (worker thread) have the acquisition thread run the
+     * given command at the top of its next cycle, and wait for it.
+     *
+     * @param command string - the command to run.
+     *
+     * @param result string - the output of the command.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool onLoop(const string & command, string & result);
+
+    /**
+     *
+     * onLoop() - (worker thread) have the acquisition thread run the
+     * given job at the top of its next cycle, and wait for it.  If the
+     * bridge is stopping the job isn't run, job.result says why; either
+     * it never went in (job.done stays false) or it was still waiting
+     * (job.ok is false, see cancelJobs()).
+     *
+     * @param job LoopJob - the job.
+     *
+     * @return bool - exactly false if the job failed.
+     *
+     */
+
+    bool onLoop(LoopJob & job);
+
+    /**
+     *
+     * channelCurve() - (worker thread) the "channels,curve,<chan>[,step]"
+     * command; the acquisition thread only works out the table (see
+     * ChannelManager::curve()), the checking and the (big) reply are
+     * done here, so the DL-32 isn't kept waiting.
+     *
+     * @param command string - the command.
+     *
+     * @param result string - the output of the command.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool channelCurve(const string & command, string & result);
+
+    /**
+     *
+     * isCurveCommand() - true if the given command is "channels,curve"
+     * (see channelCurve()).
+     *
+     */
+
+    bool isCurveCommand(const string & command);
+
+    /**
+     *
+     * runJobs() - (acquisition thread) run any commands the worker
+     * has passed over to us.
+     *
+     * @return bool - exactly true if any commands were run.
+     *
+     */
+
+    bool runJobs(void);
+
+    /**
+     *
+     * cancelJobs() - (acquisition thread) we're stopping; fail any
+     * waiting commands and refuse any new ones.
+     *
+     */
+
+    void cancelJobs(void);
+
+    /**
+     *
+     * reloadChannels() - (worker thread) build a new ChannelManager
+     * from a fresh read of the .ini file, check it, and leave it in
+     * freshMgr for the acquisition thread to swap in.
+     *
+     * @param result string - what happened, for the client.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool reloadChannels(string & result);
+
+    /**
+     *
+     * swapChannels() - (acquisition thread) if there is a reloaded
+     * ChannelManager waiting, make it the live one and throw away the
+     * old one.
+     *
+     * @return bool - exactly true if we swapped.
+     *
+     */
+
+    bool swapChannels(void);
+
+    /**
+     *
+     * tapLoop() - the tap publisher thread; send each frame the sender
+     * queued out to the raw, normal and output data taps.
+     *
+     */
+
+    void tapLoop(void);
 
     /**
      *
@@ -283,8 +772,19 @@ class ECUBridge : public Object {
 
     bool stop(void) {
       breakbreak = true;
+      return true;
     }
 
+    /**
+     *
+     * requestReload() - ask for the channel configuration to be
+     * reloaded (same as the "reload" command).  Only sets a flag and
+     * pokes the acquisition thread, so its safe from a signal handler.
+     *
+     */
+
+    void requestReload(void);
+
     /**
      *
      * loop() - this is the main processing loop, we pass
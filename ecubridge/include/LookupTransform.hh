@@ -0,0 +1,110 @@
+#ifndef LOOKUPTRANSFORM_HH
+#define LOOKUPTRANSFORM_HH
+
+#include "DataTransformer.hh"
+
+/**
+ *
+ * LookupTransform - a calibration table (a thermistor's, say) worked
+ * out for every possible DL-32 word up front, so y() is just an index.
+ * The table is given as points every 'step' counts starting at 0;
+ * in between we go in a straight line, past the last point we hold it.
+ *
+ */
+
+class LookupTransform : public DataTransformer {
+
+  private:
+
+    vector<unsigned int> table;
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    LookupTransform(void) : table(LookupSize, 0) {
+      setName("Table");
+    }
+
+    /**
+     *
+     * build() - fill in the table from the given points.
+     *
+     * @param step unsigned int - the input counts between points.
+     *
+     * @param points vector of unsigned int - the outputs at 0, step,
+     * 2*step, etc.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool build(unsigned int step, const vector<unsigned int> & points) {
+
+      if((step < 1) || (points.size() < 2)) {
+        return false;
+      }
+
+      for(unsigned int x=0; x<LookupSize; x++) {
+
+        size_t k = x / step;
+
+        if(k+1 >= points.size()) {
+          table[x] = points.back();
+          continue;
+        }
+
+        /* rounded, and either way up (thermistors go down) */
+
+        long long from = points[k];
+        long long rise = (long long)points[k+1] - from;
+        long long run  = step;
+        long long into = (rise * (long long)(x - (k * step))) * 2;
+
+        into += (into < 0) ? -run : run;
+
+        table[x] = (unsigned int)(from + into / (2 * run));
+      }
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * y() - transform 'x' by whatever transformation
+     * function we implement.
+     *
+     */
+
+    virtual unsigned int y(unsigned int x) {
+      return table[(x < LookupSize) ? x : (LookupSize - 1)];
+    }
+
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+
+      TransformForm form(Form::Lookup);
+
+      form.table = table.data();
+
+      return form;
+    }
+
+    /* standard destructor */
+
+    virtual ~LookupTransform() {
+
+    }
+};
+
+
+#endif
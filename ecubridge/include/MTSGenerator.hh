@@ -0,0 +1,195 @@
+#ifndef MTSGENERATOR_HH
+#define MTSGENERATOR_HH
+
+#include "DL32Parser.hh"
+
+#include <string.h>
+
+enum MTSMaxChannels {MTSMaxChannels=32};
+
+/* the biggest packet we'll build: header, channels and a sub-packet */
+
+enum MTSMaxPacket {MTSMaxPacket=2+(2*(MTSMaxChannels+1))};
+
+/* the shapes the channel values can follow */
+
+enum class MTSWaveform {
+  RAMP,
+  SINE,
+  NOISE
+};
+
+/**
+ *
+ * MTSGenerator - makes up Innovate MTS packets, as the DL-32 would
+ * send them (see DL32Parser for the layout), for testing the bridge
+ * without the car.  Each aux channel is a 10 bit value (0..1023)
+ * following a ramp, sine or noise; the channels are spread out in
+ * phase so they don't all read the same.
+ *
+ * Packets can be damaged on purpose, each with its own chance:
+ *
+ *   truncated   - the packet is cut off part way through the payload
+ *   bad header  - the 1st header byte is wrong, so the packet is junk
+ *   sub-packets - an LM-1 or LC-1 word is mixed in with the channels
+ *
+ * The faults come from our own random number generator so a given
+ * seed always produces the same stream.
+ *
+ */
+
+class MTSGenerator : public Object {
+
+  private:
+
+    int channels;
+
+    MTSWaveform waveform;
+
+    /* seconds for one full cycle of the waveform */
+
+    double period;
+
+    /* fault chances, 0..1 */
+
+    double truncateChance;
+    double badHeaderChance;
+    double subPacketChance;
+
+    /* xorshift state */
+
+    uint32_t state;
+
+    /* the values in the last packet built (channel 1 is values[1]) */
+
+    unsigned int values[MTSMaxChannels+1];
+
+    /* counters */
+
+    unsigned long packets;
+    unsigned long truncated;
+    unsigned long badHeaders;
+    unsigned long subPackets;
+
+    /* (helpers) random 32 bits, and a random 0..1 */
+
+    uint32_t random(void);
+
+    double chance(void) {
+      return (double)random() / 4294967296.0;
+    }
+
+    /* (packet() helper) a channel's value at time t */
+
+    unsigned int sample(int chan, double t);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    MTSGenerator(void) : Object("MTSGenerator"), channels(DL32ChannelMax),
+      waveform(MTSWaveform::RAMP), period(10.0), truncateChance(0.0),
+      badHeaderChance(0.0), subPacketChance(0.0), state(1), packets(0),
+      truncated(0), badHeaders(0), subPackets(0) {
+
+      memset(values, 0, sizeof(values));
+    }
+
+    /**
+     *
+     * configure() - set what the packets carry.
+     *
+     * @param n int - # of aux channels, 1..MTSMaxChannels (the bridge
+     * only uses the first DL32ChannelMax).
+     *
+     * @param wave MTSWaveform - the shape the values follow.
+     *
+     * @param seconds double - how long one cycle of the wave takes.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool configure(int n, MTSWaveform wave, double seconds);
+
+    /**
+     *
+     * setFaults() - the chance (0..1) of each kind of damage being
+     * done to a packet.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool setFaults(double truncate, double badHeader, double subPacket);
+
+    /* restart the random numbers (and so the faults) from 'seed' */
+
+    void seed(uint32_t seed) {
+      state = (seed == 0) ? 1 : seed;
+    }
+
+    /**
+     *
+     * packet() - build the next packet.
+     *
+     * @param buf unsigned char array - where to put it, at least
+     * MTSMaxPacket bytes.
+     *
+     * @param t double - the time (seconds) the values are sampled at.
+     *
+     * @return size_t - the # of bytes in the packet.
+     *
+     */
+
+    size_t packet(unsigned char *buf, double t);
+
+    /* the value of a channel in the last packet (1..channels) */
+
+    unsigned int getValue(int chan) const {
+      return values[chan];
+    }
+
+    /**
+     *
+     * word() - the word DL32Parser reports for a channel value (the
+     * two 7 bit bytes as they came in, see DL32Parser::emit()).
+     *
+     */
+
+    static unsigned int word(unsigned int value) {
+      return ((value >> 7) << 8) | (value & 0x7F);
+    }
+
+    /* counters */
+
+    int getChannels(void) const {
+      return channels;
+    }
+
+    unsigned long getPackets(void) const {
+      return packets;
+    }
+
+    unsigned long getTruncated(void) const {
+      return truncated;
+    }
+
+    unsigned long getBadHeaders(void) const {
+      return badHeaders;
+    }
+
+    unsigned long getSubPackets(void) const {
+      return subPackets;
+    }
+
+    /* standard destructor */
+
+    virtual ~MTSGenerator(void) {
+
+    }
+};
+
+#endif
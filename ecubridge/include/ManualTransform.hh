@@ -41,6 +41,26 @@ class ManualTransform : public DataTransformer {
       return parameters[0];
     }
 
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return TransformForm(Form::Constant, parameters[0]);
+    }
+
+    /**
+     *
+     * inverseForm() - what inverse() works out to.
+     *
+     */
+
+    virtual TransformForm inverseForm(void) {
+      return TransformForm(Form::Constant, parameters[0]);
+    }
+
     /* standard destructor */
 
     virtual ~ManualTransform() {
@@ -0,0 +1,222 @@
+#ifndef OUTPUTSINK_HH
+#define OUTPUTSINK_HH
+
+#include "SampleFrame.hh"
+#include "PortMapper.hh"
+
+#include <atomic>
+#include <mutex>
+
+/**
+ *
+ * OutputSink - somewhere the bridge sends its data.  The SoloDL is
+ * one, and the spare ports on the cable can have others (a telemetry
+ * radio, a CSV logger...).  Each sink has its own port, its own
+ * encoding and its own schedule, but they all get the same frame; the
+ * channels are loaded once per DL-32 frame (see
+ * ECUBridge::publishFrame()) and the sender hands that one frame to
+ * every sink on every tick.  A sink that isn't due on a tick just
+ * returns.  Sinks on the cable come and go with it, the others (see
+ * onCable()) stay open.
+ *
+ * Threads: configure(), open() and close() are called from the
+ * acquisition thread (with the sender kept off the ports), send() only
+ * from the sender, and describe() from the command worker; so the
+ * counters are atomic and the port description is kept under a lock.
+ *
+ */
+
+class OutputSink : public Object {
+
+  private:
+
+    /* what the port is, for describe() (see notePort()) */
+
+    std::mutex infoLock;
+    string     portInfo;
+
+    OutputSink(const OutputSink &);
+    OutputSink &operator=(const OutputSink &);
+
+  protected:
+
+    /**
+     *
+     * name - the sink's device name; its section in the configuration
+     * and its name in the [PortMapper] devices list.
+     *
+     */
+
+    string name;
+
+    /* the sender's tick rate, send() is called this often */
+
+    int tickHz;
+
+    /* frames a second this sink sends, and ticks so far (see due()) */
+
+    int rateHz;
+
+    unsigned long tick;
+
+    /* ticks something went out on, and failed sends */
+
+    std::atomic<unsigned long> sent;
+    std::atomic<unsigned long> failed;
+
+    /**
+     *
+     * notePort() - (open()/close() helper) remember what the port is
+     * for describe().
+     *
+     */
+
+    void notePort(const string & info) {
+      std::lock_guard<std::mutex> guard(infoLock);
+      portInfo = info;
+    }
+
+    /**
+     *
+     * configureRate() - (configure() helper) read rate_hz from the
+     * sink's section, 1..hz.
+     *
+     * @param hz int - the sender's tick rate.
+     *
+     * @param defaultHz int - if rate_hz isn't set.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool configureRate(int hz, int defaultHz);
+
+    /**
+     *
+     * due() - (send() helper) count a tick, true if a frame is due on
+     * it; rateHz frames every tickHz ticks, as evenly as they'll go.
+     *
+     */
+
+    bool due(void);
+
+  public:
+
+    /* standard constructor */
+
+    OutputSink(const string & className, const string & sinkName) :
+      Object(className), portInfo("not open"), name(sinkName), tickHz(0),
+      rateHz(0), tick(0), sent(0), failed(0) {
+
+    }
+
+    /**
+     *
+     * getName() - the sink's device name.
+     *
+     */
+
+    const string & getName(void) const {
+      return name;
+    }
+
+    /**
+     *
+     * configure() - read the sink's settings (its section of the
+     * configuration) and plan its schedule.
+     *
+     * @param hz int - the sender's tick rate.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool configure(int hz) = 0;
+
+    /**
+     *
+     * onCable() - true if the sink's port is on the USB cable; it's
+     * found through the PortMapper, and goes away when the cable is
+     * unplugged.  Sinks that aren't (a CAN bus...) are opened once,
+     * with open(void), and don't care about the cable.
+     *
+     */
+
+    virtual bool onCable(void) const {
+      return true;
+    }
+
+    /**
+     *
+     * open() - open the sink's port on the cable (a no-op if it's open
+     * already).
+     *
+     * @param mapper PortMapper - where to find the port.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool open(PortMapper & mapper) {
+      (void)mapper;
+      return open();
+    }
+
+    /**
+     *
+     * open() - open a port that isn't on the cable (see onCable()).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool open(void) {
+      error(string("open() - ") + name + string(" needs the cable's port mapper."));
+      return false;
+    }
+
+    /**
+     *
+     * close() - close the sink's port (i.e. the cable was unplugged).
+     *
+     */
+
+    virtual void close(void) = 0;
+
+    /**
+     *
+     * isOpen() - true if the port is open.
+     *
+     */
+
+    virtual bool isOpen(void) = 0;
+
+    /**
+     *
+     * send() - one sender tick; send whatever is due from the frame.
+     *
+     * @param frame SampleFrame - the current values.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool send(const SampleFrame & frame) = 0;
+
+    /**
+     *
+     * describe() - status lines for the "status" command, one per line
+     * (each ending in a new line).
+     *
+     */
+
+    virtual string describe(void);
+
+    /* standard destructor */
+
+    virtual ~OutputSink(void) {
+
+    }
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef PHASEESTIMATOR_HH
+#define PHASEESTIMATOR_HH
+
+#include "util.hh"
+
+/**
+ *
+ * PhaseEstimator - learns when the next DL-32 frame is going to
+ * arrive.  It's fed the arrival time of each frame (see
+ * DL32Port::pollSamples()) and tracks the frame period and phase with
+ * a simple alpha-beta (PLL style) filter, so one late or early frame
+ * only nudges the prediction, and a missed frame doesn't throw it off.
+ *
+ * The sender uses it to line a send tick up just after a frame arrives,
+ * so the data it sends is as fresh as possible.  If the frames stop
+ * coming, the estimator unlocks and the sender goes back to its fixed
+ * cadence.
+ *
+ * Times are monotonic nanoseconds (see monotonic_ns()).  Only used
+ * from one thread (the sender), so there is no locking.
+ *
+ */
+
+class PhaseEstimator {
+
+  private:
+
+    /**
+     *
+     * ref - the smoothed arrival time of the most recent frame; the
+     * phase reference everything is predicted from.
+     *
+     */
+
+    double ref;
+
+    /**
+     *
+     * period - the smoothed frame period (ns).
+     *
+     */
+
+    double period;
+
+    /**
+     *
+     * jitter - smoothed absolute prediction error (ns).
+     *
+     */
+
+    double jitter;
+
+    /* the raw stamp of the last frame we were given */
+
+    uint64_t last;
+
+    /* # of frames since we (re)started tracking */
+
+    unsigned long frames;
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    PhaseEstimator(void) {
+      reset();
+    }
+
+    /**
+     *
+     * reset() - forget everything, start learning from scratch.
+     *
+     */
+
+    void reset(void) {
+      ref    = 0.0;
+      period = 0.0;
+      jitter = 0.0;
+      last   = 0;
+      frames = 0;
+    }
+
+    /**
+     *
+     * arrival() - tell the estimator a frame arrived.  The same stamp
+     * given again (the same frame re-published) is ignored.
+     *
+     * @param stamp uint64_t - when the frame arrived.
+     *
+     */
+
+    void arrival(uint64_t stamp);
+
+    /**
+     *
+     * locked() - true if we know the period and phase well enough to
+     * predict, and the frames are still coming.
+     *
+     * @param now uint64_t - the current time.
+     *
+     */
+
+    bool locked(uint64_t now) const;
+
+    /**
+     *
+     * next() - the predicted arrival of the first frame at or after
+     * the given time.  Only meaningful if locked().
+     *
+     * @param after uint64_t - the time of interest.
+     *
+     */
+
+    uint64_t next(uint64_t after) const;
+
+    /* the learned frame period and jitter (ns) */
+
+    uint64_t getPeriod(void) const {
+      return (uint64_t)period;
+    }
+
+    uint64_t getJitter(void) const {
+      return (uint64_t)jitter;
+    }
+
+    /* standard destructor */
+
+    ~PhaseEstimator() {
+
+    }
+};
+
+#endif
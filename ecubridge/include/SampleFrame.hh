@@ -0,0 +1,46 @@
+#ifndef SAMPLEFRAME_HH
+#define SAMPLEFRAME_HH
+
+#include "ChannelManager.hh"
+
+/**
+ *
+ * SampleFrame - one complete "current value" of the bridge; the raw
+ * DL-32 input, the normalized data and the final SoloDL output, as
+ * produced by one ChannelManager::load().  Frames are what the
+ * acquisition side hands over to the sender side.  Channels are in
+ * [1]..[CMMaxChannels] just like everywhere else, [0] is unused.
+ *
+ */
+
+struct SampleFrame {
+
+  /* sequence # of the frame, bumped every time a new one is produced */
+
+  unsigned long seq;
+
+  /*
+   * monotonic time (nanoseconds) the newest raw data in the frame
+   * arrived (a DL-32 packet or CAN frames), 0 if we haven't had any
+   * yet.  Frames re-published without new input (i.e. after a command
+   * changed the patch) keep the stamp of the data they were made
+   * from, so age is always age of the data.
+   *
+   */
+
+  uint64_t stamp;
+
+  /*
+   * monotonic time the newest DL-32 packet arrived, 0 if none yet; the
+   * sender phase locks to this, CAN data comes whenever it likes.
+   *
+   */
+
+  uint64_t dl32Stamp;
+
+  unsigned int raw[CMMaxChannels+1];
+  unsigned int normal[CMMaxChannels+1];
+  unsigned int output[CMMaxChannels+1];
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SERIALSINK_HH
+#define SERIALSINK_HH
+
+#include "OutputSink.hh"
+#include "RS232Port.hh"
+
+/* the most a sink's encode() can put out for one frame */
+
+enum SerialSinkMaxFrame {SerialSinkMaxFrame=512};
+
+/**
+ *
+ * SerialSink - an output sink on one of the cable's spare ports that
+ * sends one encoded frame at a fixed rate; sub-classes just encode().
+ * Its section of the configuration has:
+ *
+ *   type    - which kind of sink (see ECUBridge::configure())
+ *   baud    - the port's baud rate (8,N,1), default 57600
+ *   rate_hz - frames a second, 1..the sender's tick rate, default 10
+ *   data    - raw, normal or output; which of the frame's channels to
+ *             send, default normal
+ *
+ * plus usb_slot (or device) like any other device.  The port is
+ * non-blocking; if the device on the other end stalls, frames are
+ * dropped rather than queued up (or waited on), it always gets the
+ * latest values.
+ *
+ */
+
+class SerialSink : public OutputSink {
+
+  private:
+
+    RS232Port *port;
+
+    string baud;
+
+    /* the frame's raw, normal or output channels (see values()) */
+
+    enum SinkData {
+      RAW,
+      NORMAL,
+      OUTPUT
+    };
+
+    SinkData data;
+
+    unsigned char buffer[SerialSinkMaxFrame];
+
+    /* false if the port can't tell us its output queue */
+
+    bool backlogCheck;
+
+    /* bytes sent, frames dropped because of a backlog (or a full port) */
+
+    std::atomic<unsigned long> bytes;
+    std::atomic<unsigned long> dropped;
+
+  protected:
+
+    /**
+     *
+     * values() - the channels from the frame this sink sends ([1]..
+     * [CMMaxChannels]).
+     *
+     */
+
+    const unsigned int *values(const SampleFrame & frame) const {
+
+      switch(data) {
+        case RAW:
+          return frame.raw;
+        case OUTPUT:
+          return frame.output;
+        default:
+          break;
+      }
+
+      return frame.normal;
+    }
+
+    /**
+     *
+     * encode() - format the frame the way the device wants it.
+     *
+     * @param frame SampleFrame - the current values (see values()).
+     *
+     * @param buf unsigned char array - where to put it.
+     *
+     * @param size size_t - how big buf is.
+     *
+     * @return size_t - the # of bytes to send.
+     *
+     */
+
+    virtual size_t encode(const SampleFrame & frame, unsigned char *buf, size_t size) = 0;
+
+  public:
+
+    /* standard constructor */
+
+    SerialSink(const string & className, const string & sinkName) :
+      OutputSink(className, sinkName), port(NULL), baud("57600"),
+      data(NORMAL), backlogCheck(true), bytes(0), dropped(0) {
+
+    }
+
+    /**
+     *
+     * configure() - read baud, rate_hz and data from the sink's section.
+     *
+     * @param hz int - the sender's tick rate.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool configure(int hz);
+
+    /**
+     *
+     * open() - open the sink's port.
+     *
+     * @param mapper PortMapper - where to find the port.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool open(PortMapper & mapper);
+
+    /**
+     *
+     * close() - close the sink's port.
+     *
+     */
+
+    virtual void close(void);
+
+    virtual bool isOpen(void) {
+      return port != NULL;
+    }
+
+    /**
+     *
+     * send() - if a frame is due on this tick, encode it and send it.
+     *
+     * @param frame SampleFrame - the current values.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool send(const SampleFrame & frame);
+
+    /**
+     *
+     * describe() - bytes sent and frames dropped, too.
+     *
+     */
+
+    virtual string describe(void);
+
+    /* standard destructor */
+
+    virtual ~SerialSink(void) {
+      close();
+    }
+};
+
+#endif
@@ -2,57 +2,17 @@
 #define SOLODLPORT_HH
 
 #include "RS232Port.hh"
+#include "ConfigManager.hh"
+#include "TimingWheel.hh"
+#include "AIMProtocol.hh"
 
-enum SoloDLChannelMax {SoloDLChannelMax=15};
-
-/**
- *
- * Channel ids (in order) for the supported data channel
- * types
- *
- */
-
-enum class AIMChannel {
-  RPM           = 1,
-  WHEELSPEED    = 5,
-  OILPRESS      = 9,
-  OILTEMP       = 13,
-  WATERTEMP     = 17,
-  FUELPRESS     = 21,
-  BATTVOLT      = 33,
-  THROTANG      = 45,
-  MANIFPRESS    = 69,
-  AIRCHARGETEMP = 97,
-  EXHTEMP       = 101,
-  LAMBDA        = 105,
-  FUELTEMP      = 109,
-  GEAR          = 113,
-  ERRORFLAG     = 125,
-};
+/* how often writeSamples() is called if [solodl] tick_hz isn't set */
 
-enum class AIMFreq {
-  RPM           = 10,
-  WHEELSPEED    = 10,
-  OILPRESS      = 5,
-  OILTEMP       = 2,
-  WATERTEMP     = 2,
-  FUELPRESS     = 5,
-  BATTVOLT      = 5,
-  THROTANG      = 10,
-  MANIFPRESS    = 10,
-  AIRCHARGETEMP = 2,
-  EXHTEMP       = 2,
-  LAMBDA        = 10,
-  FUELTEMP      = 2,
-  GEAR          = 5,
-  ERRORFLAG     = 2,
-};
+enum SoloDLDefaultTickHz {SoloDLDefaultTickHz=50};
+
+/* what the line can carry, 19200 baud 8N1 */
 
-/**
- *
- * Channel sample rates (in Hz. and in order)
- *
- */
+enum SoloDLBytesPerSecond {SoloDLBytesPerSecond=1920};
 
 class SoloDLPort : public RS232Port {
 
@@ -60,20 +20,24 @@ class SoloDLPort : public RS232Port {
 
     /**
      *
-     * slot - this is just a counter to tell us
-     * which *relative* slice of a second we are on,
-     * its assumed we send samples every 100ms (10hz),
-     * so if any of the channels need a lower frequency
-     * we can just modulo divide to figure out if we
-     * need to send a particualar channel during a
-     * givne slot.  The draw back is that we can't
-     * do sample rates like 6 or 8.  But we don't need
-     * to, and in fact the AIM UART protocol calls
-     * for sample rates of 10, 2, and 5.
+     * wheel - the output schedule; which channels are sent on each
+     * call to writeSamples().  Planned from the per channel rates,
+     * see schedule().
+     *
+     */
+
+    TimingWheel wheel;
+
+    /**
+     *
+     * rates - the send rate (Hz) of each channel, [1]..[15].  The
+     * AIM UART protocol calls for the AIMFreq rates, which are the
+     * default, but they can be changed with the [solodl] rate_N
+     * settings.
      *
      */
 
-    int slot;
+    int rates[SoloDLChannelMax+1];
 
     /**
      *
@@ -85,24 +49,48 @@ class SoloDLPort : public RS232Port {
 
     /**
      *
-     * factor - pre-calculate the divisor we
-     * use to check how often to send a given
-     * channel. (look at writeSamples() to see
-     * how it gets used).
+     * burst - all of a tick's packets, back to back, so they go out
+     * in one write() (and one USB transfer) instead of one each.
      *
      */
 
-    int factor[SoloDLChannelMax+1];
+    unsigned char burst[SoloDLChannelMax*AIMPacketSize];
+
+    /* what we sent; bytes, write() calls and ticks that had packets */
+
+    unsigned long bytesSent;
+    unsigned long writeCalls;
+    unsigned long ticksSent;
 
     /**
      *
-     * chanMap - preCalculate the channel
-     * ids that SoloDL needs to see for each
-     * of our data channels.
+     * backlogLimit - if more than this many bytes are still waiting to
+     * go out when a tick comes around (what the line sends in one
+     * tick), the SoloDL side has stalled and anything queued is stale.
      *
      */
 
-    unsigned short chanMap[SoloDLChannelMax+1];
+    long backlogLimit;
+
+    /**
+     *
+     * flushBacklog - on a stall, throw away the stale bytes and send
+     * this tick's (true), or skip ticks until the queue drains (false).
+     * The [solodl] flush_backlog setting.
+     *
+     */
+
+    bool flushBacklog;
+
+    /* false if the port can't tell us its output queue */
+
+    bool backlogCheck;
+
+    /* ticks skipped, flushes done and bytes flushed, for a backlog */
+
+    unsigned long backlogSkips;
+    unsigned long backlogFlushes;
+    unsigned long flushedBytes;
 
   protected:
 
@@ -115,47 +103,15 @@ class SoloDLPort : public RS232Port {
      */
 
     SoloDLPort(const string & path="") :
-      RS232Port(path, "19200,8,N,1", false), slot(0) {
+      RS232Port(path, "19200,8,N,1", false), bytesSent(0), writeCalls(0), ticksSent(0),
+      backlogLimit(SoloDLBytesPerSecond / SoloDLDefaultTickHz), flushBacklog(false), backlogCheck(true),
+      backlogSkips(0), backlogFlushes(0), flushedBytes(0) {
 
       setClassName("SoloDLPort");
 
-      /* pre-calculate - sample rates */
-
-      factor[0]  = 0;
-      factor[1]  = 10 / (int)AIMFreq::RPM;
-      factor[2]  = 10 / (int)AIMFreq::WHEELSPEED;
-      factor[3]  = 10 / (int)AIMFreq::OILPRESS;
-      factor[4]  = 10 / (int)AIMFreq::OILTEMP;
-      factor[5]  = 10 / (int)AIMFreq::WATERTEMP;
-      factor[6]  = 10 / (int)AIMFreq::FUELPRESS;
-      factor[7]  = 10 / (int)AIMFreq::BATTVOLT;
-      factor[8]  = 10 / (int)AIMFreq::THROTANG;
-      factor[9]  = 10 / (int)AIMFreq::MANIFPRESS;
-      factor[10] = 10 / (int)AIMFreq::AIRCHARGETEMP;
-      factor[11] = 10 / (int)AIMFreq::EXHTEMP;
-      factor[12] = 10 / (int)AIMFreq::LAMBDA;
-      factor[13] = 10 / (int)AIMFreq::FUELTEMP;
-      factor[14] = 10 / (int)AIMFreq::GEAR;
-      factor[15] = 10 / (int)AIMFreq::ERRORFLAG;
-
-      /* pre-calculate - channel ids */
-
-      chanMap[0]  = 0;
-      chanMap[1]  = (int)AIMChannel::RPM;
-      chanMap[2]  = (int)AIMChannel::WHEELSPEED;
-      chanMap[3]  = (int)AIMChannel::OILPRESS;
-      chanMap[4]  = (int)AIMChannel::OILTEMP;
-      chanMap[5]  = (int)AIMChannel::WATERTEMP;
-      chanMap[6]  = (int)AIMChannel::FUELPRESS;
-      chanMap[7]  = (int)AIMChannel::BATTVOLT;
-      chanMap[8]  = (int)AIMChannel::THROTANG;
-      chanMap[9]  = (int)AIMChannel::MANIFPRESS;
-      chanMap[10] = (int)AIMChannel::AIRCHARGETEMP;
-      chanMap[11] = (int)AIMChannel::EXHTEMP;
-      chanMap[12] = (int)AIMChannel::LAMBDA;
-      chanMap[13] = (int)AIMChannel::FUELTEMP;
-      chanMap[14] = (int)AIMChannel::GEAR;
-      chanMap[15] = (int)AIMChannel::ERRORFLAG;
+      /* default sample rates */
+
+      memcpy(rates, AIMRates, sizeof(rates));
 
       if(!isReady()) {
 
@@ -163,8 +119,26 @@ class SoloDLPort : public RS232Port {
 
         error("Could not setup Solo DL port.");
 
+      } else if(!schedule()) {
+
+        /* bad rates in the configuration */
+
+        unReady();
+
+      } else if(!configureLatency("solodl")) {
+
+        /* bad latency settings in the configuration */
+
+        unReady();
+
       } else {
 
+        IniFile & ini = ConfigManager::instance();
+
+        if(ini.isReady()) {
+          flushBacklog = ini.enabled("solodl", "flush_backlog");
+        }
+
         info("Solo DL is ready.");
       }
     }
@@ -183,6 +157,51 @@ class SoloDLPort : public RS232Port {
       return *this;
     }
 
+    /**
+     *
+     * configuredTickHz() - how often writeSamples() expects to
+     * be called; the [solodl] tick_hz setting, or
+     * SoloDLDefaultTickHz if its not set.
+     *
+     * @return int - the tick rate (Hz), or 0 if the setting
+     * is bad.
+     *
+     */
+
+    static int configuredTickHz(void);
+
+    /**
+     *
+     * schedule() - (re)plan the output schedule from the tick
+     * rate and the [solodl] rate_N settings (any channel that
+     * doesn't have one keeps its AIMFreq rate).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool schedule(void);
+
+    /**
+     *
+     * getTickHz() - the tick rate we are scheduled for.
+     *
+     */
+
+    int getTickHz(void) const {
+      return wheel.getTickHz();
+    }
+
+    /**
+     *
+     * getSchedule() - human readable output schedule.
+     *
+     */
+
+    string getSchedule(void) const {
+      return wheel.describe();
+    }
+
     /**
      *
      * writeSamples() - assuming data is ready to be
@@ -197,10 +216,10 @@ class SoloDLPort : public RS232Port {
      *
      * @return bool - exactly false on error.
      *
-     * NOTE: we assume (per AIM protocol) that this method
-     * will be called with a frequency of 10hz (every 100ms).
-     * If you don't call it with that frequency, you will
-     * need to adjust the code below.
+     * NOTE: this must be called at the tick rate (see
+     * getTickHz()), every call advances the output schedule
+     * by one tick and sends only the channels due on that
+     * tick.  The samples array is not changed.
      *
      * NOTE: channels are assumed to be in this following
      * order from samples[1] .. samples[15]:
@@ -226,6 +245,34 @@ class SoloDLPort : public RS232Port {
 
     bool writeSamples(unsigned int *samples);
 
+    /* what we've sent so far; bytes, write() calls, ticks with packets */
+
+    unsigned long getBytesSent(void) const {
+      return bytesSent;
+    }
+
+    unsigned long getWriteCalls(void) const {
+      return writeCalls;
+    }
+
+    unsigned long getTicksSent(void) const {
+      return ticksSent;
+    }
+
+    /* what we've done about backlogs; ticks skipped, flushes, bytes flushed */
+
+    unsigned long getBacklogSkips(void) const {
+      return backlogSkips;
+    }
+
+    unsigned long getBacklogFlushes(void) const {
+      return backlogFlushes;
+    }
+
+    unsigned long getFlushedBytes(void) const {
+      return flushedBytes;
+    }
+
     /* standard destructor */
 
     virtual ~SoloDLPort(void) {
@@ -0,0 +1,117 @@
+#ifndef SOLODLSINK_HH
+#define SOLODLSINK_HH
+
+#include "OutputSink.hh"
+#include "SoloDLPort.hh"
+
+/**
+ *
+ * SoloDLSink - the SoloDL as an output sink; the AIM UART protocol on
+ * the SoloDL's own output schedule (see SoloDLPort).  Sends the frame's
+ * output (SoloDL) channels.
+ *
+ */
+
+class SoloDLSink : public OutputSink {
+
+  private:
+
+    SoloDLPort *port;
+
+    /*
+     * what the ports we had before the current one sent (the port's
+     * own counters start over every time its re-opened).
+     *
+     */
+
+    unsigned long baseBytes;
+    unsigned long baseWrites;
+    unsigned long baseTicks;
+    unsigned long baseSkips;
+    unsigned long baseFlushes;
+    unsigned long baseFlushed;
+
+    /* the totals, for describe() */
+
+    std::atomic<unsigned long> bytes;
+    std::atomic<unsigned long> writes;
+    std::atomic<unsigned long> skips;
+    std::atomic<unsigned long> flushes;
+    std::atomic<unsigned long> flushed;
+
+  public:
+
+    /* standard constructor */
+
+    SoloDLSink(void) : OutputSink("SoloDLSink", PortMapper::deviceName(Device::SOLODL)),
+      port(NULL), baseBytes(0), baseWrites(0), baseTicks(0), baseSkips(0), baseFlushes(0),
+      baseFlushed(0), bytes(0), writes(0), skips(0), flushes(0), flushed(0) {
+
+    }
+
+    /**
+     *
+     * configure() - the SoloDL's schedule is planned by the port
+     * itself, from [solodl]; the sender must be ticking at its rate.
+     *
+     * @param hz int - the sender's tick rate.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool configure(int hz);
+
+    /**
+     *
+     * open() - open the SoloDL port.
+     *
+     * @param mapper PortMapper - where to find the port.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool open(PortMapper & mapper);
+
+    /**
+     *
+     * close() - close the SoloDL port.
+     *
+     */
+
+    virtual void close(void);
+
+    virtual bool isOpen(void) {
+      return port != NULL;
+    }
+
+    /**
+     *
+     * send() - send the output channels due on this tick.
+     *
+     * @param frame SampleFrame - the current values.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    virtual bool send(const SampleFrame & frame);
+
+    /**
+     *
+     * describe() - bytes and write() calls per tick, and what we did
+     * about backlogs.
+     *
+     */
+
+    virtual string describe(void);
+
+    /* standard destructor */
+
+    virtual ~SoloDLSink(void) {
+      close();
+    }
+};
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef STREAMTRANSFORM_HH
+#define STREAMTRANSFORM_HH
+
+#include "DataTransformer.hh"
+
+/* the longest window (history) a streaming filter can keep */
+
+enum StreamMaxWindow {StreamMaxWindow=32};
+
+/**
+ *
+ * StreamTransform - a filter that depends on the samples before this
+ * one too, set up as one of:
+ *
+ *   ema      - exponential moving average, alpha of the new sample
+ *   average  - the mean of the last n samples
+ *   median   - the middle of the last n samples (drops spikes)
+ *   rate     - moves at most step per sample towards the input
+ *   debounce - only changes once the input has held a new value
+ *              for n samples in a row (i.e. gear)
+ *
+ * The history is kept in fixed size rings, nothing is allocated once
+ * its set up.  The first sample is taken as is, and a steady input
+ * always comes out as itself.
+ *
+ * y() has to be called exactly once per new sample, the ChannelManager
+ * sees to that (see Form::Stream).
+ *
+ */
+
+class StreamTransform : public DataTransformer {
+
+  private:
+
+    enum class StreamKind {
+      EMA,
+      Average,
+      Median,
+      Rate,
+      Debounce
+    };
+
+    StreamKind kind;
+
+    /* the window, ema's alpha, or rate's step */
+
+    int          window;
+    double       alpha;
+    unsigned int step;
+
+    /* samples seen (up to window), and where the next one goes in ring */
+
+    int filled;
+    int pos;
+
+    unsigned int ring[StreamMaxWindow];
+
+    /* median: the same samples as ring, in order */
+
+    unsigned int sorted[StreamMaxWindow];
+
+    /* average: the sum of ring; ema: the running value */
+
+    unsigned long long sum;
+    double             level;
+
+    /* the last output, and debounce's candidate and how long its held */
+
+    unsigned int last;
+    unsigned int candidate;
+    int          held;
+
+    /* median() helper: take one 'x' out of sorted */
+
+    void unsort(unsigned int x) {
+
+      int k = 0;
+
+      while((k < filled-1) && (sorted[k] != x)) {
+        k++;
+      }
+
+      for(; k<filled-1; k++) {
+        sorted[k] = sorted[k+1];
+      }
+
+      filled--;
+    }
+
+    /* median() helper: put 'x' in sorted, in order */
+
+    void insort(unsigned int x) {
+
+      int k = filled;
+
+      while((k > 0) && (sorted[k-1] > x)) {
+        sorted[k] = sorted[k-1];
+        k--;
+      }
+
+      sorted[k] = x;
+
+      filled++;
+    }
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    StreamTransform(void) : kind(StreamKind::EMA), window(1), alpha(1.0), step(0),
+      filled(0), pos(0), sum(0), level(0.0), last(0), candidate(0), held(0) {
+
+      setName("Stream");
+    }
+
+    /**
+     *
+     * ema() - level += alpha * (x - level), per sample.
+     *
+     * @param a double - alpha, more than 0 and at most 1 (1 is no
+     * filtering at all).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool ema(double a) {
+
+      if((a <= 0.0) || (a > 1.0)) {
+        return false;
+      }
+
+      kind  = StreamKind::EMA;
+      alpha = a;
+
+      setName("EMA");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * average() - the mean of the last n samples (rounded).
+     *
+     * @param n int - the window, 1..StreamMaxWindow.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool average(int n) {
+
+      if((n < 1) || (n > StreamMaxWindow)) {
+        return false;
+      }
+
+      kind   = StreamKind::Average;
+      window = n;
+
+      setName("Average");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * median() - the middle of the last n samples; the lower of the
+     * two middle ones if n is even.  Each sample costs at most n
+     * moves in the (tiny) sorted window.
+     *
+     * @param n int - the window, 1..StreamMaxWindow.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool median(int n) {
+
+      if((n < 1) || (n > StreamMaxWindow)) {
+        return false;
+      }
+
+      kind   = StreamKind::Median;
+      window = n;
+
+      setName("Median");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * rate() - follow the input, but never move more than s per sample.
+     *
+     * @param s unsigned int - the most change per sample, at least 1.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool rate(unsigned int s) {
+
+      if(s < 1) {
+        return false;
+      }
+
+      kind = StreamKind::Rate;
+      step = s;
+
+      setName("Rate");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * debounce() - only take a new value once it's been the input for
+     * n samples in a row.
+     *
+     * @param n int - how many, 1..StreamMaxWindow (1 is no filtering).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool debounce(int n) {
+
+      if((n < 1) || (n > StreamMaxWindow)) {
+        return false;
+      }
+
+      kind   = StreamKind::Debounce;
+      window = n;
+
+      setName("Debounce");
+
+      /* all done */
+
+      return true;
+    }
+
+    /**
+     *
+     * y() - take the next sample, and give the filtered value.
+     *
+     */
+
+    virtual unsigned int y(unsigned int x) {
+
+      if(filled == 0) {
+
+        /* the first sample, is where we start */
+
+        level     = (double)x;
+        last      = x;
+        candidate = x;
+        held      = 0;
+      }
+
+      switch(kind) {
+
+        case StreamKind::EMA:
+
+          level += alpha * ((double)x - level);
+          last   = (unsigned int)(level + 0.5);
+          filled = 1;
+          break;
+
+        case StreamKind::Average:
+
+          if(filled == window) {
+            sum -= ring[pos];
+          } else {
+            filled++;
+          }
+
+          ring[pos] = x;
+          sum      += x;
+          pos       = (pos + 1) % window;
+
+          last = (unsigned int)((sum + (unsigned long long)(filled / 2)) / (unsigned long long)filled);
+          break;
+
+        case StreamKind::Median:
+
+          if(filled == window) {
+            unsort(ring[pos]);
+          }
+
+          insort(x);
+
+          ring[pos] = x;
+          pos       = (pos + 1) % window;
+
+          last = sorted[(filled - 1) / 2];
+          break;
+
+        case StreamKind::Rate:
+
+          if(x > last) {
+            last += ((x - last) > step) ? step : (x - last);
+          } else {
+            last -= ((last - x) > step) ? step : (last - x);
+          }
+          filled = 1;
+          break;
+
+        case StreamKind::Debounce:
+
+          if(x == last) {
+            held = 0;
+          } else if((x == candidate) && (held > 0)) {
+            held++;
+          } else {
+            candidate = x;
+            held      = 1;
+          }
+
+          if(held >= window) {
+            last = x;
+            held = 0;
+          }
+          filled = 1;
+          break;
+      }
+
+      return last;
+    }
+
+    /**
+     *
+     * yForm() - what y() works out to.
+     *
+     */
+
+    virtual TransformForm yForm(void) {
+      return TransformForm(Form::Stream);
+    }
+
+    /* standard destructor */
+
+    virtual ~StreamTransform() {
+
+    }
+};
+
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef TIMINGWHEEL_HH
+#define TIMINGWHEEL_HH
+
+#include "Object.hh"
+
+enum TimingWheelMaxHz {TimingWheelMaxHz=200};
+
+/**
+ *
+ * TimingWheel - a multi-rate output scheduler.  The wheel turns
+ * once a second and has one slot per tick (so tickHz slots), each
+ * slot lists the channels that are due on that tick.  Every channel
+ * gets its own rate (in Hz, up to tickHz); rates don't have to divide
+ * evenly into tickHz, i.e. 4, 6 or 8 Hz on a 50 Hz wheel just get
+ * slightly uneven gaps.
+ *
+ * Channels are spread out over the slots so that we don't burst
+ * every channel onto the same tick; each channel is given a phase
+ * (starting slot) so that the busiest slot is as quiet as possible.
+ * A greedy pass gives a good plan, and then a small (bounded) search
+ * looks for a plan with fewer packets in the busiest slot.
+ * So with a tick rate above the protocol rate (i.e. 50 Hz for 10 Hz
+ * channels) each 100ms window gets its packets in several small
+ * sub-slot groups instead of one burst.
+ *
+ * All the planning is done in configure(), next() is just an index
+ * and a reference, no allocation.
+ *
+ */
+
+class TimingWheel : public Object {
+
+  private:
+
+    /**
+     *
+     * tickHz - ticks per second (and slots in the wheel).
+     *
+     */
+
+    int tickHz;
+
+    /**
+     *
+     * slot - the slot we handed out last.
+     *
+     */
+
+    int slot;
+
+    /**
+     *
+     * wheel - for each slot, the channels due on that tick.
+     *
+     */
+
+    vector< vector<unsigned short> > wheel;
+
+    /**
+     *
+     * slotOf() - the slot a channel's k'th send lands on, if it
+     * starts at the given phase and repeats every 'interval' slots.
+     *
+     */
+
+    int slotOf(int phase, int k, double interval) const;
+
+    /**
+     *
+     * fit() - (configure() helper) depth first search for phases of
+     * order[i..] that keep every slot at or under 'limit' packets.
+     * Gives up (false) when 'budget' runs out.
+     *
+     */
+
+    bool fit(const vector<int> & order, const int *rates, size_t i, int limit,
+             vector<int> & load, vector<int> & phase, long & budget) const;
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    TimingWheel(void) : Object("TimingWheel"), tickHz(0), slot(-1) {
+
+    }
+
+    /**
+     *
+     * configure() - plan the wheel.
+     *
+     * @param hz int - ticks per second, 1..TimingWheelMaxHz.
+     *
+     * @param rates int array - the rate (Hz) of each channel, channels
+     * are [1] .. [channels], 0 means never send it.  No rate may be
+     * more than the tick rate.
+     *
+     * @param channels int - the # of channels.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool configure(int hz, const int *rates, int channels);
+
+    /**
+     *
+     * next() - advance one tick, and fetch the channels that are due.
+     *
+     */
+
+    const vector<unsigned short> & next(void) {
+
+      slot++;
+
+      if(slot >= tickHz) {
+        slot = 0;
+      }
+
+      return wheel[slot];
+    }
+
+    /**
+     *
+     * getTickHz() - the tick rate we were configured with.
+     *
+     */
+
+    int getTickHz(void) const {
+      return tickHz;
+    }
+
+    /**
+     *
+     * describe() - human readable plan, one line per slot:
+     *
+     *   slot 0: 1 3
+     *   slot 1: 2 ...
+     *
+     */
+
+    string describe(void) const;
+
+    /* standard destructor */
+
+    virtual ~TimingWheel(void) {
+
+    }
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include <locale.h>
 #include <unistd.h>
 #include <string.h>
+#include <atomic>
 
 /**
  *
@@ -83,7 +84,9 @@ class USBCable : public Object {
 
     } cabledetails;
 
-    bool connected;
+    /* (set by the acquisition thread, the status command reads it too) */
+
+    std::atomic<bool> connected;
 
     /**
      *
@@ -0,0 +1,196 @@
+#include "AIMCANSink.hh"
+#include "ConfigManager.hh"
+
+/**
+ *
+ * configure() - read interface, can_id and rate_hz from the
+ * sink's section.
+ *
+ * @param hz int - the sender's tick rate.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool AIMCANSink::configure(int hz) {
+
+  IniFile & ini = ConfigManager::instance();
+
+  if(!ini.isReady()) {
+    error("configure() - no configuration.");
+    return false;
+  }
+
+  string tmp = trim(ini.getValue(name, "interface"));
+
+  ifName = tmp.empty() ? string("can0") : tmp;
+
+  canId = AIMCANDefaultId;
+
+  tmp = trim(ini.getValue(name, "can_id"));
+
+  if(!tmp.empty()) {
+
+    char *end = NULL;
+
+    unsigned long id = strtoul(tmp.c_str(), &end, 0);
+
+    if((end == tmp.c_str()) || (*end != '\0') || (id > CAN_SFF_MASK)) {
+      error(string("configure() - [") + name + string("] can_id must be an 11 bit id (i.e. 0x5F0): ") + tmp);
+      return false;
+    }
+
+    canId = (canid_t)id;
+  }
+
+  if(!configureRate(hz, hz)) {
+    return false;
+  }
+
+  /* cut the stream into 8 byte frames, the last one gets what's left */
+
+  memset(frames, 0, sizeof(frames));
+
+  for(int i=0; i<AIMSeqFrames; i++) {
+
+    int left = AIMSeqSize - (i * 8);
+
+    frames[i].can_id  = canId;
+    frames[i].can_dlc = (left < 8) ? left : 8;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * open() - open the CAN socket.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool AIMCANSink::open(void) {
+
+  if(port != NULL) {
+    return true;
+  }
+
+  port = new CANSocket(ifName);
+
+  if(!port->isReady()) {
+    error(string("open() - can not open ") + name + string(" on ") + ifName);
+    delete port;
+    port = NULL;
+    return false;
+  }
+
+  /* we only send, don't let frames from the bus pile up on us */
+
+  if(!port->setFilter(vector<canid_t>())) {
+    warning(string("open() - can not filter ") + name + string(", ignoring: ") + port->getError());
+  }
+
+  char id[16];
+
+  snprintf(id, sizeof(id), "0x%03X", (unsigned int)canId);
+
+  notePort(ifName + string(" id ") + string(id) + string(", ") + to_string(rateHz) + string(" Hz"));
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * close() - close the CAN socket.
+ *
+ */
+
+void AIMCANSink::close(void) {
+
+  if(port == NULL) {
+    return;
+  }
+
+  delete port;
+  port = NULL;
+
+  notePort("not open");
+}
+
+/**
+ *
+ * send() - if a stream is due on this tick, send it.
+ *
+ * @param frame SampleFrame - the current values.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool AIMCANSink::send(const SampleFrame & frame) {
+
+  if((port == NULL) || !due()) {
+    return true;
+  }
+
+  /* the output channels are in UART units, PROT_CAN has its own */
+
+  unsigned int  values[SoloDLChannelMax+1];
+  unsigned char stream[AIMSeqFrames * 8];
+
+  values[0] = 0;
+
+  for(int chan=1; chan<=SoloDLChannelMax; chan++) {
+    values[chan] = aimCANValue(chan, frame.output[chan]);
+  }
+
+  aimSequential(stream, values);
+
+  for(int i=0; i<AIMSeqFrames; i++) {
+    memcpy(frames[i].data, stream + (i * 8), frames[i].can_dlc);
+  }
+
+  int n = port->send(frames, AIMSeqFrames);
+
+  if(n < 0) {
+    failed++;
+    error(string("send() - can't send to ") + name);
+    return false;
+  }
+
+  canFrames += n;
+
+  /*
+   * the bus is backed up (or nobody is acking); a partial stream is
+   * just dropped, the logger re-syncs on the next set of markers.
+   *
+   */
+
+  if(n < AIMSeqFrames) {
+    dropped++;
+    return true;
+  }
+
+  sent++;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * describe() - CAN frames sent and streams dropped, too.
+ *
+ */
+
+string AIMCANSink::describe(void) {
+
+  return OutputSink::describe() + string("  ") + name + string(": ") + to_string(canFrames)
+    + string(" CAN frames, ") + to_string(dropped) + string(" streams dropped (bus busy)\n");
+}
@@ -0,0 +1,400 @@
+#include "CANInput.hh"
+#include "ConfigManager.hh"
+
+/* standard constructor, configures from [can input] */
+
+CANInput::CANInput(void) : Object("CANInput"), ifName("can0"), port(NULL),
+  frames(0), decoded(0), reads(0), opened(false) {
+
+  unReady();
+
+  if(configure()) {
+    makeReady();
+  }
+}
+
+/**
+ *
+ * parseField() - (configure() helper) parse a chan_N setting:
+ *
+ *   id, start bit, # of bits [, little|big|motorola]
+ *
+ * An id with an 'x' on the end (0x5F3x) is an extended id, so are
+ * any above 0x7FF.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CANInput::parseField(int chan, const string & spec, CANField & field) {
+
+  vector<string> tokens;
+
+  explode(spec, ", \t", tokens);
+
+  if((tokens.size() < 3) || (tokens.size() > 4)) {
+    error(string("configure() - chan_") + to_string(chan) + string(" must be: id, start bit, bits [, little|big|motorola]"));
+    return false;
+  }
+
+  /* 0x5F3x - an extended id, even though it would fit in 11 bits */
+
+  string idText   = tokens[0];
+  bool   extended = false;
+
+  if((idText.size() > 1) && (tolower(idText[idText.size()-1]) == 'x')) {
+    idText.erase(idText.size()-1);
+    extended = true;
+  }
+
+  char *end = NULL;
+
+  unsigned long id = strtoul(idText.c_str(), &end, 0);
+
+  if(idText.empty() || (*end != '\0') || (id > CAN_EFF_MASK)) {
+    error(string("configure() - chan_") + to_string(chan) + string(" has a bad CAN id: ") + tokens[0]);
+    return false;
+  }
+
+  if(!is_numeric(tokens[1]) || !is_numeric(tokens[2])) {
+    error(string("configure() - chan_") + to_string(chan) + string(" start and bits must be numbers."));
+    return false;
+  }
+
+  field.id        = (extended || (id > CAN_SFF_MASK)) ? ((canid_t)id | CAN_EFF_FLAG) : (canid_t)id;
+  field.chan      = chan;
+  field.start     = (int)strtol(tokens[1].c_str(), NULL, 10);
+  field.bits      = (int)strtol(tokens[2].c_str(), NULL, 10);
+  field.bigEndian = false;
+
+  if(tokens.size() == 4) {
+
+    string order = strtolower(tokens[3]);
+
+    if((order == "big") || (order == "be")) {
+
+      field.bigEndian = true;
+
+    } else if((order == "motorola") || (order == "dbc")) {
+
+      /*
+       * a .dbc start bit; the field's highest bit, as byte * 8 + bit
+       * (bit 0 is the low bit of its byte).  Turn it into ours, counted
+       * from the top bit of byte 0.
+       *
+       */
+
+      if((field.start < 0) || (field.start > 63)) {
+        error(string("configure() - chan_") + to_string(chan) + string(" motorola start bit must be 0..63."));
+        return false;
+      }
+
+      field.start     = (field.start / 8) * 8 + (7 - (field.start % 8));
+      field.bigEndian = true;
+
+    } else if((order != "little") && (order != "le") && (order != "intel")) {
+      error(string("configure() - chan_") + to_string(chan) + string(" byte order must be little, big or motorola: ") + tokens[3]);
+      return false;
+    }
+  }
+
+  if((field.bits < 1) || (field.bits > 32) || (field.start < 0) || ((field.start + field.bits) > 64)) {
+    error(string("configure() - chan_") + to_string(chan) + string(" field must be 1..32 bits within the 8 data bytes."));
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * configure() - read the interface and the channel mapping from
+ * [can input]; no mapped channels means no CAN input (see
+ * isEnabled()).
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CANInput::configure(void) {
+
+  IniFile & ini = ConfigManager::instance();
+
+  if(!ini.isReady()) {
+    error("configure() - no configuration.");
+    return false;
+  }
+
+  fields.clear();
+  ids.clear();
+
+  string tmp = trim(ini.getValue("can input", "interface"));
+
+  ifName = tmp.empty() ? string("can0") : tmp;
+
+  for(int chan=1; chan<=CMMaxChannels; chan++) {
+
+    string spec = trim(ini.getValue("can input", string("chan_") + to_string(chan)));
+
+    if(spec.empty()) {
+      continue;
+    }
+
+    CANField field;
+
+    if(!parseField(chan, spec, field)) {
+      return false;
+    }
+
+    fields.push_back(field);
+
+    if(std::find(ids.begin(), ids.end(), field.id) == ids.end()) {
+      ids.push_back(field.id);
+    }
+  }
+
+  if(!fields.empty()) {
+    info(string("configure() - ") + to_string(fields.size()) + string(" channels from ")
+      + to_string(ids.size()) + string(" CAN ids on ") + ifName);
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * open() - open the CAN socket and set its filter.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CANInput::open(void) {
+
+  if(port != NULL) {
+    return true;
+  }
+
+  port = new CANSocket(ifName);
+
+  if(!port->isReady() || !port->setFilter(ids)) {
+    error(string("open() - can not open CAN input on ") + ifName);
+    delete port;
+    port = NULL;
+    return false;
+  }
+
+  opened = true;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * close() - close the CAN socket.
+ *
+ */
+
+void CANInput::close(void) {
+
+  if(port != NULL) {
+    delete port;
+    port = NULL;
+  }
+
+  opened = false;
+}
+
+/**
+ *
+ * extract() - a field's value from a frame.
+ *
+ * @param frame can_frame - the frame.
+ *
+ * @param field CANField - the field.
+ *
+ * @param value unsigned int - the value.
+ *
+ * @return bool - exactly false if the frame is too short.
+ *
+ */
+
+bool CANInput::extract(const struct can_frame & frame, const CANField & field, unsigned int & value) {
+
+  if((field.start + field.bits) > (frame.can_dlc * 8)) {
+    return false;
+  }
+
+  uint64_t bits = 0;
+  uint64_t mask = (field.bits == 64) ? ~0ULL : ((1ULL << field.bits) - 1ULL);
+
+  if(field.bigEndian) {
+
+    for(int i=0; i<8; i++) {
+      bits = (bits << 8) | ((i < frame.can_dlc) ? frame.data[i] : 0);
+    }
+
+    value = (unsigned int)((bits >> (64 - field.start - field.bits)) & mask);
+
+  } else {
+
+    for(int i=7; i>=0; i--) {
+      bits = (bits << 8) | ((i < frame.can_dlc) ? frame.data[i] : 0);
+    }
+
+    value = (unsigned int)((bits >> field.start) & mask);
+  }
+
+  return true;
+}
+
+/**
+ *
+ * decode() - put every field the frame carries in 'samples'.
+ *
+ * @param frame can_frame - the frame.
+ *
+ * @param samples unsigned int array - the input channels, at
+ * least CMMaxChannels+1.
+ *
+ * @param which unsigned int pointer - if not NULL, the bit for each
+ * channel set (1 << chan) is turned on.
+ *
+ * @return int - the # of channels set.
+ *
+ */
+
+int CANInput::decode(const struct can_frame & frame, unsigned int *samples, unsigned int *which) {
+
+  /* data frames only, and just the id (and whether its extended) */
+
+  if(frame.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) {
+    return 0;
+  }
+
+  canid_t id = frame.can_id & (CAN_EFF_FLAG | CAN_EFF_MASK);
+  int     n  = 0;
+
+  for(auto & field : fields) {
+
+    if(field.id != id) {
+      continue;
+    }
+
+    unsigned int value = 0;
+
+    if(extract(frame, field, value)) {
+
+      samples[field.chan] = value;
+      n++;
+
+      if(which != NULL) {
+        *which |= (1u << field.chan);
+      }
+    }
+  }
+
+  return n;
+}
+
+/**
+ *
+ * pollSamples() - read whatever frames are waiting, without
+ * waiting, and decode them into 'samples' (later frames win).
+ *
+ * @param samples unsigned int array - the input channels, at
+ * least CMMaxChannels+1.
+ *
+ * @param fresh bool - set true if any channel was set.
+ *
+ * @param which unsigned int pointer - if not NULL, set to which
+ * channels were set (bit i for channel i, see ChannelManager::load()).
+ *
+ * @param stamp uint64_t pointer - if not NULL, and a channel was
+ * set, set to the monotonic time the (last) frames that set them
+ * were read.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CANInput::pollSamples(unsigned int *samples, bool & fresh, unsigned int *which, uint64_t *stamp) {
+
+  fresh = false;
+
+  if(which != NULL) {
+    *which = 0;
+  }
+
+  if(port == NULL) {
+    error("pollSamples() - CAN input is not open.");
+    return false;
+  }
+
+  /* keep going until the socket is empty (a full batch means maybe more) */
+
+  while(true) {
+
+    int n = port->receive(batch, CANInputBatch);
+
+    reads++;
+
+    if(n < 0) {
+      error(string("pollSamples() - can not read: ") + port->getError());
+      return false;
+    }
+
+    /* (the clock the DL-32's packets are stamped with too) */
+
+    uint64_t now   = (n > 0) ? monotonic_ns() : 0;
+    bool     isSet = false;
+
+    for(int i=0; i<n; i++) {
+
+      int got = decode(batch[i], samples, which);
+
+      if(got > 0) {
+        decoded += got;
+        isSet    = true;
+      }
+    }
+
+    if(isSet) {
+
+      fresh = true;
+
+      if(stamp != NULL) {
+        *stamp = now;
+      }
+    }
+
+    frames += n;
+
+    if(n < CANInputBatch) {
+      break;
+    }
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * describe() - a status line for "status".
+ *
+ */
+
+string CANInput::describe(void) {
+
+  return string("   can: ") + to_string(frames) + string(" frames, ") + to_string(decoded)
+    + string(" values, ") + to_string(reads) + string(" reads on ") + ifName
+    + (opened ? string("") : string(" (not open)")) + string("\n");
+}
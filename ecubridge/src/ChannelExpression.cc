@@ -0,0 +1,504 @@
+#include "ChannelExpression.hh"
+
+#include <cstdlib>
+
+/**
+ *
+ * exec() - run a program on a stack; eval() and the constant folding
+ * in emit() both use this, so they can't disagree.
+ *
+ */
+
+static double exec(const ExprCode *code, int length, const unsigned int *normal) {
+
+  double stack[ExprMaxStack];
+  int    sp = 0;
+
+  stack[0] = 0.0;
+
+  for(int k=0; k<length; k++) {
+
+    const ExprCode & c = code[k];
+
+    /* (binary ops leave their result in a, one down from b) */
+
+    double & a = stack[(sp > 1) ? (sp - 2) : 0];
+    double   b = stack[(sp > 0) ? (sp - 1) : 0];
+
+    switch(c.op) {
+      case ExprOp::Const: stack[sp++] = c.value;                   continue;
+      case ExprOp::Chan:  stack[sp++] = (double)normal[c.chan];    continue;
+      case ExprOp::Neg:   stack[sp-1] = -b;                        continue;
+      case ExprOp::Not:   stack[sp-1] = (b == 0.0) ? 1.0 : 0.0;    continue;
+      case ExprOp::Abs:   stack[sp-1] = (b < 0.0) ? -b : b;        continue;
+      case ExprOp::Add:   a = a + b;                               break;
+      case ExprOp::Sub:   a = a - b;                               break;
+      case ExprOp::Mul:   a = a * b;                               break;
+      case ExprOp::Div:   a = (b == 0.0) ? 0.0 : (a / b);          break;
+      case ExprOp::Lt:    a = (a <  b) ? 1.0 : 0.0;                break;
+      case ExprOp::Le:    a = (a <= b) ? 1.0 : 0.0;                break;
+      case ExprOp::Gt:    a = (a >  b) ? 1.0 : 0.0;                break;
+      case ExprOp::Ge:    a = (a >= b) ? 1.0 : 0.0;                break;
+      case ExprOp::Eq:    a = (a == b) ? 1.0 : 0.0;                break;
+      case ExprOp::Ne:    a = (a != b) ? 1.0 : 0.0;                break;
+      case ExprOp::And:   a = ((a != 0.0) && (b != 0.0)) ? 1.0 : 0.0; break;
+      case ExprOp::Or:    a = ((a != 0.0) || (b != 0.0)) ? 1.0 : 0.0; break;
+      case ExprOp::Min:   a = (a < b) ? a : b;                     break;
+      case ExprOp::Max:   a = (a > b) ? a : b;                     break;
+    }
+
+    sp--;
+  }
+
+  return (sp > 0) ? stack[0] : 0.0;
+}
+
+/* standard constructor */
+
+ChannelExpression::ChannelExpression(void) : Object("ChannelExpression"),
+  length(0), channels(0), at(0), depth(0), deepest(0) {
+
+  /* nothing compiled yet, its 0 */
+
+  code[0].op    = ExprOp::Const;
+  code[0].chan  = 0;
+  code[0].value = 0.0;
+
+  length = 1;
+}
+
+/**
+ *
+ * compile() - parse and compile an expression.
+ *
+ * @param expression string - the expression.
+ *
+ * @return bool - exactly false on error (see getError()).
+ *
+ */
+
+bool ChannelExpression::compile(const string & expression) {
+
+  text     = trim(strtolower(expression));
+  at       = 0;
+  length   = 0;
+  channels = 0;
+  depth    = 0;
+  deepest  = 0;
+
+  if(text.empty()) {
+    setError("compile() - empty expression.");
+    return false;
+  }
+
+  if(!orExpr()) {
+    length = 0;
+    return false;
+  }
+
+  skipSpace();
+
+  if(at < text.size()) {
+    setError(string("compile() - unexpected '") + text.substr(at) + string("' in: ") + text);
+    length = 0;
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * eval() - run the program.
+ *
+ * @param normal unsigned int array - the channel values, chan_N is
+ * normal[N].
+ *
+ * @return unsigned int - the (rounded) result.
+ *
+ */
+
+unsigned int ChannelExpression::eval(const unsigned int *normal) const {
+
+  double v = exec(code, length, normal);
+
+  /* (NaN too) */
+
+  if(!(v > 0.0)) {
+    return 0;
+  }
+
+  if(v >= 4294967295.0) {
+    return 4294967295u;
+  }
+
+  return (unsigned int)(v + 0.5);
+}
+
+/**
+ *
+ * emit() - (compile() helper) add an instruction, and fold it into a
+ * constant right away if all of its operands are constants.
+ *
+ */
+
+bool ChannelExpression::emit(ExprOp op, int chan, double value) {
+
+  int operands = 2;
+
+  switch(op) {
+    case ExprOp::Const:
+    case ExprOp::Chan:
+      operands = 0;
+      break;
+    case ExprOp::Neg:
+    case ExprOp::Not:
+    case ExprOp::Abs:
+      operands = 1;
+      break;
+    default:
+      break;
+  }
+
+  if(length >= ExprMaxCode) {
+    setError(string("compile() - expression is too long (") + to_string((int)ExprMaxCode) + string(" steps): ") + text);
+    return false;
+  }
+
+  code[length].op    = op;
+  code[length].chan  = chan;
+  code[length].value = value;
+
+  length++;
+
+  depth += 1 - operands;
+
+  if(depth > deepest) {
+    deepest = depth;
+  }
+
+  if(deepest > ExprMaxStack) {
+    setError(string("compile() - expression is too deep: ") + text);
+    return false;
+  }
+
+  /* fold: are the operands (just before us) all constants? */
+
+  if((operands == 0) || (length < operands + 1)) {
+    return true;
+  }
+
+  for(int k=length-1-operands; k<length-1; k++) {
+    if(code[k].op != ExprOp::Const) {
+      return true;
+    }
+  }
+
+  double folded = exec(code + length - 1 - operands, operands + 1, NULL);
+
+  length -= operands;
+
+  code[length-1].op    = ExprOp::Const;
+  code[length-1].chan  = 0;
+  code[length-1].value = folded;
+
+  return true;
+}
+
+/* (compile() helpers) */
+
+void ChannelExpression::skipSpace(void) {
+
+  while((at < text.size()) && isspace((unsigned char)text[at])) {
+    at++;
+  }
+}
+
+bool ChannelExpression::accept(const string & what) {
+
+  skipSpace();
+
+  if(text.compare(at, what.size(), what) != 0) {
+    return false;
+  }
+
+  /* don't take '<' out of '<=', or '!' out of '!=' */
+
+  if((what.size() == 1) && (at + 1 < text.size()) && (text[at+1] == '=') &&
+     ((what == "<") || (what == ">") || (what == "!"))) {
+    return false;
+  }
+
+  at += what.size();
+
+  return true;
+}
+
+/* a || b */
+
+bool ChannelExpression::orExpr(void) {
+
+  if(!andExpr()) {
+    return false;
+  }
+
+  while(accept("||")) {
+    if(!andExpr() || !emit(ExprOp::Or)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* a && b */
+
+bool ChannelExpression::andExpr(void) {
+
+  if(!equality()) {
+    return false;
+  }
+
+  while(accept("&&")) {
+    if(!equality() || !emit(ExprOp::And)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* a == b, a != b */
+
+bool ChannelExpression::equality(void) {
+
+  if(!relation()) {
+    return false;
+  }
+
+  while(true) {
+
+    ExprOp op;
+
+    if(accept("==")) {
+      op = ExprOp::Eq;
+    } else if(accept("!=")) {
+      op = ExprOp::Ne;
+    } else {
+      return true;
+    }
+
+    if(!relation() || !emit(op)) {
+      return false;
+    }
+  }
+}
+
+/* a < b, a <= b, a > b, a >= b */
+
+bool ChannelExpression::relation(void) {
+
+  if(!sum()) {
+    return false;
+  }
+
+  while(true) {
+
+    ExprOp op;
+
+    if(accept("<=")) {
+      op = ExprOp::Le;
+    } else if(accept(">=")) {
+      op = ExprOp::Ge;
+    } else if(accept("<")) {
+      op = ExprOp::Lt;
+    } else if(accept(">")) {
+      op = ExprOp::Gt;
+    } else {
+      return true;
+    }
+
+    if(!sum() || !emit(op)) {
+      return false;
+    }
+  }
+}
+
+/* a + b, a - b */
+
+bool ChannelExpression::sum(void) {
+
+  if(!term()) {
+    return false;
+  }
+
+  while(true) {
+
+    ExprOp op;
+
+    if(accept("+")) {
+      op = ExprOp::Add;
+    } else if(accept("-")) {
+      op = ExprOp::Sub;
+    } else {
+      return true;
+    }
+
+    if(!term() || !emit(op)) {
+      return false;
+    }
+  }
+}
+
+/* a * b, a / b */
+
+bool ChannelExpression::term(void) {
+
+  if(!unary()) {
+    return false;
+  }
+
+  while(true) {
+
+    ExprOp op;
+
+    if(accept("*")) {
+      op = ExprOp::Mul;
+    } else if(accept("/")) {
+      op = ExprOp::Div;
+    } else {
+      return true;
+    }
+
+    if(!unary() || !emit(op)) {
+      return false;
+    }
+  }
+}
+
+/* -a, !a */
+
+bool ChannelExpression::unary(void) {
+
+  if(accept("-")) {
+    return unary() && emit(ExprOp::Neg);
+  }
+
+  if(accept("!")) {
+    return unary() && emit(ExprOp::Not);
+  }
+
+  return primary();
+}
+
+/* numbers, chan_N, functions and ( ) */
+
+bool ChannelExpression::primary(void) {
+
+  skipSpace();
+
+  if(at >= text.size()) {
+    setError(string("compile() - expression ends too soon: ") + text);
+    return false;
+  }
+
+  if(accept("(")) {
+
+    if(!orExpr()) {
+      return false;
+    }
+
+    if(!accept(")")) {
+      setError(string("compile() - missing ')' in: ") + text);
+      return false;
+    }
+
+    return true;
+  }
+
+  char ch = text[at];
+
+  if(isdigit((unsigned char)ch) || (ch == '.')) {
+
+    const char *start = text.c_str() + at;
+    char       *end   = NULL;
+    double      value = strtod(start, &end);
+
+    at += (size_t)(end - start);
+
+    return emit(ExprOp::Const, 0, value);
+  }
+
+  /* a name */
+
+  size_t from = at;
+
+  while((at < text.size()) && (isalnum((unsigned char)text[at]) || (text[at] == '_'))) {
+    at++;
+  }
+
+  string name = text.substr(from, at - from);
+
+  if(name.empty()) {
+    setError(string("compile() - unexpected '") + text.substr(at) + string("' in: ") + text);
+    return false;
+  }
+
+  if(name.compare(0, 5, "chan_") == 0) {
+
+    string number = name.substr(5);
+    int    chan   = is_numeric(number) ? atoi(number.c_str()) : 0;
+
+    if((chan < 1) || (chan > ExprMaxChannel)) {
+      setError(string("compile() - no such channel: ") + name);
+      return false;
+    }
+
+    channels |= (1u << chan);
+
+    return emit(ExprOp::Chan, chan);
+  }
+
+  ExprOp op;
+  int    args = 2;
+
+  if(name == "min") {
+    op = ExprOp::Min;
+  } else if(name == "max") {
+    op = ExprOp::Max;
+  } else if(name == "abs") {
+    op   = ExprOp::Abs;
+    args = 1;
+  } else {
+    setError(string("compile() - unknown name: ") + name);
+    return false;
+  }
+
+  if(!accept("(")) {
+    setError(string("compile() - ") + name + string(" needs ( )"));
+    return false;
+  }
+
+  for(int k=0; k<args; k++) {
+
+    if((k > 0) && !accept(",")) {
+      setError(string("compile() - ") + name + string(" needs ") + to_string(args) + string(" values."));
+      return false;
+    }
+
+    if(!orExpr()) {
+      return false;
+    }
+  }
+
+  if(!accept(")")) {
+    setError(string("compile() - missing ')' after ") + name);
+    return false;
+  }
+
+  /* all done */
+
+  return emit(op);
+}
@@ -1,9 +1,393 @@
 #include "ChannelManager.hh"
 
+#include <cmath>
+#include <cstring>
+
+/**
+ *
+ * asCurve() - (compile() helper) the same thing as a Curve form, for
+ * anything that is just arithmetic.
+ *
+ */
+
+static TransformForm asCurve(const TransformForm & form) {
+
+  TransformForm curve(Form::Curve);
+
+  switch(form.kind) {
+
+    case Form::Constant:
+      curve.coef[0] = form.value;
+      curve.coef[1] = 0.0;
+      break;
+
+    case Form::Identity:
+      break;
+
+    case Form::Linear:
+      curve.coef[0] = form.offset;
+      curve.coef[1] = form.scale;
+      break;
+
+    case Form::Clamp:
+      curve.high = form.value;
+      break;
+
+    case Form::Curve:
+      return form;
+
+    default:
+      return TransformForm();
+  }
+
+  return curve;
+}
+
+/* (fuse() helpers) which parts of a Curve are in use */
+
+static bool hasDeadband(const TransformForm & f) {
+  return (f.center != 0) || (f.band != 0);
+}
+
+static bool hasClamp(const TransformForm & f) {
+  return (f.low != 0.0) || (f.high != 4294967295.0);
+}
+
+static bool isLine(const TransformForm & f) {
+  return (f.knots == 0) && (f.coef[2] == 0.0) && (f.coef[3] == 0.0);
+}
+
+static bool isCopy(const TransformForm & f) {
+  return isLine(f) && (f.coef[0] == 0.0) && (f.coef[1] == 1.0);
+}
+
+/**
+ *
+ * fuse() - (compile() helper) the form of doing first, then second.
+ * Opaque if it can't be folded into one step without changing the
+ * answer (there is an (unsigned int) in between).
+ *
+ */
+
+static TransformForm fuse(const TransformForm & first, const TransformForm & second) {
+
+  /*
+   * a streaming filter has to see every sample, whatever else is in
+   * the chain; even a constant one, it can't be folded from one y().
+   *
+   */
+
+  if((first.kind == Form::Stream) || (second.kind == Form::Stream)) {
+    return TransformForm(Form::Stream);
+  }
+
+  /* a constant at either end is a constant (the caller works out which) */
+
+  if((first.kind == Form::Constant) || (second.kind == Form::Constant)) {
+    return TransformForm(Form::Constant);
+  }
+
+  if(first.kind == Form::Identity) {
+    return second;
+  }
+
+  if(second.kind == Form::Identity) {
+    return first;
+  }
+
+  TransformForm a = asCurve(first);
+  TransformForm b = asCurve(second);
+
+  if((a.kind != Form::Curve) || (b.kind != Form::Curve)) {
+    return TransformForm();
+  }
+
+  /* then a clamp; clamping whole numbers doesn't care about truncating */
+
+  if(isCopy(b) && !hasDeadband(b)) {
+
+    TransformForm both = a;
+
+    both.low  = (a.low  > b.low)  ? a.low  : b.low;
+    both.high = (a.high < b.high) ? a.high : b.high;
+
+    if(both.low <= both.high) {
+      return both;
+    }
+  }
+
+  /* a deadband (and/or clamp) first, its output is a whole number */
+
+  if(isCopy(a) && !hasDeadband(b)) {
+
+    if(!hasClamp(a)) {
+
+      TransformForm both = b;
+
+      both.center = a.center;
+      both.band   = a.band;
+
+      return both;
+    }
+  }
+
+  /*
+   * two straight lines, if the first always lands on a whole,
+   * positive number, so there is nothing for the (unsigned int) in
+   * between to cut off.
+   *
+   */
+
+  if(isLine(a) && isLine(b) && !hasDeadband(a) && !hasClamp(a) && !hasDeadband(b)) {
+
+    bool whole = (a.coef[1] >= 0.0) && (a.coef[0] >= 0.0) &&
+                 (a.coef[1] == floor(a.coef[1])) && (a.coef[0] == floor(a.coef[0]));
+
+    if(whole) {
+
+      TransformForm both = b;
+
+      both.coef[0] = a.coef[0] * b.coef[1] + b.coef[0];
+      both.coef[1] = a.coef[1] * b.coef[1];
+
+      return both;
+    }
+  }
+
+  /* all done */
+
+  return TransformForm();
+}
+
+/**
+ *
+ * setKernel() - (compile() helper) make the form channel i's kernel
+ * in the given stage.  Curves that are really just a copy or a
+ * constant are done as that.
+ *
+ */
+
+static void setKernel(CMStage & stage, int i, const TransformForm & form) {
+
+  TransformForm curve = asCurve(form);
+
+  stage.kind[i]  = CMKernel::Arith;
+  stage.value[i] = 0;
+  stage.table[i] = NULL;
+
+  if(curve.kind == Form::Curve) {
+
+    if(isCopy(curve) && !hasDeadband(curve) && !hasClamp(curve)) {
+      stage.kind[i] = CMKernel::Copy;
+    }
+
+    if(isLine(curve) && (curve.coef[1] == 0.0)) {
+      stage.kind[i]  = CMKernel::Const;
+      stage.value[i] = curveY(curve, 0);
+    }
+  }
+
+  if(form.kind == Form::Lookup) {
+    stage.kind[i]  = CMKernel::Lookup;
+    stage.table[i] = form.table;
+  }
+
+  if(curve.kind != Form::Curve) {
+    if(form.kind == Form::Stream) {
+      stage.kind[i] = CMKernel::Stream;
+    } else if(form.kind != Form::Lookup) {
+      stage.kind[i] = CMKernel::Call;
+    }
+    curve = TransformForm(Form::Curve);
+  }
+
+  stage.center[i] = curve.center;
+  stage.band[i]   = curve.band;
+  stage.low[i]    = curve.low;
+  stage.high[i]   = curve.high;
+
+  for(int k=0; k<4; k++) {
+    stage.coef[k][i] = curve.coef[k];
+  }
+
+  for(int k=0; k<CurveMaxKnots; k++) {
+    stage.knot[k][i]  = (k < curve.knots) ? curve.knot[k]  : 0.0;
+    stage.slope[k][i] = (k < curve.knots) ? curve.slope[k] : 0.0;
+  }
+}
+
+/**
+ *
+ * finishStage() - (compile() helper) once all the channels are set,
+ * list which of them need the arithmetic pass, and how much of it.
+ *
+ */
+
+static void finishStage(CMStage & stage) {
+
+  stage.knots     = 0;
+  stage.terms     = 2;
+  stage.deadbands = false;
+  stage.ncurves   = 0;
+  stage.count     = 0;
+
+  for(int i=1; i<=CMMaxChannels; i++) {
+
+    if(stage.kind[i] == CMKernel::Copy) {
+      continue;
+    }
+
+    if(stage.kind[i] != CMKernel::Arith) {
+      stage.others[stage.count++] = i;
+      continue;
+    }
+
+    stage.curves[stage.ncurves++] = i;
+
+    for(int k=0; k<CurveMaxKnots; k++) {
+      if((stage.slope[k][i] != 0.0) && (k+1 > stage.knots)) {
+        stage.knots = k+1;
+      }
+    }
+
+    for(int k=2; k<4; k++) {
+      if((stage.coef[k][i] != 0.0) && (k+1 > stage.terms)) {
+        stage.terms = k+1;
+      }
+    }
+
+    if(stage.band[i] != 0) {
+      stage.deadbands = true;
+    }
+  }
+}
+
+/**
+ *
+ * arith() - (load() helper) the arithmetic pass, every curve of the
+ * stage at once; exactly what curveY() does, a channel per column.
+ * Parts no channel uses are left out (adding 0 changes nothing).
+ *
+ */
+
+static void arith(const CMStage & stage, const unsigned int *x, unsigned int *y) {
+
+  double p[CMMaxChannels+1];
+  double xx[CMMaxChannels+1];
+
+  if(stage.deadbands) {
+
+    for(int n=0; n<stage.ncurves; n++) {
+
+      int i = stage.curves[n];
+
+      unsigned int center = stage.center[i];
+      unsigned int off    = (x[i] > center) ? (x[i] - center) : (center - x[i]);
+
+      xx[i] = (double)((off <= stage.band[i]) ? center : x[i]);
+    }
+
+  } else {
+
+    for(int n=0; n<stage.ncurves; n++) {
+
+      int i = stage.curves[n];
+
+      xx[i] = (double)x[i];
+    }
+  }
+
+  if(stage.terms > 2) {
+
+    for(int n=0; n<stage.ncurves; n++) {
+
+      int i = stage.curves[n];
+
+      p[i] = stage.coef[0][i] + xx[i] * (stage.coef[1][i] + xx[i] * (stage.coef[2][i] + xx[i] * stage.coef[3][i]));
+    }
+
+  } else {
+
+    for(int n=0; n<stage.ncurves; n++) {
+
+      int i = stage.curves[n];
+
+      p[i] = stage.coef[0][i] + xx[i] * stage.coef[1][i];
+    }
+  }
+
+  for(int k=0; k<stage.knots; k++) {
+
+    for(int n=0; n<stage.ncurves; n++) {
+
+      int i = stage.curves[n];
+
+      double over = xx[i] - stage.knot[k][i];
+
+      p[i] += stage.slope[k][i] * ((over > 0.0) ? over : 0.0);
+    }
+  }
+
+  for(int n=0; n<stage.ncurves; n++) {
+
+    int i = stage.curves[n];
+
+    double v = p[i];
+
+    v = (v < stage.low[i])  ? stage.low[i]  : v;
+    v = (v > stage.high[i]) ? stage.high[i] : v;
+
+    y[i] = (unsigned int)v;
+  }
+}
+
 /* standard constructor */
 
 ChannelManager::ChannelManager(void) : Object("ChannelManager") {
 
+  init();
+
+  if(!configure()) {
+
+    /* there was a problem! */
+
+  } else {
+    info("ready.");
+  }
+}
+
+/**
+ *
+ * ChannelManager() - configure from the given settings instead of
+ * the program's configuration (ConfigManager).  Used for reloading,
+ * where we build a new ChannelManager from a fresh read of the .ini
+ * file while the current one keeps running.
+ *
+ * @param ini IniFile - the settings to use.
+ *
+ */
+
+ChannelManager::ChannelManager(IniFile & ini) : Object("ChannelManager") {
+
+  init();
+
+  if(!configure(ini)) {
+
+    /* there was a problem! */
+
+  } else {
+    info("ready.");
+  }
+}
+
+/**
+ *
+ * init() - (constructor helper) empty transforms and patch tables.
+ *
+ */
+
+void ChannelManager::init(void) {
+
   unReady();
 
   info("starting up...");
@@ -20,18 +404,33 @@ ChannelManager::ChannelManager(void) : Object("ChannelManager") {
 
   {
     for(int i=0; i<(CMMaxChannels+1); i++) {
-      patchTable[i]        = 0;
-      patchTableOrig[i]    = 0;
-      patchTableDefault[i] = i;
+      patchTable[i]         = 0;
+      patchTableInverted[i] = i;
+      patchTableOrig[i]     = 0;
+      patchTableDefault[i]  = i;
     }
   }
 
-  if(!configure()) {
+  /* nothing configured yet, everything is 0 */
 
-    /* there was a problem! */
+  {
+    steadyFresh = 0;
 
-  } else {
-    info("ready.");
+    for(int i=0; i<(CMMaxChannels+1); i++) {
+      normalHeld[i] = 0;
+      outputHeld[i] = 0;
+      derived[i]    = NULL;
+
+      derivedStream[i] = false;
+
+      setKernel(normalStage, i, TransformForm(Form::Constant, 0));
+      setKernel(outputStage, i, TransformForm(Form::Constant, 0));
+    }
+
+    finishStage(normalStage);
+    finishStage(outputStage);
+
+    derivedCount = 0;
   }
 }
 
@@ -60,7 +459,7 @@ bool ChannelManager::channelMap(string & mapping, bool terse) {
 
     int src        = patchTableInverted[dst];
 
-    string inputt  = inputTrans[src]->getName();
+    string inputt  = (derived[src] != NULL) ? string("Derived") : inputTrans[src]->getName();
     string inputf  = inputFilter[src]->getName();
 
     if(inputf == "Manual") {
@@ -126,6 +525,8 @@ bool ChannelManager::setOutputFilter(int chan, DataTransformer *filter) {
 
   outputFilter[chan] = filter;
 
+  compile();
+
   /* all done */
 
   return true;
@@ -172,6 +573,8 @@ bool ChannelManager::setInputFilter(int chan, DataTransformer *filter) {
 
   inputFilter[chan] = filter;
 
+  compile();
+
   /* all done */
 
   return true;
@@ -194,6 +597,324 @@ bool ChannelManager::invertPatchTable(void) {
     patchTableInverted[dst] = src;
 
   }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * makeTable() - (configure() helper) a LookupTransform from the
+ * [table <name>] section:
+ *
+ *   step   - input counts between the points
+ *   values - the outputs at 0, step, 2*step, ...
+ *
+ * @param ini IniFile - the settings to use.
+ *
+ * @param tableName string - the table's name.
+ *
+ * @return DataTransformer - exactly NULL on error.
+ *
+ */
+
+DataTransformer *ChannelManager::makeTable(IniFile & ini, const string & tableName) {
+
+  string section = string("table ") + tableName;
+
+  string step = trim(ini.getValue(section, "step"));
+
+  if(!is_numeric(step) || (strtol(step.c_str(), NULL, 10) < 1)) {
+    error(string("makeTable() - [") + section + string("] needs a step of 1 or more: ") + step);
+    return NULL;
+  }
+
+  vector<string>       args;
+  vector<unsigned int> points;
+
+  explode(ini.getValue(section, "values"), " ,\t", args);
+
+  for(auto & arg : args) {
+
+    string value = trim(arg);
+
+    if(value.empty()) {
+      continue;
+    }
+
+    if(!is_numeric(value)) {
+      error(string("makeTable() - [") + section + string("] non-numeric value: ") + value);
+      return NULL;
+    }
+
+    points.push_back((unsigned int)strtol(value.c_str(), NULL, 10));
+  }
+
+  LookupTransform *table = new LookupTransform();
+
+  if(!table->build((unsigned int)strtol(step.c_str(), NULL, 10), points)) {
+    error(string("makeTable() - [") + section + string("] needs at least 2 values."));
+    delete table;
+    return NULL;
+  }
+
+  /* all done */
+
+  return table;
+}
+
+/**
+ *
+ * makeCurve() - (configure() helper) a CurveTransform from a filter
+ * setting, one of:
+ *
+ *   piecewise, x:y, x:y, ...
+ *   poly, c0, c1 [, c2 [, c3]]
+ *   clamp, low, high
+ *   deadband, center, band
+ *
+ * @param args vector of string - the setting, split up.
+ *
+ * @return DataTransformer - exactly NULL on error.
+ *
+ */
+
+DataTransformer *ChannelManager::makeCurve(const vector<string> & args) {
+
+  string kind = trim(strtolower(args[0]));
+
+  vector<string> values;
+
+  for(size_t k=1; k<args.size(); k++) {
+    if(!trim(args[k]).empty()) {
+      values.push_back(trim(args[k]));
+    }
+  }
+
+  CurveTransform *curve = new CurveTransform();
+  bool            ok    = false;
+
+  if(kind == "piecewise") {
+
+    vector<unsigned int> xs;
+    vector<unsigned int> ys;
+
+    for(auto & value : values) {
+
+      size_t colon = value.find(':');
+
+      if((colon == string::npos) || !is_numeric(value.substr(0, colon)) || !is_numeric(value.substr(colon+1))) {
+        error(string("makeCurve() - piecewise points must be x:y, not: ") + value);
+        delete curve;
+        return NULL;
+      }
+
+      xs.push_back((unsigned int)strtoul(value.substr(0, colon).c_str(), NULL, 10));
+      ys.push_back((unsigned int)strtoul(value.substr(colon+1).c_str(), NULL, 10));
+    }
+
+    ok = curve->piecewise(xs, ys);
+
+    if(!ok) {
+      error(string("makeCurve() - piecewise needs 2..") + to_string(CurveMaxKnots) + string(" points, in increasing x."));
+    }
+
+  } else {
+
+    for(auto & value : values) {
+      if(!is_numeric(value)) {
+        error(string("makeCurve() - non-numeric ") + kind + string(" value: ") + value);
+        delete curve;
+        return NULL;
+      }
+    }
+
+    if(kind == "poly") {
+
+      vector<double> coefs;
+
+      for(auto & value : values) {
+        coefs.push_back(strtod(value.c_str(), NULL));
+      }
+
+      ok = curve->poly(coefs);
+
+      if(!ok) {
+        error("makeCurve() - poly needs 1 to 4 coefficients.");
+      }
+
+    } else if((kind == "clamp") && (values.size() == 2)) {
+
+      ok = curve->clamp((unsigned int)strtoul(values[0].c_str(), NULL, 10),
+                        (unsigned int)strtoul(values[1].c_str(), NULL, 10));
+
+      if(!ok) {
+        error("makeCurve() - clamp's low is more than its high.");
+      }
+
+    } else if((kind == "deadband") && (values.size() == 2)) {
+
+      ok = curve->deadband((unsigned int)strtoul(values[0].c_str(), NULL, 10),
+                           (unsigned int)strtoul(values[1].c_str(), NULL, 10));
+
+    } else {
+
+      error(string("makeCurve() - ") + kind + string(" needs 2 values."));
+    }
+  }
+
+  if(!ok) {
+    delete curve;
+    return NULL;
+  }
+
+  /* all done */
+
+  return curve;
+}
+
+/**
+ *
+ * makeStream() - (configure() helper) a StreamTransform from a filter
+ * setting, one of:
+ *
+ *   ema, alpha
+ *   average, n
+ *   median, n
+ *   rate, step
+ *   debounce, n
+ *
+ * @param args vector of string - the setting, split up.
+ *
+ * @return DataTransformer - exactly NULL on error.
+ *
+ */
+
+DataTransformer *ChannelManager::makeStream(const vector<string> & args) {
+
+  string kind = trim(strtolower(args[0]));
+
+  if((args.size() < 2) || !is_numeric(trim(args[1]))) {
+    error(string("makeStream() - ") + kind + string(" needs a number."));
+    return NULL;
+  }
+
+  string value = trim(args[1]);
+  long   n     = strtol(value.c_str(), NULL, 10);
+
+  StreamTransform *stream = new StreamTransform();
+  bool             ok     = false;
+
+  if(kind == "ema") {
+
+    ok = stream->ema(strtod(value.c_str(), NULL));
+
+    if(!ok) {
+      error(string("makeStream() - ema's alpha must be more than 0, and at most 1: ") + value);
+    }
+
+  } else if(kind == "rate") {
+
+    ok = (n >= 1) && stream->rate((unsigned int)n);
+
+    if(!ok) {
+      error(string("makeStream() - rate's step must be at least 1: ") + value);
+    }
+
+  } else {
+
+    bool fits = (n >= 1) && (n <= StreamMaxWindow);
+
+    if(kind == "average") {
+      ok = fits && stream->average((int)n);
+    } else if(kind == "median") {
+      ok = fits && stream->median((int)n);
+    } else if(kind == "debounce") {
+      ok = fits && stream->debounce((int)n);
+    }
+
+    if(!ok) {
+      error(string("makeStream() - ") + kind + string(" needs 1..") + to_string((int)StreamMaxWindow) + string(" samples: ") + value);
+    }
+  }
+
+  if(!ok) {
+    delete stream;
+    return NULL;
+  }
+
+  /* all done */
+
+  return stream;
+}
+
+/**
+ *
+ * configureDerived() - (configure() helper) compile the [derived]
+ * expressions.  A derived channel can use any channel that isn't
+ * derived, and derived channels lower than itself (they're worked
+ * out in order).
+ *
+ * @param ini IniFile - the settings to use.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool ChannelManager::configureDerived(IniFile & ini) {
+
+  derivedCount = 0;
+
+  for(int i=1; i<=CMMaxChannels; i++) {
+
+    string chanName   = string("chan_") + to_string(i);
+    string expression = trim(ini.getValue("derived", chanName));
+
+    if(expression.empty()) {
+      continue;
+    }
+
+    ChannelExpression *expr = new ChannelExpression();
+
+    if(!expr->compile(expression)) {
+      error(string("configureDerived() - bad expression for ") + chanName + string(": ") + expr->getError());
+      delete expr;
+      return false;
+    }
+
+    derived[i] = expr;
+
+    derivedList[derivedCount++] = i;
+
+    if(inputFilter[i]->yForm().kind == Form::Constant) {
+      warning(string("configureDerived() - ") + chanName + string(" is derived, but its input filter throws it away (")
+        + inputFilter[i]->getName() + string(")."));
+    }
+
+    info(string("configureDerived() - ") + chanName + string(" = ") + expr->getText() + string(" (")
+      + to_string(expr->size()) + string(" steps)"));
+  }
+
+  /* no using a derived channel that isn't worked out yet */
+
+  for(int n=0; n<derivedCount; n++) {
+
+    int i = derivedList[n];
+
+    for(int j=i; j<=CMMaxChannels; j++) {
+
+      if((derived[j] != NULL) && (derived[i]->uses() & (1u << j))) {
+        error(string("configureDerived() - chan_") + to_string(i) + string(" can not use derived chan_")
+          + to_string(j) + string(", only lower derived channels."));
+        return false;
+      }
+    }
+  }
+
+  /* all done */
+
+  return true;
 }
 
 /**
@@ -210,16 +931,29 @@ bool ChannelManager::invertPatchTable(void) {
 
 bool ChannelManager::configure(void) {
 
+  /* fetch configuration */
+
+  return configure(ConfigManager::instance());
+}
+
+/**
+ *
+ * configure() - same, but from the given settings.
+ *
+ * @param ini IniFile - the settings to use.
+ *
+ * @return bool - exactly false if something goes wrong.
+ *
+ */
+
+bool ChannelManager::configure(IniFile & ini) {
+
   /* if we are already setup, do a forced reset... */
 
   if(isReady()) {
     clear();
   }
 
-  /* fetch configuration */
-
-  IniFile ini = ConfigManager::instance();
-
   if(!ini.isReady()) {
 
     /* we can't read/find the configuration file? */
@@ -246,6 +980,18 @@ bool ChannelManager::configure(void) {
   inputTrans[14] = new NullTransform();
   inputTrans[15] = new NullTransform();
 
+  /* channels that come off CAN are already raw counts (see CANInput) */
+
+  for(int i=1; i<=CMMaxChannels; i++) {
+
+    if(trim(ini.getValue("can input", string("chan_") + to_string(i))).empty()) {
+      continue;
+    }
+
+    delete inputTrans[i];
+    inputTrans[i] = new PassthroughTransform();
+  }
+
   /* load the output transforms */
 
   outputTrans[1]  = new AIMRPMTransform();
@@ -311,11 +1057,53 @@ bool ChannelManager::configure(void) {
           clear();
           return false;
         }
-
-        unsigned int paramA = (unsigned int)strtol(args[1].c_str(), NULL, 10);
-
-        inputFilter[i] = new ManualTransform();
-        inputFilter[i]->setParam(0, paramA);
+
+        unsigned int paramA = (unsigned int)strtol(args[1].c_str(), NULL, 10);
+
+        inputFilter[i] = new ManualTransform();
+        inputFilter[i]->setParam(0, paramA);
+        continue;
+      }
+
+      if(manual == "table") {
+
+        if(args.size()<2) {
+          error(string("configure() - table filter requires a table name on input channel:") + chanName);
+          clear();
+          return false;
+        }
+
+        inputFilter[i] = makeTable(ini, args[1]);
+
+        if(inputFilter[i] == NULL) {
+          clear();
+          return false;
+        }
+        continue;
+      }
+
+      if((manual == "piecewise") || (manual == "poly") || (manual == "clamp") || (manual == "deadband")) {
+
+        inputFilter[i] = makeCurve(args);
+
+        if(inputFilter[i] == NULL) {
+          error(string("configure() - bad ") + manual + string(" filter on input channel ") + chanName);
+          clear();
+          return false;
+        }
+        continue;
+      }
+
+      if((manual == "ema") || (manual == "average") || (manual == "median") ||
+         (manual == "rate") || (manual == "debounce")) {
+
+        inputFilter[i] = makeStream(args);
+
+        if(inputFilter[i] == NULL) {
+          error(string("configure() - bad ") + manual + string(" filter on input channel ") + chanName);
+          clear();
+          return false;
+        }
         continue;
       }
 
@@ -327,6 +1115,13 @@ bool ChannelManager::configure(void) {
     }
   }
 
+  /* channels worked out from other channels (configurable) */
+
+  if(!configureDerived(ini)) {
+    clear();
+    return false;
+  }
+
   /* figure out the output filter/transforms (configurable) */
 
   {
@@ -382,6 +1177,48 @@ bool ChannelManager::configure(void) {
         continue;
       }
 
+      if(manual == "table") {
+
+        if(args.size()<2) {
+          error(string("configure() - table filter requires a table name on output channel:") + chanName);
+          clear();
+          return false;
+        }
+
+        outputFilter[i] = makeTable(ini, args[1]);
+
+        if(outputFilter[i] == NULL) {
+          clear();
+          return false;
+        }
+        continue;
+      }
+
+      if((manual == "piecewise") || (manual == "poly") || (manual == "clamp") || (manual == "deadband")) {
+
+        outputFilter[i] = makeCurve(args);
+
+        if(outputFilter[i] == NULL) {
+          error(string("configure() - bad ") + manual + string(" filter on output channel ") + chanName);
+          clear();
+          return false;
+        }
+        continue;
+      }
+
+      if((manual == "ema") || (manual == "average") || (manual == "median") ||
+         (manual == "rate") || (manual == "debounce")) {
+
+        outputFilter[i] = makeStream(args);
+
+        if(outputFilter[i] == NULL) {
+          error(string("configure() - bad ") + manual + string(" filter on output channel ") + chanName);
+          clear();
+          return false;
+        }
+        continue;
+      }
+
       /* if we fall through, we don't recognize this filter */
 
       error(string("configure() - bad filter (") + manual + string(") filter on output channel ") + chanName);
@@ -477,6 +1314,8 @@ bool ChannelManager::configure(void) {
 
   invertPatchTable();
 
+  compile();
+
   /*
    * at this point we can transform input on the left from the DL-32 to
    * output on the right that goes to the SoloDL.
@@ -492,7 +1331,7 @@ bool ChannelManager::configure(void) {
 
     for(int chan=1; chan<=CMMaxChannels; chan++) {
 
-      string inputt = inputTrans[chan]->getName();
+      string inputt = (derived[chan] != NULL) ? string("Derived") : inputTrans[chan]->getName();
       string inputf = inputFilter[chan]->getName();
 
       string outputf = outputFilter[patchTable[chan]]->getName();
@@ -574,6 +1413,8 @@ bool ChannelManager::patch(int chan1, int chan2) {
   patchTable[srcB] = dstA;
   patchTable[srcA] = dstB;
 
+  compile();
+
   /* all done */
 
   return true;
@@ -604,6 +1445,8 @@ bool ChannelManager::patchReset(void) {
 
   invertPatchTable();
 
+  compile();
+
   /* all done */
 
   return true;
@@ -633,6 +1476,8 @@ bool ChannelManager::patchDefault(void) {
 
   invertPatchTable();
 
+  compile();
+
   /* all done */
 
   return true;
@@ -671,7 +1516,13 @@ bool ChannelManager::clear(void) {
         delete outputTrans[i];
         outputTrans[i] = NULL;
       }
+      if(derived[i] != NULL) {
+        delete derived[i];
+        derived[i] = NULL;
+      }
     }
+
+    derivedCount = 0;
   }
 
   /* reset the patch table */
@@ -679,11 +1530,17 @@ bool ChannelManager::clear(void) {
   {
     for(int i=0; i<(CMMaxChannels+1); i++) {
 
-      patchTable[i]        = 0;
-      patchTableOrig[i]    = 0;
-      patchTableDefault[i] = i;
+      patchTable[i]         = 0;
+      patchTableInverted[i] = i;
+      patchTableOrig[i]     = 0;
+      patchTableDefault[i]  = i;
 
+      setKernel(normalStage, i, TransformForm(Form::Constant, 0));
+      setKernel(outputStage, i, TransformForm(Form::Constant, 0));
     }
+
+    finishStage(normalStage);
+    finishStage(outputStage);
   }
 
   info("cleared.");
@@ -736,12 +1593,39 @@ bool ChannelManager::transform(int channel, unsigned int input, unsigned int & o
   int dst = channel;
   int src = patchTableInverted[dst];
 
+  /* a derived channel needs the others too; like curve(), they all get 'input' */
+
+  if(derived[src] != NULL) {
+
+    unsigned int in[CMMaxChannels+1];
+    unsigned int norm[CMMaxChannels+1];
+    unsigned int out[CMMaxChannels+1];
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+      in[i] = input;
+    }
+
+    if(!run(in, norm, out, CMAllFresh, true)) {
+      return false;
+    }
+
+    output = out[dst];
+
+    return true;
+  }
+
   /*
    * normalize
    *
    */
 
-  unsigned int normal = inputFilter[src]->y(inputTrans[src]->y(input));
+  unsigned int normal = inputTrans[src]->y(input);
+
+  /* streaming filters settle to their input; don't feed them made up samples */
+
+  if(inputFilter[src]->yForm().kind != Form::Stream) {
+    normal = inputFilter[src]->y(normal);
+  }
 
   /*
    * convert for SoloDL, we have to do the inverse of what
@@ -750,7 +1634,13 @@ bool ChannelManager::transform(int channel, unsigned int input, unsigned int & o
    *
    */
 
-  output = outputTrans[dst]->inverse(outputFilter[dst]->y(normal));
+  unsigned int filtered = normal;
+
+  if(outputFilter[dst]->yForm().kind != Form::Stream) {
+    filtered = outputFilter[dst]->y(normal);
+  }
+
+  output = outputTrans[dst]->inverse(filtered);
 
   if(false) {
 
@@ -794,54 +1684,391 @@ bool ChannelManager::transform(int channel, unsigned int input, unsigned int & o
  * of the normal data,  this is our official data to send to the SoloDL
  * without any further processing.
  *
+ * @param fresh unsigned int - which input channels (bit i for channel
+ * i) have a new sample.
+ *
  * @return bool - exactly false if there is some kidn of error.
  *
  */
 
 bool ChannelManager::load(unsigned int *input,
                           unsigned int *normal,
-                          unsigned int *output) {
+                          unsigned int *output,
+                          unsigned int fresh) {
+
+  return run(input, normal, output, fresh, false);
+}
+
+/**
+ *
+ * run() - load(), and for curve(): 'settled' shows streaming filters
+ * as what they settle to (their input), without touching them.
+ *
+ */
+
+bool ChannelManager::run(unsigned int *input, unsigned int *normal, unsigned int *output,
+                         unsigned int fresh, bool settled) {
+
+  /* normalize */
+
+  memcpy(normal, input, sizeof(unsigned int) * (CMMaxChannels+1));
+
+  arith(normalStage, input, normal);
+
+  for(int n=0; n<normalStage.count; n++) {
+
+    int          i = normalStage.others[n];
+    unsigned int x = input[i];
+
+    if(normalStage.kind[i] == CMKernel::Const) {
+      normal[i] = normalStage.value[i];
+    } else if((normalStage.kind[i] == CMKernel::Lookup) && (x < LookupSize)) {
+      normal[i] = normalStage.table[i][x];
+    } else if(normalStage.kind[i] == CMKernel::Stream) {
+
+      /* (streaming filters are only ever filters, the transforms aren't) */
+
+      if(settled) {
+        normal[i] = inputTrans[i]->y(x);
+      } else if((fresh | steadyFresh) & (1u << i)) {
+        normal[i] = normalHeld[i] = inputFilter[i]->y(inputTrans[i]->y(x));
+      } else {
+        normal[i] = normalHeld[i];
+      }
+
+    } else {
+      normal[i] = inputFilter[i]->y(inputTrans[i]->y(x));
+    }
+  }
 
   normal[0] = 0;
+
+  /*
+   * derived channels, from the normal values, in order; their value
+   * goes through the channel's input filter in place of the DL-32's.
+   * It's a new sample if anything it uses is.
+   *
+   */
+
+  for(int n=0; n<derivedCount; n++) {
+
+    int          i = derivedList[n];
+    unsigned int v = derived[i]->eval(normal);
+
+    if(derived[i]->uses() & fresh) {
+      fresh |= (1u << i);
+    }
+
+    if(!derivedStream[i]) {
+      normal[i] = inputFilter[i]->y(v);
+    } else if(settled) {
+      normal[i] = v;
+    } else if(fresh & (1u << i)) {
+      normal[i] = normalHeld[i] = inputFilter[i]->y(v);
+    } else {
+      normal[i] = normalHeld[i];
+    }
+  }
+
+  /*
+   * convert for Solo DL, we have to do the inverse of what
+   * the AIM  Protocol will do, so that the SoloDL actually
+   * sees the data we want it to.
+   *
+   * NOTE: at the same time we have to pick which input side
+   * of the channel to use, because the outputs have to stay
+   * in the order they are in (per AIM protocol) we use an
+   * inverse map to pick off which left side to use to push
+   * to the right side.  All of normal[] has to be done first,
+   * a patch can pull from a later channel.
+   *
+   */
+
+  unsigned int patched[CMMaxChannels+1];
+
+  for(int i=0; i<=CMMaxChannels; i++) {
+    patched[i] = normal[patchTableInverted[i]];
+  }
+
+  memcpy(output, patched, sizeof(unsigned int) * (CMMaxChannels+1));
+
+  arith(outputStage, patched, output);
+
+  for(int n=0; n<outputStage.count; n++) {
+
+    int          i = outputStage.others[n];
+    unsigned int x = patched[i];
+
+    if(outputStage.kind[i] == CMKernel::Const) {
+      output[i] = outputStage.value[i];
+    } else if((outputStage.kind[i] == CMKernel::Lookup) && (x < LookupSize)) {
+      output[i] = outputStage.table[i][x];
+    } else if(outputStage.kind[i] == CMKernel::Stream) {
+
+      /* new if the input channel patched to it is */
+
+      if(settled) {
+        output[i] = outputTrans[i]->inverse(x);
+      } else if((fresh | steadyFresh) & (1u << patchTableInverted[i])) {
+        output[i] = outputHeld[i] = outputTrans[i]->inverse(outputFilter[i]->y(x));
+      } else {
+        output[i] = outputHeld[i];
+      }
+
+    } else {
+      output[i] = outputTrans[i]->inverse(outputFilter[i]->y(x));
+    }
+  }
+
   output[0] = 0;
 
-  for(int i=1; i<=CMMaxChannels; i++) {
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * loadChained() - same as load(), but by calling each channel's
+ * transformers one at a time, the way they are configured.  Slow;
+ * for checking and timing load() (see test/cmbench.cc).
+ *
+ * @return bool - exactly false if there is some kind of error.
+ *
+ */
+
+bool ChannelManager::loadChained(unsigned int *input,
+                                 unsigned int *normal,
+                                 unsigned int *output) {
+
+  if(!isReady()) {
+    error("loadChained() - object not ready.");
+    return false;
+  }
 
-    /* normalize */
+  normal[0] = 0;
+  output[0] = 0;
 
+  for(int i=1; i<=CMMaxChannels; i++) {
     normal[i] = inputFilter[i]->y(inputTrans[i]->y(input[i]));
+  }
+
+  for(int n=0; n<derivedCount; n++) {
+
+    int i = derivedList[n];
+
+    normal[i] = inputFilter[i]->y(derived[i]->eval(normal));
+  }
 
-    /*
-     * convert for Solo DL, we have to do the inverse of what
-     * the AIM  Protocol will do, so that the SoloDL actually
-     * sees the data we want it to.
-     *
-     * NOTE: at the same time we have to pick which input side
-     * of the channel to use, because the outputs have to stay
-     * in the order they are in (per AIM protocol) we use an
-     * inverse map to pick off which left side to use to push
-     * to the right side.
-     *
-     */
+  for(int i=1; i<=CMMaxChannels; i++) {
 
     int src = patchTableInverted[i];
 
     output[i] = outputTrans[i]->inverse(outputFilter[i]->y(normal[src]));
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * compile() - fold each channel's transformers into one kernel per
+ * stage.  Has to be re-done after anything that changes a
+ * transformer or the patch table.
+ *
+ */
+
+void ChannelManager::compile(void) {
+
+  TransformForm normals[CMMaxChannels+1];
+
+  steadyFresh = 0;
+
+  /* input side */
+
+  for(int i=1; i<=CMMaxChannels; i++) {
+
+    if((inputTrans[i] == NULL) || (inputFilter[i] == NULL)) {
+      return;
+    }
+
+    TransformForm form = fuse(inputTrans[i]->yForm(), inputFilter[i]->yForm());
+
+    if(derived[i] != NULL) {
+
+      /* run() does these itself, after the rest of normal[] */
+
+      setKernel(normalStage, i, TransformForm(Form::Constant, 0));
+
+      derivedStream[i] = (inputFilter[i]->yForm().kind == Form::Stream);
+
+      normals[i] = TransformForm();
+      continue;
+    }
+
+    if(form.kind == Form::Constant) {
+
+      /* doesn't matter what comes in, ask the real chain once */
+
+      form.value = inputFilter[i]->y(inputTrans[i]->y(0));
+
+    } else if(form.kind == Form::Stream) {
+
+      /* a null channel into a streaming filter, still a sample a frame */
+
+      if(inputTrans[i]->yForm().kind == Form::Constant) {
+        steadyFresh |= (1u << i);
+      }
+
+    } else if(form.kind == Form::Opaque) {
+
+      vector<unsigned int> & table = normalTables[i];
+
+      table.resize(LookupSize);
+
+      for(unsigned int x=0; x<LookupSize; x++) {
+        table[x] = inputFilter[i]->y(inputTrans[i]->y(x));
+      }
+
+      form       = TransformForm(Form::Lookup);
+      form.table = table.data();
+    }
+
+    setKernel(normalStage, i, form);
+
+    normals[i] = form;
+  }
+
+  /* output side, through the patch */
+
+  for(int i=1; i<=CMMaxChannels; i++) {
 
-    if(false) {
+    if((outputFilter[i] == NULL) || (outputTrans[i] == NULL)) {
+      return;
+    }
+
+    int src = patchTableInverted[i];
+
+    TransformForm form = fuse(outputFilter[i]->yForm(), outputTrans[i]->inverseForm());
+
+    if(form.kind == Form::Constant) {
+
+      form.value = outputTrans[i]->inverse(outputFilter[i]->y(0));
+
+    } else if(form.kind == Form::Stream) {
+
+      /* a constant coming in, the streaming filter still sees it every frame */
+
+      if(normals[src].kind == Form::Constant) {
+        steadyFresh |= (1u << src);
+      }
+
+    } else if(normals[src].kind == Form::Constant) {
+
+      /* a constant coming in (a null or manual channel) */
+
+      form = TransformForm(Form::Constant,
+        outputTrans[i]->inverse(outputFilter[i]->y(normals[src].value)));
+
+    } else if(form.kind == Form::Opaque) {
+
+      vector<unsigned int> & table = outputTables[i];
+
+      table.resize(LookupSize);
+
+      for(unsigned int x=0; x<LookupSize; x++) {
+        table[x] = outputTrans[i]->inverse(outputFilter[i]->y(x));
+      }
+
+      form       = TransformForm(Form::Lookup);
+      form.table = table.data();
+    }
+
+    setKernel(outputStage, i, form);
+  }
+
+  finishStage(normalStage);
+  finishStage(outputStage);
+}
+
+/**
+ *
+ * compiled() - how many of the 30 channel stages compiled to
+ * something other than a Call (or Stream).
+ *
+ */
+
+int ChannelManager::compiled(void) {
+
+  int n = 0;
+
+  for(int i=1; i<=CMMaxChannels; i++) {
+
+    if((normalStage.kind[i] != CMKernel::Call) && (normalStage.kind[i] != CMKernel::Stream)) {
+      n++;
+    }
+    if((outputStage.kind[i] != CMKernel::Call) && (outputStage.kind[i] != CMKernel::Stream)) {
+      n++;
+    }
+  }
+
+  return n;
+}
+
+/**
+ *
+ * curve() - the channel's transfer function; what load() would do to
+ * every input from 0 to LookupSize-1, for plotting.  Streaming
+ * filters are shown settled (as their input), and aren't disturbed.
+ *
+ * @param channel int - the (output side) channel, 1..15.
+ *
+ * @param normal vector of unsigned int - the normal value for each
+ * input (of the input channel patched to it).
+ *
+ * @param output vector of unsigned int - the output for each input.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool ChannelManager::curve(int channel, vector<unsigned int> & normal, vector<unsigned int> & output) {
+
+  if(!isReady()) {
+    error("curve() - object not ready.");
+    return false;
+  }
+
+  if((channel < 1) || (channel > CMMaxChannels)) {
+    error(string("curve() - channel # must be 1..15: ") + to_string(channel));
+    return false;
+  }
+
+  int src = patchTableInverted[channel];
+
+  unsigned int in[CMMaxChannels+1];
+  unsigned int norm[CMMaxChannels+1];
+  unsigned int out[CMMaxChannels+1];
+
+  normal.resize(LookupSize);
+  output.resize(LookupSize);
 
-      static char buf[2048];
+  /* just run every input through, its cheap enough */
 
-      sprintf(buf, "chan %d r: %d rt: %d rf: %d of: %d ot: %d",
-              i,
-              input[i],
-              inputTrans[i]->y(input[i]),
-              inputFilter[i]->y(inputTrans[i]->y(input[i])),
-              outputFilter[i]->y(normal[patchTable[i]]),
-              outputTrans[i]->inverse(outputFilter[i]->y(normal[src])));
+  for(unsigned int x=0; x<LookupSize; x++) {
 
-      info(string("load() ") + buf);
+    for(int i=0; i<=CMMaxChannels; i++) {
+      in[i] = x;
     }
+
+    if(!run(in, norm, out, CMAllFresh, true)) {
+      return false;
+    }
+
+    normal[x] = norm[src];
+    output[x] = out[channel];
   }
 
   /* all done */
@@ -119,8 +119,26 @@ bool CommandPort::configure(void) {
  */
 
 bool CommandPort::receive(string & line) {
+  return receive(client, line);
+}
+
+/**
+ *
+ * receive() - read exactly one line of input from the
+ * given client.  If the client doesn't finish its line
+ * within the read timeout we give up on it.
+ *
+ * @param clientFd int - the client (see accept()).
+ *
+ * @param line string - the command line we are passing back.
+ *
+ * @return bool - exactly false on any error.
+ *
+ */
 
-  if(client < 0) {
+bool CommandPort::receive(int clientFd, string & line) {
+
+  if(clientFd < 0) {
     error("receive() - no client.");
     return false;
   }
@@ -131,7 +149,7 @@ bool CommandPort::receive(string & line) {
    *
    */
 
-  static char buffer[4096];
+  char buffer[4096];
 
   line = "";
 
@@ -152,12 +170,15 @@ bool CommandPort::receive(string & line) {
 
     /* read next character ... */
 
-    numRead = read(client, &ch, 1);
+    numRead = read(clientFd, &ch, 1);
 
     if (numRead == -1) {
 
       if (errno == EINTR) {
         continue;
+      } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        error(string("receive() - client took more than ") + to_string(readTimeoutSeconds) + string("s to send a line."));
+        return false;
       } else {
         error(string("receive() - problem reading line: ") + strerror(errno));
         return false;
@@ -232,19 +253,51 @@ bool CommandPort::receive(string & line) {
  */
 
 bool CommandPort::send(const string & line) {
+  return send(client, line);
+}
 
-  if(client < 0) {
+/**
+ *
+ * send() - send a response to the given client.
+ *
+ * @param clientFd int - the client (see accept()).
+ *
+ * @param line string - the line of text to send.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CommandPort::send(int clientFd, const string & line) {
+
+  if(clientFd < 0) {
     error("send() - no client.");
     return false;
   }
 
-  /* write the response text */
+  /*
+   * write the response text; big ones ("channels,curve") can take
+   * more than one write().
+   *
+   */
+
+  size_t done = 0;
 
-  size_t n = write(client, line.c_str(), line.size());
+  while(done < line.size()) {
 
-  if(n != line.size()) {
-    error("send() - could not write entire line.");
-    return false;
+    ssize_t wrote = write(clientFd, line.c_str() + done, line.size() - done);
+
+    if(wrote < 0) {
+
+      if(errno == EINTR) {
+        continue;
+      }
+
+      error(string("send() - could not write entire line: ") + strerror(errno));
+      return false;
+    }
+
+    done += (size_t)wrote;
   }
 
   /* terminate the line */
@@ -253,7 +306,7 @@ bool CommandPort::send(const string & line) {
   buf[0] = '\n';
   buf[1] = '\0';
 
-  n = write(client, buf, 1);
+  ssize_t n = write(clientFd, buf, 1);
 
   if(n != 1) {
     error("send() - could not terminate line.");
@@ -278,6 +331,39 @@ bool CommandPort::send(const string & line) {
 
 bool CommandPort::accept(void) {
 
+  int clientFd = -1;
+
+  if(!accept(clientFd)) {
+    return false;
+  }
+
+  client = clientFd;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * accept() - open connection to the waiting client, and
+ * hand back its descriptor rather than making it "the"
+ * client, so any number of clients can be in flight and
+ * handled by other threads.  The client gets send and
+ * receive timeouts, so it can't hold up whoever is talking
+ * to it for more than the read timeout.
+ *
+ * @param clientFd int - the new client, use it with the
+ * receive(), send() and drop() that take a descriptor.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CommandPort::accept(int & clientFd) {
+
+  clientFd = -1;
+
   if(!isReady()) {
     error("accept() - can not accept clients, not connected.");
     return false;
@@ -290,17 +376,30 @@ bool CommandPort::accept(void) {
   struct sockaddr_in addr;
   socklen_t len = sizeof(addr);
 
-  client = ::accept(fd, (struct sockaddr *)&addr, &len);
+  int newFd = ::accept4(fd, (struct sockaddr *)&addr, &len, SOCK_CLOEXEC);
 
-  if(client < 0) {
-    client = -1;
+  if(newFd < 0) {
     error(string("accept() can not accept client: ") + strerror(errno));
     return false;
   }
 
-  string clientIp = inet_ntoa(addr.sin_addr);
+  struct timeval timeOut;
+
+  timeOut.tv_sec  = readTimeoutSeconds;
+  timeOut.tv_usec = 0;
+
+  if((setsockopt(newFd, SOL_SOCKET, SO_RCVTIMEO, &timeOut, sizeof(timeOut)) != 0) ||
+     (setsockopt(newFd, SOL_SOCKET, SO_SNDTIMEO, &timeOut, sizeof(timeOut)) != 0)) {
+    warning(string("accept() - can not set client timeouts: ") + strerror(errno));
+  }
+
+  char clientIp[INET_ADDRSTRLEN];
+
+  inet_ntop(AF_INET, &addr.sin_addr, clientIp, sizeof(clientIp));
 
-  info(string("accept() - client: ") + clientIp + string(":") + to_string(port) + string(" fd: ") + to_string(client));
+  info(string("accept() - client: ") + clientIp + string(":") + to_string(port) + string(" fd: ") + to_string(newFd));
+
+  clientFd = newFd;
 
   /* all done */
 
@@ -317,19 +416,36 @@ bool CommandPort::accept(void) {
 
 bool CommandPort::drop(void) {
 
-  if(client < 0) {
+  bool status = drop(client);
+
+  client = -1;
+
+  return status;
+}
+
+/**
+ *
+ * drop() - drop the given client.
+ *
+ * @param clientFd int - the client (see accept()).
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CommandPort::drop(int clientFd) {
+
+  if(clientFd < 0) {
 
     /* nothing to do */
 
     return true;
   }
 
-  info(string("drop() - dropping client (") + to_string(client) + string(")..."));
+  info(string("drop() - dropping client (") + to_string(clientFd) + string(")..."));
 
-  send("END\n");
-  close(client);
-
-  client = -1;
+  send(clientFd, "END\n");
+  close(clientFd);
 
   return true;
 }
@@ -0,0 +1,242 @@
+#include "DL32Parser.hh"
+
+#include <algorithm>
+#include <string.h>
+
+/**
+ *
+ * reset() - forget any partial packet, queued frames and
+ * counters.
+ *
+ */
+
+void DL32Parser::reset(void) {
+
+  state       = HUNT;
+  header      = 0;
+  length      = 0;
+  have        = 0;
+  hunting     = false;
+  head        = 0;
+  count       = 0;
+  parsed      = 0;
+  resyncs     = 0;
+  skipped     = 0;
+  overwritten = 0;
+}
+
+/**
+ *
+ * feed() - parse more bytes from the DL-32.
+ *
+ * @param bytes unsigned char array - the bytes.
+ *
+ * @param n size_t - how many.
+ *
+ * @param stamp uint64_t - when the bytes arrived, any packets they
+ * complete get this as their stamp.
+ *
+ * @return size_t - the # of frames completed by these bytes.
+ *
+ */
+
+size_t DL32Parser::feed(const unsigned char *bytes, size_t n, uint64_t stamp) {
+
+  size_t completed = 0;
+
+  for(size_t i=0; i<n; i++) {
+
+    unsigned char c = bytes[i];
+
+    switch(state) {
+
+      case HUNT:
+        {
+          /* the 1st header byte? */
+
+          if((c & 0xA2) == 0xA2) {
+            header = c;
+            state  = HEADER;
+            break;
+          }
+
+          /* nope, skip it */
+
+          skipped++;
+
+          if(!hunting) {
+            hunting = true;
+            resyncs++;
+          }
+        }
+        break;
+
+      case HEADER:
+        {
+          if((c & 0x80) != 0x80) {
+
+            /* not a header after all, skip both bytes */
+
+            skipped += 2;
+
+            if(!hunting) {
+              hunting = true;
+              resyncs++;
+            }
+
+            state = HUNT;
+            break;
+          }
+
+          /*
+           * payload length (in 2 byte words), first byte last bit is B7
+           * and B6..B0 of second byte are the remaining bits of the
+           * one byte length value.
+           *
+           */
+
+          length  = ((header & 0x01) * 0x80 + (c & 0x7F)) * 2;
+          have    = 0;
+          hunting = false;
+          state   = PAYLOAD;
+
+          if(length == 0) {
+            emit(stamp);
+            completed++;
+            state = HUNT;
+          }
+        }
+        break;
+
+      case PAYLOAD:
+        {
+          /* copy as much of the payload as we have in one go */
+
+          size_t take = std::min(length - have, n - i);
+
+          memcpy(payload + have, bytes + i, take);
+
+          have += take;
+          i    += take - 1;
+
+          if(have >= length) {
+            emit(stamp);
+            completed++;
+            state = HUNT;
+          }
+        }
+        break;
+    }
+  }
+
+  return completed;
+}
+
+/**
+ *
+ * emit() - (feed() helper) the current packet is complete, decode
+ * it into the frame queue.
+ *
+ */
+
+void DL32Parser::emit(uint64_t stamp) {
+
+  /* if the queue is full, the oldest frame goes */
+
+  if(count >= DL32ParserMaxFrames) {
+    head = (head + 1) % DL32ParserMaxFrames;
+    count--;
+    overwritten++;
+  }
+
+  DL32Frame & frame = frames[(head + count) % DL32ParserMaxFrames];
+
+  memset(frame.samples, 0, sizeof(frame.samples));
+
+  frame.channels = 0;
+  frame.stamp    = stamp;
+
+  /*
+   * B15/B14 specify the kind of sub-packet:
+   *
+   *   1? - LM-1, B14 is recording or not recording
+   *   01 - LC-1,
+   *   00 - Other/Aux data source (12 Big DAC value), this is the DL-32 :)
+   *
+   */
+
+  for(size_t i=0; (i+1)<length; i+=2) {
+
+    if(((payload[i] & 0xC0) == 0) && ((payload[i+1] & 0x80) == 0)) {
+
+      if(frame.channels < DL32ChannelMax) {
+
+        unsigned int word = (((unsigned short)payload[i]) << 8) + (unsigned short)payload[i+1];
+
+        frame.samples[frame.channels+1] = word;
+        frame.channels++;
+      }
+
+    } else if(payload[i] & 0x80) {
+
+      /* ignoring LM-1 sub-packet */
+
+    } else {
+
+      /* ignoring LC-1 sub-packet */
+
+    }
+  }
+
+  count++;
+  parsed++;
+}
+
+/**
+ *
+ * next() - take the oldest complete frame.
+ *
+ * @param frame DL32Frame - the frame.
+ *
+ * @return bool - exactly false if there are none.
+ *
+ */
+
+bool DL32Parser::next(DL32Frame & frame) {
+
+  if(count == 0) {
+    return false;
+  }
+
+  frame = frames[head];
+
+  head = (head + 1) % DL32ParserMaxFrames;
+  count--;
+
+  return true;
+}
+
+/**
+ *
+ * latest() - take the newest complete frame, and throw away
+ * any older ones.
+ *
+ * @param frame DL32Frame - the frame.
+ *
+ * @return bool - exactly false if there are none.
+ *
+ */
+
+bool DL32Parser::latest(DL32Frame & frame) {
+
+  if(count == 0) {
+    return false;
+  }
+
+  frame = frames[(head + count - 1) % DL32ParserMaxFrames];
+
+  head  = 0;
+  count = 0;
+
+  return true;
+}
@@ -12,170 +12,282 @@
  * go up to DL32ChannelMax, so samples must
  * be at least DL32ChannelMax+1 in size.
  *
+ * @param stamp uint64_t pointer - if not NULL,
+ * set to the monotonic time (nanoseconds) at
+ * which the packet finished arriving.
+ *
  * @return bool - exactly false on error.
  *
  */
 
-bool DL32Port::readSamples(unsigned int *samples) {
+bool DL32Port::readSamples(unsigned int *samples, uint64_t *stamp) {
 
-  int        fd = getHandle();
-  size_t nReady = 0;
-  size_t      n = 0;
+  int       fd = getHandle();
+  DL32Frame frame;
 
-  while(true) {
+  /*
+   * we're only called when the port is readable, so the first read()
+   * won't block; it takes everything the DL-32 has sent so far (not
+   * a byte at a time).  Only if that still leaves us part way through
+   * a packet do we have to wait for the rest.
+   *
+   */
 
-    buffer[0]     = 0x0;
-    buffer[1]     = 0x0;
+  bool first = true;
 
-    /* wait for data to be ready */
+  while(!parser.latest(frame)) {
 
-    nReady = waitForBytes(fd);
+    if(!first) {
 
-    if(nReady <= 0) {
-      error("waited but no bytes!!");
-      return false;
+      int nReady = waitForBytes(1);
+
+      if(nReady <= 0) {
+        error("waited but no bytes!!");
+        return false;
+      }
     }
 
-    /*
-     * try to read off the first couple of bytes that
-     * allow us to detect a packet header
-     *
-     */
+    first = false;
 
-    n = read(fd, buffer, 1);
+    ssize_t n = read(fd, chunk, sizeof(chunk));
 
-    if(n < 1) {
-      error("tried to read a byte, but couldn't.");
+    if(n == 0) {
+      error("tried to read bytes, but couldn't.");
       return false;
     }
 
-    if(((buffer[0] & 0xA2) == 0xA2)) {
+    if(n < 0) {
 
-      nReady = waitForBytes(fd);
+      if((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
 
-      if(nReady <= 0) {
-        error("waited but no bytes!!");
-        return false;
+        /* (EAGAIN if the port is non-blocking) wait for the rest */
+
+        continue;
       }
 
-      n = read(fd, buffer + 1, 1);
+      error(string("can't read bytes: ") + strerror(errno));
+      return false;
+    }
 
-      if(n < 1) {
-        error("tried to read a byte, but couldn't.");
-        return false;
-      }
+    /* any packet these bytes finish, is when that sample was taken */
 
-      if(((buffer[1] & 0x80) == 0x80)) {
+    took((size_t)n, monotonic_ns());
+  }
 
-        /* looks like a header! */
+  /*
+   * if more than one packet came in at once, only the newest matters,
+   * it's the "current value".
+   *
+   */
 
-        break;
+  for(int i=1; i<=frame.channels; i++) {
+    samples[i] = frame.samples[i];
+    data[i]    = frame.samples[i]; /* store a copy for later just in case */
+  }
 
-      } else {
+  if(stamp != NULL) {
+    *stamp = frame.stamp;
+  }
 
-        /* ignoring byte 1 */
+  /* all done */
 
-      }
+  return true;
+}
 
-    } else {
+/**
+ *
+ * pollSamples() - (non-blocking port) take whatever bytes the port
+ * has right now, and never wait for more.  If that finished one or
+ * more packets, the oldest goes in 'samples' (take the rest with
+ * nextSamples()), otherwise a partial packet is kept for next time
+ * and 'samples' isn't touched.  Reads until the port is empty, so
+ * its safe with edge triggered epoll.
+ *
+ * @param samples int array - the array of channel data, at least
+ * DL32ChannelMax+1 in size.
+ *
+ * @param fresh bool - set to true if we got a new packet.
+ *
+ * @param stamp uint64_t pointer - if not NULL, and we got a new
+ * packet, set to the monotonic time it finished arriving.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
 
-      /* ignoring byte 0 */
+bool DL32Port::pollSamples(unsigned int *samples, bool & fresh, uint64_t *stamp) {
 
-    }
-  }
+  int fd = getHandle();
 
-  /* verify header */
+  fresh = false;
 
-  if(((buffer[0] & 0xA2) == 0xA2) && ((buffer[1] & 0x80) == 0x80)) {
+  while(true) {
 
-    /*
-     * get payload length (in 2 byte words), first byte last bit is B7
-     * and B6..B0 of second byte are the remaining bits of the
-     * one byte length value.
-     *
-     */
+    ssize_t n = read(fd, chunk, sizeof(chunk));
 
-    size_t length = (buffer[0] & 0x01)*0x80 + (buffer[1] & 0x7F);
-    size_t remain = length*2;
-    size_t nRead  = 0;
+    if(n == 0) {
 
-    /*
-     * read the payload, normally 'length' values, which are in
-     * 2 bytes each (they are word values)
-     *
-     */
+      /* the port has gone away (unplugged?) */
 
-    while(nRead < (length*2)) {
+      error("DL-32 port closed.");
+      return false;
+    }
 
-      nReady = waitForBytes(fd);
+    if(n < 0) {
 
-      if(nReady <= 0) {
-        error("waited but no bytes!!");
-        return false;
+      if(errno == EINTR) {
+        continue;
       }
 
-      n = read(fd, payload+nRead, remain);
+      if((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
 
-      if(n == 0) {
+        /* that's everything for now */
 
-        error("tried to read a byte, but couldn't.");
-        return false;
+        break;
       }
 
-      if(n < 0) {
-        error("can't read payload bytes!");
-        return false;
-      }
+      error(string("can't read bytes: ") + strerror(errno));
+      return false;
+    }
+
+    took((size_t)n, monotonic_ns());
+
+    if((size_t)n < sizeof(chunk)) {
 
-      nRead  += n;
-      remain -= n;
+      /*
+       * a short read means we've emptied the port, no need for the
+       * extra read() just to be told EAGAIN.
+       *
+       */
+
+      break;
     }
+  }
 
-    /*
-     * B15/B14 specify the kind of sub-packet:
-     *
-     *   1? - LM-1, B14 is recording or not recording
-     *   01 - LC-1,
-     *   00 - Other/Aux data source (12 Big DAC value), this is the DL-32 :)
-     *
-     */
+  if(!nextSamples(samples, stamp)) {
 
-    int wordNum = 0;
+    /* nothing complete yet */
 
-    for(int i=0; i<(length*2); i+=2) {
+    return true;
+  }
 
-      if(((payload[i] & 0xC0) == 0) && ((payload[i+1] & 0x80) == 0)) {
+  fresh = true;
 
-        unsigned int word = (((unsigned short)payload[i]) << 8) + (unsigned short)payload[i+1];
+  /* all done */
 
-        samples[wordNum+1] = word;
-        data[wordNum+1]    = word; /* store a copy for later just in case */
+  return true;
+}
+
+/**
+ *
+ * nextSamples() - after pollSamples(), take the next packet that came
+ * in with the same read.
+ *
+ * @return bool - exactly false if there are no more.
+ *
+ */
 
-        wordNum++;
+bool DL32Port::nextSamples(unsigned int *samples, uint64_t *stamp) {
 
-      } else if(payload[i] & 0x80) {
+  DL32Frame frame;
 
-        /* ignoring LM-1 sub-packet */
+  if(!parser.next(frame)) {
+    return false;
+  }
 
-      } else {
+  for(int i=1; i<=frame.channels; i++) {
+    samples[i] = frame.samples[i];
+    data[i]    = frame.samples[i];
+  }
 
-        /* ignoring LC-1 sub-packet */
+  if(stamp != NULL) {
+    *stamp = frame.stamp;
+  }
 
-      }
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * took() - (read helper) we read 'n' bytes into chunk at 'stamp',
+ * parse them (and capture them).
+ *
+ */
+
+void DL32Port::took(size_t n, uint64_t stamp) {
 
+  reads++;
+
+  parser.feed(chunk, n, stamp);
+
+  if(capture != NULL) {
+
+    if(!capture->append(stamp, chunk, n)) {
+
+      /* disk full or similar, don't let it take the port down too */
+
+      warning("took() - capture failed, stopping it.");
+      stopCapture();
     }
+  }
+}
 
-  } else {
+/**
+ *
+ * startCapture() - record the raw bytes we read from the DL-32, with
+ * their timestamps, to a capture file (see SerialCapture) until
+ * stopCapture().  The ecureplay tool can play it back.
+ *
+ * @param fileName string - the capture file.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
 
-    /* ignoring non-header */
+bool DL32Port::startCapture(const string & fileName) {
 
+  stopCapture();
+
+  capture = new SerialCapture();
+
+  if(!capture->create(fileName)) {
+    error(string("startCapture() - can not create capture file: ") + fileName);
+    delete capture;
+    capture = NULL;
+    return false;
   }
 
-  /*
-   * at this point all DL32ChannelMax channels should have been
-   * read in, and 'samples' has the data.  We are done.
-   *
-   */
+  info(string("startCapture() - capturing to: ") + fileName);
+
+  /* all done */
 
   return true;
 }
+
+/**
+ *
+ * stopCapture() - stop recording, and close the capture file.
+ *
+ * @return unsigned long - the # of reads that were recorded.
+ *
+ */
+
+unsigned long DL32Port::stopCapture(void) {
+
+  if(capture == NULL) {
+    return 0;
+  }
+
+  unsigned long records = capture->getRecords();
+
+  capture->close();
+
+  delete capture;
+  capture = NULL;
+
+  info(string("stopCapture() - captured ") + to_string(records) + string(" reads."));
+
+  return records;
+}
@@ -1,10 +1,31 @@
 #include "ECUBridge.hh"
 #include <math.h>
 
+/**
+ *
+ * toMicros() - nanoseconds to microseconds, saturating at what
+ * fits in our histograms.
+ *
+ */
+
+static uint32_t toMicros(uint64_t ns) {
+
+  uint64_t us = ns / 1000ULL;
+
+  if(us > 0xFFFFFFFFULL) {
+    return 0xFFFFFFFF;
+  }
+
+  return (uint32_t)us;
+}
+
 ECUBridge::ECUBridge(void) :
-  Object("ECUBridge"), running(false), channelMgr(NULL), portMapper(NULL),
-  dl32(NULL), solodl(NULL), rawTap(NULL), normalTap(NULL), outputTap(NULL),
-  cmdPort(NULL), breakbreak(false), cable(NULL) {
+  Object("ECUBridge"), running(false), channelMgr(NULL), freshMgr(NULL), reloadPending(false), portMapper(NULL),
+  dl32(NULL), canInput(NULL), rawTap(NULL), normalTap(NULL), outputTap(NULL),
+  cmdPort(NULL), breakbreak(false), cable(NULL), epfd(-1), timerfd(-1),
+  senderCpu(-1), senderPriority(0), lockMemory(false), commandQueue(4),
+  jobsOpen(false), activeClient(-1), wakefd(-1), sendHz(SoloDLDefaultTickHz),
+  phaseLock(true), phaseGuard(2000000), phaseMaxShift(8000000) {
 
   info("bridge is starting up...");
 
@@ -38,6 +59,8 @@ bool ECUBridge::clear(void) {
     channelMgr = NULL;
   }
 
+  delete freshMgr.exchange(NULL);
+
   if(portMapper != NULL) {
     delete portMapper;
     portMapper = NULL;
@@ -48,11 +71,17 @@ bool ECUBridge::clear(void) {
     dl32 = NULL;
   }
 
-  if(solodl != NULL) {
-    delete solodl;
-    solodl = NULL;
+  if(canInput != NULL) {
+    delete canInput;
+    canInput = NULL;
   }
 
+  for(auto sink : sinks) {
+    delete sink;
+  }
+
+  sinks.clear();
+
   if(rawTap != NULL) {
     delete rawTap;
     rawTap = NULL;
@@ -126,9 +155,9 @@ bool ECUBridge::configure(void ) {
       return false;
     }
 
-    /* open it */
+    /* open it, non-blocking, the event loop must never wait on it */
 
-    dl32 = new DL32Port(device);
+    dl32 = new DL32Port(device, true);
 
     if(!dl32->isReady()) {
       warning(string("configure() - can not open DL-32: ") + dl32->getError());
@@ -139,28 +168,29 @@ bool ECUBridge::configure(void ) {
 
   info("dl32.");
 
-  /* setup the SoloDL port */
+  noteSerial();
 
-  if(portMapper->isReady()){
+  /* setup the CAN input, if any channels come from CAN */
 
-    string device = portMapper->getDevice(Device::SOLODL);
+  canInput = new CANInput();
 
-    if(device.empty()) {
-      error("configure() - can not find Solo DL device.");
-      return false;
-    }
+  if(!canInput->isReady()) {
+    error("configure() - can not configure CAN input.");
+    return false;
+  }
 
-    /* open it */
+  if(!canInput->isEnabled()) {
 
-    solodl = new SoloDLPort(device);
+    delete canInput;
+    canInput = NULL;
 
-    if(!solodl->isReady()) {
-      warning(string("configure() - can not open Solo DL: ") + dl32->getError());
-      delete solodl;
-      solodl = NULL;
-    }
+  } else if(!canInput->open()) {
+
+    warning("configure() - can not open CAN input, carrying on without it.");
+    delete canInput;
+    canInput = NULL;
   }
-  info("solodl.");
+  info("can input.");
 
   /* setup the data taps */
 
@@ -244,9 +274,142 @@ bool ECUBridge::configure(void ) {
       error(string("configure() - can not open output tap: ") + outputTap->getError());
       return false;
     }
+
+    /* real time settings for the sender thread (all optional) */
+
+    senderCpu      = -1;
+    senderPriority = 0;
+    lockMemory     = ini.enabled("ECU Bridge", "lock_memory");
+
+    tmp = trim(ini.getValue("ECU Bridge", "sender_cpu"));
+
+    if(is_numeric(tmp)) {
+      senderCpu = (int)strtol(tmp.c_str(), NULL, 10);
+    }
+
+    tmp = trim(ini.getValue("ECU Bridge", "sender_priority"));
+
+    if(is_numeric(tmp)) {
+      senderPriority = (int)strtol(tmp.c_str(), NULL, 10);
+    }
+
+    if((senderPriority < 0) || (senderPriority > 99)) {
+      error("configure() - sender_priority must be 0 (normal) or 1..99 (SCHED_FIFO).");
+      return false;
+    }
+
+    /* how many command clients may wait for the command worker */
+
+    commandQueue = 4;
+
+    tmp = trim(ini.getValue("ECU Bridge", "command_queue"));
+
+    if(is_numeric(tmp)) {
+      commandQueue = (int)strtol(tmp.c_str(), NULL, 10);
+    }
+
+    if(commandQueue < 1) {
+      error("configure() - command_queue must be at least 1.");
+      return false;
+    }
+
+    clients.setLimit(commandQueue);
+
+    /* the sender runs at the SoloDL output schedule's tick rate */
+
+    sendHz = SoloDLPort::configuredTickHz();
+
+    if(sendHz == 0) {
+      error(string("configure() - [solodl] tick_hz must be 1..") + to_string((int)TimingWheelMaxHz) + string(" Hz."));
+      return false;
+    }
+
+    /* phase lock to the DL-32 (on unless turned off) */
+
+    tmp = trim(ini.getValue("ECU Bridge", "phase_lock"));
+
+    phaseLock     = tmp.empty() || ini.enabled("ECU Bridge", "phase_lock");
+    phaseGuard    = 2000000;
+    phaseMaxShift = 8000000;
+
+    tmp = trim(ini.getValue("ECU Bridge", "phase_guard_ms"));
+
+    if(is_numeric(tmp)) {
+      phaseGuard = (uint64_t)(strtod(tmp.c_str(), NULL) * 1000000.0);
+    }
+
+    tmp = trim(ini.getValue("ECU Bridge", "phase_max_shift_ms"));
+
+    if(is_numeric(tmp)) {
+      phaseMaxShift = (uint64_t)(strtod(tmp.c_str(), NULL) * 1000000.0);
+    }
+
+    /*
+     * a shifted tick has to stay between its neighbours, so it can
+     * move at most just under half a tick either way.
+     *
+     */
+
+    uint64_t halfTick = (500000000ULL / (uint64_t)sendHz) - 1000000ULL;
+
+    if(phaseMaxShift > halfTick) {
+      warning(string("configure() - phase_max_shift_ms is more than half a tick, using ") + to_string(halfTick / 1000000ULL) + string(" ms."));
+      phaseMaxShift = halfTick;
+    }
   }
   info("data taps.");
 
+  /* setup the output sinks; the SoloDL, then any on the spare ports */
+
+  {
+    IniFile ini = ConfigManager::instance();
+
+    sinks.push_back(new SoloDLSink());
+
+    vector<string> names;
+
+    explode(ini.getValue("ECU Bridge", "sinks"), ", \t", names);
+
+    for(auto it = names.begin(); it != names.end(); it++) {
+
+      string name = trim(*it);
+
+      if(name.empty()) {
+        continue;
+      }
+
+      string type = trim(strtolower(ini.getValue(name, "type")));
+
+      if(type == "telemetry") {
+        sinks.push_back(new TelemetrySink(name));
+      } else if(type == "csv") {
+        sinks.push_back(new CSVSink(name));
+      } else if(type == "aimcan") {
+        sinks.push_back(new AIMCANSink(name));
+      } else {
+        error(string("configure() - [") + name + string("] type must be telemetry, csv or aimcan: ") + type);
+        return false;
+      }
+    }
+
+    for(auto sink : sinks) {
+
+      if(!sink->configure(sendHz)) {
+        error(string("configure() - can not configure output sink: ") + sink->getName());
+        return false;
+      }
+    }
+
+    /* the ones on the cable wait for it, the rest open now */
+
+    openSinks(false);
+
+    if(portMapper->isReady()) {
+      openSinks(true);
+    }
+  }
+  info("output sinks.");
+
   /* setup the command input */
 
   cmdPort = new CommandPort();
@@ -289,78 +452,127 @@ bool ECUBridge::configure(void ) {
 
 /**
  *
- * timevalSubtract() - get an accurate "delta" for two
- * timeval structs (the kind we typically use with select()
- * calls etc.).  This allows us to get deltas without having
- * to worry about microsecond rollove retc.  That mess is
- * all handled here.
+ * noteSerial() - (acquisition thread) update dl32Serial from the
+ * port we have open right now.
  *
- * @param result timeval - the delta being passed back
+ */
+
+void ECUBridge::noteSerial(void) {
+
+  string dl32Info = (dl32 != NULL) ? dl32->describeLatency() : string("not open");
+
+  std::lock_guard<std::mutex> guard(serialLock);
+
+  dl32Serial = dl32Info;
+}
+
+/**
  *
- * @param x timeval - argument 1
+ * openSinks() - (acquisition thread) open the sinks' ports.  The
+ * spare ports are optional, if one of them can't be opened we
+ * just warn about it.
  *
- * @param y timeval - argument 2
+ * @param cabled bool - the sinks on the USB cable (when it's
+ * plugged in), or the ones that aren't (once, at start up); see
+ * OutputSink::onCable().
  *
- * @return bool - exactliy true is returned if x is less
- * than y.
+ * @return bool - exactly false if the SoloDL can't be opened.
  *
  */
 
-bool ECUBridge::timevalSubtract(struct timeval *result,
-                                struct timeval *x,
-                                struct timeval *y) {
+bool ECUBridge::openSinks(bool cabled) {
 
-  /* Perform the carry for the later subtraction by updating y. */
+  bool ok = true;
 
-  if (x->tv_usec < y->tv_usec) {
-    int nsec    = (y->tv_usec - x->tv_usec) / 1000000 + 1;
-    y->tv_usec -= 1000000 * nsec;
-    y->tv_sec  += nsec;
-  }
-  if (x->tv_usec - y->tv_usec > 1000000) {
-    int nsec    = (x->tv_usec - y->tv_usec) / 1000000;
-    y->tv_usec += 1000000 * nsec;
-    y->tv_sec  -= nsec;
+  for(size_t i=0; i<sinks.size(); i++) {
+
+    if(sinks[i]->onCable() != cabled) {
+      continue;
+    }
+
+    if(cabled ? sinks[i]->open(*portMapper) : sinks[i]->open()) {
+      continue;
+    }
+
+    warning(string("openSinks() - can not open output sink: ") + sinks[i]->getName());
+
+    if(i == 0) {
+      ok = false;
+    }
   }
 
-  /*
-   * Compute the time remaining to wait.
-   * tv_usec is certainly positive.
-   *
-   */
+  /* all done */
+
+  return ok;
+}
 
-  result->tv_sec  = x->tv_sec - y->tv_sec;
-  result->tv_usec = x->tv_usec - y->tv_usec;
+/**
+ *
+ * closeSinks() - (acquisition thread) close the ports of the sinks
+ * on the USB cable (it was unplugged); the others stay open.
+ *
+ */
 
-  /* Return 1 if result is negative. */
+void ECUBridge::closeSinks(void) {
 
-  return x->tv_sec < y->tv_sec;
+  for(auto sink : sinks) {
+    if(sink->onCable()) {
+      sink->close();
+    }
+  }
 }
 
 /**
  *
- * setFD() - helper to add a descriptor to
- * a select() file descriptor set
+ * watch() - helper to add a descriptor to our epoll
+ * set (we only ever care about it being readable).
+ *
+ * @param fd int - the descriptor to watch.
+ *
+ * @param edge bool - edge triggered; we're only told when new
+ * data arrives, so we have to read until its empty every time.
+ *
+ * @return bool - exactly false on error.
  *
  */
 
-bool ECUBridge::setFD(int fd, fd_set *fds, int *max) {
+bool ECUBridge::watch(int fd, bool edge) {
+
+  struct epoll_event ev;
 
-  FD_SET(fd, fds);
+  memset(&ev, 0, sizeof(ev));
 
-  if (fd >= *max) {
-    *max = fd + 1;
+  ev.events  = edge ? (EPOLLIN | EPOLLET) : EPOLLIN;
+  ev.data.fd = fd;
+
+  if(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+    error(string("watch() - can not watch fd ") + to_string(fd) + string(": ") + strerror(errno));
+    return false;
   }
 
-  /* double check max */
+  return true;
+}
+
+/**
+ *
+ * unwatch() - helper to remove a descriptor from our
+ * epoll set.
+ *
+ * @param fd int - the descriptor to stop watching.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool ECUBridge::unwatch(int fd) {
 
-  for(int d = 0; d < *max; d++) {
+  struct epoll_event ev;
 
-    if (FD_ISSET(d, fds)) {
-      if(d >= *max) {
-        *max = d + 1;
-      }
-    }
+  memset(&ev, 0, sizeof(ev));
+
+  if(epoll_ctl(epfd, EPOLL_CTL_DEL, fd, &ev) != 0) {
+    error(string("unwatch() - can not unwatch fd ") + to_string(fd) + string(": ") + strerror(errno));
+    return false;
   }
 
   return true;
@@ -368,24 +580,28 @@ bool ECUBridge::setFD(int fd, fd_set *fds, int *max) {
 
 /**
  *
- * clrFD() - helper to remove a descriptor from
- * a select() file descriptor set
+ * armTimer() - set the send timer to fire at the given
+ * absolute CLOCK_MONOTONIC time.
+ *
+ * @param deadline uint64_t - when to fire (nanoseconds, see
+ * monotonic_ns()).
+ *
+ * @return bool - exactly false on error.
  *
  */
 
-bool ECUBridge::clrFD(int fd, fd_set *fds, int *max) {
+bool ECUBridge::armTimer(uint64_t deadline) {
 
-  FD_CLR(fd, fds);
+  struct itimerspec spec;
 
-  /* double check max */
+  memset(&spec, 0, sizeof(spec));
 
-  for(int d = 0; d < *max; d++) {
+  spec.it_value.tv_sec  = deadline / 1000000000ULL;
+  spec.it_value.tv_nsec = deadline % 1000000000ULL;
 
-    if (FD_ISSET(d, fds)) {
-      if(d >= *max) {
-        *max = d + 1;
-      }
-    }
+  if(timerfd_settime(timerfd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+    error(string("armTimer() - can not arm send timer: ") + strerror(errno));
+    return false;
   }
 
   return true;
@@ -424,9 +640,9 @@ bool ECUBridge::monitorData(DataTapWriter *tap, unsigned int *d) {
     return false;
   }
 
-  static char buffer[2048];
+  char buffer[2048];
 
-  sprintf(buffer,
+  snprintf(buffer, sizeof(buffer),
           "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
           1, d[1],   2,d[2],   3,d[3],  4,d[4],   5,d[5],
           6, d[6],   7,d[7],   8,d[8],  9,d[9],  10,d[10],
@@ -461,8 +677,29 @@ bool ECUBridge::monitorData(DataTapWriter *tap, unsigned int *d) {
  *
  *   echo <args> - just echo back
  *
+ * Commands are run by the command worker thread, except channels,
+ * patch, filter and capture, which are run by the acquisition thread
+ * (see onLoop()).  "channels,curve" is the worker's too, only its
+ * table is worked out on the acquisition thread (see channelCurve()).
+ *
  *   status - echo a quick summary of key statistics and overall status
  *
+ *   trace dump [file] - write the cycle profiler rings out as Chrome/Perfetto
+ *   trace JSON (default /var/tmp/ecubridge-trace.json).  Only works if the
+ *   bridge was built with tracing (ECUBRIDGE_TRACE).
+ *
+ *   capture <start [file]|stop> - record the raw DL-32 input (with
+ *   timestamps) to a capture file (default /var/tmp/ecubridge-dl32.cap)
+ *   for playing back with ecureplay.
+ *
+ *   reload - re-read the channel configuration ([input filter],
+ *   [output filter] and the patch order) from the .ini file, and switch
+ *   over to it between two frames.  Live filter/patch changes are lost.
+ *
+ *   latency [reset] - p50/p99/max (microseconds) of the data age at the
+ *   SoloDL, the send period and the sender wake up lateness.  With
+ *   "reset" the histograms are cleared.
+ *
  *   filter <input|output> <chan> <kind> <args> - set an input or output
  *   filter and provide any arguments, manual filter needs 1 argument
  *   for example.
@@ -619,8 +856,41 @@ bool ECUBridge::doCommand(const string & command, string & result) {
     /* reads/writes */
 
     status += string(" reads: ") + to_string(stats.rx) + "\n";
+    status += string("  dl32: ") + to_string(stats.reads) + string(" port reads, ") + to_string(stats.resyncs)
+      + string(" resyncs, ") + to_string(stats.skipped) + string(" bytes skipped\n");
     status += string("writes: ") + to_string(stats.tx) + "\n";
 
+    /* each sink reports on itself (sinks is fixed while we run) */
+
+    for(auto sink : sinks) {
+      status += sink->describe();
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(serialLock);
+
+      status += string("  dl32 port: ") + dl32Serial + "\n";
+    }
+
+    if(canInput != NULL) {
+      status += canInput->describe();
+    }
+
+    status += string("  late: ") + to_string(stats.late) + "\n";
+    status += string("  tick: ") + to_string(sendHz) + " hz\n";
+    status += string("  busy: ") + to_string(stats.busy) + "\n";
+
+    if(!phaseLock) {
+      status += " phase: off\n";
+    } else if(!phase.locked) {
+      status += " phase: searching\n";
+    } else {
+      status += string(" phase: locked, dl32 period ") + to_string(phase.period) + string(" us, jitter ")
+        + to_string(phase.jitter) + string(" us, ") + to_string(stats.shifted) + string(" ticks shifted\n");
+    }
+    status += string("  taps: ") + to_string(taps.pushed()) + string(" queued, ")
+      + to_string(taps.drops()) + string(" dropped\n");
+
     /* uptime */
 
     status += string("uptime: ") + to_string(stats.uptime) + "\n";
@@ -639,6 +909,119 @@ bool ECUBridge::doCommand(const string & command, string & result) {
 
     result = status;
 
+  } else if(cmd == "reload") {
+
+    if(!reloadChannels(result)) {
+      error(string("doCommand() - (reload) failed: ") + result);
+    }
+
+  } else if(cmd == "latency") {
+
+    if(tokens.size() >= 2) {
+
+      string subCmd = trim(strtolower(tokens[1]));
+
+      if(subCmd == "reset") {
+
+        latencyHist.reset();
+        periodHist.reset();
+        wakeHist.reset();
+
+        result = "OK.  Latency histograms reset.";
+
+      } else {
+
+        result = string("ERROR: unknown sub-command: ") + tokens[1];
+        error(string("doCommand() - (latency) syntax error: ") + result);
+      }
+
+    } else {
+
+      result += string("   age: ") + latencyHist.summary() + "\n";
+      result += string("period: ") + periodHist.summary()  + "\n";
+      result += string("  wake: ") + wakeHist.summary()    + "\n";
+      result += "(microseconds)\n";
+    }
+
+  } else if(cmd == "trace") {
+
+    string subCmd = "";
+
+    if(tokens.size() >= 2) {
+      subCmd = trim(strtolower(tokens[1]));
+    }
+
+    if(subCmd != "dump") {
+
+      result = string("ERROR: unknown sub-command: ") + subCmd;
+      error(string("doCommand() - (trace) syntax error: ") + result);
+
+    } else {
+
+#ifdef ECUBRIDGE_TRACE
+
+      string fileName = "/var/tmp/ecubridge-trace.json";
+
+      if(tokens.size() >= 3) {
+        fileName = trim(tokens[2]);
+      }
+
+      size_t count = 0;
+
+      if(!Tracer::instance().dump(fileName, count)) {
+        result = string("ERROR: problem dumping trace: ") + Tracer::instance().getError();
+        error(string("doCommand() - ") + result);
+      } else {
+        result = string("OK.  ") + to_string(count) + string(" records written to: ") + fileName;
+      }
+
+#else
+
+      result = "ERROR: tracing is not compiled in (build with ECUBRIDGE_TRACE).";
+
+#endif
+    }
+
+  } else if(cmd == "capture") {
+
+    string subCmd = "";
+
+    if(tokens.size() >= 2) {
+      subCmd = trim(strtolower(tokens[1]));
+    }
+
+    if(subCmd == "start") {
+
+      string fileName = "/var/tmp/ecubridge-dl32.cap";
+
+      if(tokens.size() >= 3) {
+        fileName = trim(tokens[2]);
+      }
+
+      if(dl32 == NULL) {
+        result = "ERROR: the DL-32 is not connected.";
+      } else if(!dl32->startCapture(fileName)) {
+        result = string("ERROR: can not capture to: ") + fileName;
+        error(string("doCommand() - ") + result);
+      } else {
+        result = string("OK.  Capturing DL-32 input to: ") + fileName;
+      }
+
+    } else if(subCmd == "stop") {
+
+      if((dl32 == NULL) || !dl32->isCapturing()) {
+        result = "ERROR: not capturing.";
+      } else {
+        unsigned long records = dl32->stopCapture();
+        result = string("OK.  Capture stopped, ") + to_string(records) + string(" reads recorded.");
+      }
+
+    } else {
+
+      result = string("ERROR: unknown sub-command: ") + subCmd;
+      error(string("doCommand() - (capture) syntax error: ") + result);
+    }
+
   } else if(cmd == "patch") {
 
 
@@ -853,36 +1236,972 @@ bool ECUBridge::doCommand(const string & command, string & result) {
 
 /**
  *
- * loop() - this is the main processing loop, we pass
- * data from the DL-32 over to the SoloDL and do any
- * of the in between stuff as we go.
+ * publishFrame() - (acquisition thread) run the given raw data
+ * through the channel manager and publish the result as the
+ * latest frame for the sender.
+ *
+ * @param raw unsigned int array - the raw input [1]..[15].
+ *
+ * @param stamp uint64_t - when the newest raw input arrived (see
+ * DL32Port::pollSamples() and CANInput::pollSamples()), 0 if never.
+ *
+ * @param dl32Stamp uint64_t - when the newest DL-32 packet arrived,
+ * 0 if never.
+ *
+ * @param fresh unsigned int - which channels are new samples (see
+ * ChannelManager::load()), 0 if it's just the same input again.
+ *
+ * @return bool - exactly false on error.
  *
  */
 
-bool ECUBridge::loop(void) {
+bool ECUBridge::publishFrame(const unsigned int *raw, uint64_t stamp, uint64_t dl32Stamp, unsigned int fresh) {
 
-  if(!isReady()) {
-    error("loop() - can't run, bridge is not configured.");
-    return false;
-  }
+  static unsigned long seq = 0;
 
-  if(running) {
-    error("loop() - we are already running!");
-    return false;
+  SampleFrame & frame = frames.writeBuffer();
+
+  memcpy(frame.raw, raw, sizeof(frame.raw));
+
+  {
+    TRACE_SCOPE("load");
+
+    if(!channelMgr->load(frame.raw, frame.normal, frame.output, fresh)) {
+      error(string("publishFrame() - failed to load data: ") + channelMgr->getError());
+      return false;
+    }
   }
 
-  info("loop() - ready to run..");
+  frame.seq       = ++seq;
+  frame.stamp     = stamp;
+  frame.dl32Stamp = dl32Stamp;
 
-  /*
-   * main loop! Basically our job is to wait for DL-32
+  frames.publish();
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * realTime() - (sender thread) apply the configured CPU pinning
+ * and SCHED_FIFO priority to the calling thread.  Problems are
+ * only warned about, we can still run without them.
+ *
+ */
+
+void ECUBridge::realTime(void) {
+
+  if(senderCpu >= 0) {
+
+    cpu_set_t cpus;
+
+    CPU_ZERO(&cpus);
+    CPU_SET(senderCpu, &cpus);
+
+    int status = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    if(status != 0) {
+      warning(string("realTime() - can not pin sender to cpu ") + to_string(senderCpu) + string(": ") + strerror(status));
+    } else {
+      info(string("realTime() - sender pinned to cpu ") + to_string(senderCpu));
+    }
+  }
+
+  if(senderPriority > 0) {
+
+    struct sched_param param;
+
+    memset(&param, 0, sizeof(param));
+
+    param.sched_priority = senderPriority;
+
+    int status = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    if(status != 0) {
+      warning(string("realTime() - can not set SCHED_FIFO priority ") + to_string(senderPriority) + string(": ") + strerror(status));
+    } else {
+      info(string("realTime() - sender running SCHED_FIFO at priority ") + to_string(senderPriority));
+    }
+  }
+}
+
+/**
+ *
+ * sendLoop() - the sender thread; on every absolute tick (the
+ * SoloDL tick rate, see [solodl] tick_hz) hand the latest frame
+ * to every output sink, and at ~10hz to the data taps.
+ *
+ */
+
+void ECUBridge::sendLoop(void) {
+
+  TRACE_THREAD("sender");
+
+  realTime();
+
+  /*
+   * every send tick is an absolute deadline, anchor + tick * period,
+   * so we never re-derive the next send from when the last one actually
+   * happened, and we can't accumulate drift over a long race.
+   *
+   */
+
+  const uint64_t period  = 1000000000ULL / (uint64_t)sendHz;
+  const uint64_t started = monotonic_ns();
+
+  uint64_t tick     = 1;
+  uint64_t deadline = started + period;
+
+  /* our private copy of the frame, writeSamples() is allowed to modify it */
+
+  SampleFrame frame;
+
+  memset(&frame, 0, sizeof(frame));
+
+  uint64_t lastSent = 0;
+
+  /* learns when the DL-32 frames arrive, see below */
+
+  PhaseEstimator estimator;
+  uint64_t       lastStamp = 0;
+
+  phase.locked = false;
+  phase.period = 0;
+  phase.jitter = 0;
+
+  /* the taps only need the data at ~10hz, no matter our tick rate */
+
+  const long tapEvery = (sendHz > 10) ? (sendHz / 10) : 1;
+
+  if(!armTimer(deadline)) {
+    breakbreak = true;
+    return;
+  }
+
+  info("sendLoop() - sender is running...");
+
+  while(!breakbreak) {
+
+    /* wait for the tick */
+
+    uint64_t expirations = 0;
+    ssize_t  got         = 0;
+
+    {
+      TRACE_SCOPE("timer wait");
+
+      got = read(timerfd, &expirations, sizeof(expirations));
+    }
+
+    if(got != sizeof(expirations)) {
+
+      if(errno == EINTR) {
+        continue;
+      }
+
+      error(string("sendLoop() - can not read send timer: ") + strerror(errno));
+      breakbreak = true;
+      break;
+    }
+
+    /* how late did we wake up? */
+
+    uint64_t woke = monotonic_ns();
+
+    if(woke > deadline) {
+      wakeHist.record(toMicros(woke - deadline));
+    } else {
+      wakeHist.record(0);
+    }
+
+    /* pick up the latest frame (if there is a new one) */
+
+    if(frames.fetch()) {
+      frame = frames.readBuffer();
+    }
+
+    /* a new DL-32 frame?  tell the phase estimator when it arrived */
+
+    if(frame.dl32Stamp != lastStamp) {
+
+      lastStamp = frame.dl32Stamp;
+
+      estimator.arrival(frame.dl32Stamp);
+
+      phase.period = (long)(estimator.getPeriod() / 1000ULL);
+      phase.jitter = (long)(estimator.getJitter() / 1000ULL);
+    }
+
+    /*
+     * we are at the next tick, we need to send data to the
+     * Solo DL (and any other sinks), but only to the ports that are
+     * there; the SoloDL goes with the cable, a CAN sink doesn't.  If
+     * the acquisition side is busy re-opening the ports, just skip
+     * this tick.
+     *
+     */
+
+    {
+      std::unique_lock<std::mutex> ports(portLock, std::try_to_lock);
+
+      if(ports.owns_lock()) {
+
+        /* every open sink gets the same frame, each sends what's due */
+
+        bool sentOk = true;
+        int  opened = 0;
+
+        {
+          TRACE_SCOPE("sinks");
+
+          for(auto sink : sinks) {
+
+            if(!sink->isOpen()) {
+              continue;
+            }
+
+            opened++;
+
+            if(!sink->send(frame)) {
+              warning(string("sendLoop() - failed to send data to ") + sink->getName());
+              sentOk = false;
+            }
+          }
+        }
+
+        if(sentOk && (opened > 0)) {
+
+          /* data was sent, update stats */
+
+          uint64_t sent = monotonic_ns();
+
+          if(frame.stamp != 0) {
+            latencyHist.record(toMicros(sent - frame.stamp));
+          }
+
+          if(lastSent != 0) {
+            periodHist.record(toMicros(sent - lastSent));
+          }
+
+          lastSent = sent;
+
+          stats.tx++;
+
+          if((stats.tx % (60 * sendHz)) == 0) {
+
+            /* warn once a minute if the DL-32 appears to be off line */
+
+            if(stats.rx == 0) {
+              warning("sendLoop() - sending data but not receiving anything from DL-32.  Is it powered?");
+            }
+          }
+
+          /*
+           * queue the data for the data taps to let other programs
+           * monitor what we are doing.  The tap publisher does the
+           * formatting and sending; if it's behind, the frame is
+           * dropped (and counted), we never wait for it.
+           *
+           */
+
+          if((stats.tx % tapEvery) == 0) {
+            taps.push(frame);
+          }
+        }
+      }
+    }
+
+    /*
+     * schedule the next tick. If we already blew through one
+     * or more deadlines, count them as late and line up on the
+     * next deadline that is still ahead of us.
+     *
+     */
+
+    uint64_t now = monotonic_ns();
+
+    tick++;
+    deadline = started + (tick * period);
+
+    if(deadline <= now) {
+
+      uint64_t behind = ((now - deadline) / period) + 1;
+
+      stats.late += behind;
+      tick       += behind;
+      deadline    = started + (tick * period);
+
+      if(behind >= (uint64_t)sendHz) {
+        warning(string("sendLoop() - send window missed by >1s, skipped ") + to_string(behind) + " ticks.");
+      }
+    }
+
+    /*
+     * phase lock; the DL-32 sends a frame every ~85ms, on its own clock,
+     * so on the fixed cadence a fresh frame can sit for most of a tick
+     * before we send it.  If we know when the next frame is due, and
+     * it's close (within phaseMaxShift) to this tick, move this one
+     * tick to just after the frame arrives (plus phaseGuard, so the
+     * acquisition side has time to publish it).  Only this tick moves,
+     * the cadence stays anchored, so we never drift.  If the frames
+     * stop coming the estimator unlocks and we are back on the fixed
+     * cadence.
+     *
+     */
+
+    bool locked = phaseLock && estimator.locked(now);
+
+    phase.locked = locked;
+
+    if(locked) {
+
+      uint64_t target = estimator.next(deadline - phaseMaxShift - phaseGuard) + phaseGuard;
+
+      if((target != deadline) && (target <= (deadline + phaseMaxShift)) && (target > now)) {
+        deadline = target;
+        stats.shifted++;
+      }
+    }
+
+    if(!armTimer(deadline)) {
+      breakbreak = true;
+      break;
+    }
+  }
+
+  info("sendLoop() - sender has stopped.");
+}
+
+/**
+ *
+ * tapLoop() - the tap publisher thread; send each frame the sender
+ * queued out to the raw, normal and output data taps.
+ *
+ */
+
+void ECUBridge::tapLoop(void) {
+
+  TRACE_THREAD("taps");
+
+  info("tapLoop() - tap publisher is running...");
+
+  SampleFrame frame;
+
+  while(!breakbreak) {
+
+    if(!taps.pop(frame)) {
+
+      /*
+       * nothing to send; frames only show up at 10hz, so just
+       * look again shortly.  Polling keeps the sender from having
+       * to make a syscall to wake us.
+       *
+       */
+
+      usleep(10000);
+      continue;
+    }
+
+    TRACE_SCOPE("monitorData");
+
+    if(!monitorData(rawTap,    frame.raw)) {
+      warning(string("tapLoop() - failed to tap raw data: ") + getError());
+    }
+
+    if(!monitorData(normalTap, frame.normal)) {
+      warning(string("tapLoop() - failed to tap normal data: ") + getError());
+    }
+
+    if(!monitorData(outputTap, frame.output)) {
+      warning(string("tapLoop() - failed to tap output data: ") + getError());
+    }
+  }
+
+  info("tapLoop() - tap publisher has stopped.");
+}
+
+/**
+ *
+ * commandLoop() - the command worker thread; take clients off
+ * the queue, read their command, run it, and reply.
+ *
+ */
+
+void ECUBridge::commandLoop(void) {
+
+  TRACE_THREAD("commands");
+
+  info("commandLoop() - command worker is running...");
+
+  int clientFd = -1;
+
+  while(clients.pop(clientFd)) {
+
+    if(clientFd == ReloadClient) {
+
+      /* not a client, a SIGHUP reload */
+
+      string result = "";
+
+      if(reloadChannels(result)) {
+        info(string("commandLoop() - ") + result);
+      } else {
+        warning(string("commandLoop() - reload failed: ") + result);
+      }
+
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(jobLock);
+      activeClient = clientFd;
+    }
+
+    string command = "";
+
+    /* read the command, the client only gets so long to send it */
+
+    if(!cmdPort->receive(clientFd, command)) {
+
+      warning(string("commandLoop() - could not receive command: ") + cmdPort->getError());
+
+    } else {
+
+      /* do the command and send back the results */
+
+      TRACE_SCOPE("command");
+
+      command = trim(command);
+
+      string result = "END";
+      bool   ok     = false;
+
+      if(isCurveCommand(command)) {
+        ok = channelCurve(command, result);
+      } else if(isLoopCommand(command)) {
+        ok = onLoop(command, result);
+      } else {
+        ok = doCommand(command, result);
+      }
+
+      if(!ok) {
+
+        warning(string("commandLoop() - could not do command (") + command + string("): ") + getError());
+        result = "ERROR: Could not execute command.";
+      }
+
+      if(!cmdPort->send(clientFd, result)) {
+
+        warning(string("commandLoop() - could not send command (") + command + string(") results: ") + cmdPort->getError());
+      }
+    }
+
+    /* each client gets one command at a time */
+
+    {
+      std::lock_guard<std::mutex> guard(jobLock);
+      activeClient = -1;
+    }
+
+    cmdPort->drop(clientFd);
+
+    /* update stats */
+
+    stats.cmds++;
+  }
+
+  info("commandLoop() - command worker has stopped.");
+}
+
+/**
+ *
+ * isLoopCommand() - true if the given command has to be run on
+ * the acquisition thread (it uses the ChannelManager or the DL-32).
+ *
+ */
+
+bool ECUBridge::isLoopCommand(const string & command) {
+
+  vector<string> tokens;
+  explode(command, ",", tokens);
+
+  if(tokens.size() < 1) {
+    return false;
+  }
+
+  string cmd = trim(strtolower(tokens[0]));
+
+  return (cmd == "channels") || (cmd == "patch") || (cmd == "filter") || (cmd == "capture");
+}
+
+/**
+ *
+ * onLoop() - (worker thread) have the acquisition thread run the
+ * given command at the top of its next cycle, and wait for it.
+ *
+ * @param command string - the command to run.
+ *
+ * @param result string - the output of the command.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool ECUBridge::onLoop(const string & command, string & result) {
+
+  LoopJob job;
+
+  job.command      = command;
+  job.curveChannel = 0;
+
+  bool ok = onLoop(job);
+
+  result = job.result;
+
+  if(!ok) {
+    error(string("onLoop() - command failed: ") + command);
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * onLoop() - (worker thread) have the acquisition thread run the
+ * given job at the top of its next cycle, and wait for it.  If the
+ * bridge is stopping the job isn't run, job.result says why; either
+ * it never went in (job.done stays false) or it was still waiting
+ * (job.ok is false, see cancelJobs()).
+ *
+ * @param job LoopJob - the job.
+ *
+ * @return bool - exactly false if the job failed.
+ *
+ */
+
+bool ECUBridge::onLoop(LoopJob & job) {
+
+  job.result = "";
+  job.ok     = false;
+  job.done   = false;
+
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+
+    if(!jobsOpen) {
+      job.result = "ERROR: bridge is stopping.";
+      return true;
+    }
+
+    jobs.push_back(&job);
+  }
+
+  /* poke the acquisition thread */
+
+  uint64_t one = 1;
+
+  if(write(wakefd, &one, sizeof(one)) != sizeof(one)) {
+    warning(string("onLoop() - can not wake acquisition thread: ") + strerror(errno));
+  }
+
+  /* and wait for it */
+
+  std::unique_lock<std::mutex> guard(jobLock);
+
+  while(!job.done) {
+    jobDone.wait(guard);
+  }
+
+  return job.ok;
+}
+
+/**
+ *
+ * isCurveCommand() - true if the given command is "channels,curve"
+ * (see channelCurve()).
+ *
+ */
+
+bool ECUBridge::isCurveCommand(const string & command) {
+
+  vector<string> tokens;
+  explode(command, ",", tokens);
+
+  return (tokens.size() >= 2) && (trim(strtolower(tokens[0])) == "channels")
+    && (trim(strtolower(tokens[1])) == "curve");
+}
+
+/**
+ *
+ * channelCurve() - (worker thread) the "channels,curve,<chan>[,step]"
+ * command; the acquisition thread only works out the table (see
+ * ChannelManager::curve()), the checking and the (big) reply are
+ * done here, so the DL-32 isn't kept waiting.
+ *
+ * @param command string - the command.
+ *
+ * @param result string - the output of the command.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool ECUBridge::channelCurve(const string & command, string & result) {
+
+  vector<string> tokens;
+  explode(command, ",", tokens);
+
+  info(string("channelCurve() - executing: ") + command + "...");
+
+  /*
+   * the whole transfer function in one go, one line per input
+   * ("input,normal,output"), every step'th input (default 1).
+   *
+   */
+
+  int  channel = 0;
+  long step    = 1;
+
+  result = "";
+
+  if((tokens.size() < 3) || !is_numeric(tokens[2])) {
+    result = "ERROR: curve sub-command requires a channel #.";
+  } else {
+    channel = strtol(tokens[2].c_str(), NULL, 10);
+  }
+
+  if(result.empty() && ((channel < 1) || (channel > CMMaxChannels))) {
+    result = string("ERROR: curve sub-command - channel # value out of range: ") + tokens[2];
+  }
+
+  if(tokens.size() >= 4) {
+    if(!is_numeric(tokens[3]) || ((step = strtol(tokens[3].c_str(), NULL, 10)) < 1)) {
+      result = string("ERROR: curve sub-command - step must be 1 or more: ") + tokens[3];
+    }
+  }
+
+  if(!result.empty()) {
+    error(string("channelCurve() - syntax error: ") + result);
+    return true;
+  }
+
+  /* the table comes from the live channels, so the acquisition thread does that */
+
+  LoopJob job;
+
+  job.command      = command;
+  job.curveChannel = channel;
+
+  /* (sized here, so the acquisition thread doesn't allocate them) */
+
+  job.normal.resize(LookupSize);
+  job.output.resize(LookupSize);
+
+  /* (not run, or cut off by a stop: the table is just zeros, say why instead) */
+
+  if(!onLoop(job)) {
+    result = job.result;
+    error(string("channelCurve() - ") + result);
+    return true;
+  }
+
+  if(!job.done) {
+    result = job.result;
+    return true;
+  }
+
+  /* and we write it up */
+
+  char buf[64];
+
+  result.reserve((job.output.size() / (size_t)step + 1) * 24);
+
+  for(size_t x=0; x<job.output.size(); x+=step) {
+    snprintf(buf, sizeof(buf), "%u,%u,%u\n", (unsigned int)x, job.normal[x], job.output[x]);
+    result += buf;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * runJobs() - (acquisition thread) run any commands the worker
+ * has passed over to us.
+ *
+ * @return bool - exactly true if any commands were run.
+ *
+ */
+
+bool ECUBridge::runJobs(void) {
+
+  /* clear the wake up */
+
+  uint64_t count = 0;
+
+  if(read(wakefd, &count, sizeof(count)) < 0) {
+    if(errno != EAGAIN) {
+      warning(string("runJobs() - can not read wake up: ") + strerror(errno));
+    }
+  }
+
+  std::deque<LoopJob *> todo;
+
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+    todo.swap(jobs);
+  }
+
+  if(todo.empty()) {
+    return false;
+  }
+
+  for(size_t i=0; i<todo.size(); i++) {
+
+    string result = "END";
+    bool   ok     = false;
+
+    if(todo[i]->curveChannel > 0) {
+
+      /* just the table, the worker writes it up (see channelCurve()) */
+
+      ok = channelMgr->curve(todo[i]->curveChannel, todo[i]->normal, todo[i]->output);
+
+      result = ok ? string("") : (string("ERROR: curve sub-command - problem transforming: ") + channelMgr->getError());
+
+    } else {
+
+      ok = doCommand(todo[i]->command, result);
+    }
+
+    /* once its marked done the worker may throw the job away */
+
+    std::lock_guard<std::mutex> guard(jobLock);
+
+    todo[i]->result = result;
+    todo[i]->ok     = ok;
+    todo[i]->done   = true;
+  }
+
+  jobDone.notify_all();
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * cancelJobs() - (acquisition thread) we're stopping; fail any
+ * waiting commands and refuse any new ones.
+ *
+ */
+
+void ECUBridge::cancelJobs(void) {
+
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+
+    jobsOpen = false;
+
+    for(size_t i=0; i<jobs.size(); i++) {
+      jobs[i]->result = "ERROR: bridge is stopping.";
+      jobs[i]->ok     = false;
+      jobs[i]->done   = true;
+    }
+
+    jobs.clear();
+
+    /* don't let a slow client hold up the worker */
+
+    if(activeClient >= 0) {
+      shutdown(activeClient, SHUT_RDWR);
+    }
+  }
+
+  jobDone.notify_all();
+}
+
+/**
+ *
+ * reloadChannels() - (worker thread) build a new ChannelManager
+ * from a fresh read of the .ini file, check it, and leave it in
+ * freshMgr for the acquisition thread to swap in.
+ *
+ * @param result string - what happened, for the client.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool ECUBridge::reloadChannels(string & result) {
+
+  string fileName = ConfigManager::instance().configFileName();
+
+  /*
+   * a private copy of the settings, the live configuration is left
+   * alone; other parts of the bridge may be reading it.
+   *
+   */
+
+  IniFile ini(fileName);
+
+  if(!ini.isReady()) {
+    result = string("ERROR: can not read configuration: ") + fileName;
+    error(string("reloadChannels() - ") + result);
+    return false;
+  }
+
+  ChannelManager *fresh = new ChannelManager(ini);
+
+  if(!fresh->isReady()) {
+    delete fresh;
+    result = "ERROR: bad channel configuration, see the log.  Keeping the current one.";
+    error(string("reloadChannels() - ") + result);
+    return false;
+  }
+
+  /* make sure it can actually process a frame (no new samples, its streaming filters start clean) */
+
+  unsigned int raw[CMMaxChannels+1];
+  unsigned int normal[CMMaxChannels+1];
+  unsigned int output[CMMaxChannels+1];
+
+  memset(raw, 0, sizeof(raw));
+
+  if(!fresh->load(raw, normal, output, 0)) {
+    delete fresh;
+    result = "ERROR: reloaded channel configuration can not load data.  Keeping the current one.";
+    error(string("reloadChannels() - ") + result);
+    return false;
+  }
+
+  /*
+   * hand it over.  If an earlier reload is still waiting (never
+   * went live), this one replaces it.
+   *
+   */
+
+  delete freshMgr.exchange(fresh);
+
+  uint64_t one = 1;
+
+  if(write(wakefd, &one, sizeof(one)) != sizeof(one)) {
+    warning(string("reloadChannels() - can not wake acquisition thread: ") + strerror(errno));
+  }
+
+  result = "OK.  Channel configuration reloaded, live from the next frame.";
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * swapChannels() - (acquisition thread) if there is a reloaded
+ * ChannelManager waiting, make it the live one and throw away the
+ * old one.
+ *
+ * @return bool - exactly true if we swapped.
+ *
+ */
+
+bool ECUBridge::swapChannels(void) {
+
+  ChannelManager *fresh = freshMgr.exchange(NULL);
+
+  if(fresh == NULL) {
+    return false;
+  }
+
+  /*
+   * we're between loads, and this thread is the only one that uses
+   * the ChannelManager (commands that touch it run here too, see
+   * onLoop()); the sender only ever sees copies of the frames it
+   * made.  So once we've switched, nobody can still be using the
+   * old one and it can go right away.
+   *
+   */
+
+  ChannelManager *stale = channelMgr;
+
+  channelMgr = fresh;
+
+  delete stale;
+
+  info("swapChannels() - reloaded channel configuration is live.");
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * requestReload() - ask for the channel configuration to be
+ * reloaded (same as the "reload" command).  Only sets a flag and
+ * pokes the acquisition thread, so its safe from a signal handler.
+ *
+ */
+
+void ECUBridge::requestReload(void) {
+
+  reloadPending = true;
+
+  int fd = wakefd;
+
+  if(fd >= 0) {
+
+    uint64_t one = 1;
+
+    if(write(fd, &one, sizeof(one)) < 0) {
+
+      /* nothing we can do here, we'll notice within a second anyway */
+    }
+  }
+}
+
+/**
+ *
+ * loop() - this is the main processing loop, we pass
+ * data from the DL-32 over to the SoloDL and do any
+ * of the in between stuff as we go.
+ *
+ */
+
+bool ECUBridge::loop(void) {
+
+  if(!isReady()) {
+    error("loop() - can't run, bridge is not configured.");
+    return false;
+  }
+
+  if(running) {
+    error("loop() - we are already running!");
+    return false;
+  }
+
+  info("loop() - ready to run..");
+
+  /*
+   * main loop! Basically our job is to wait for DL-32
    * data to arrive (every 86-89ms), and regardless, every
    * 100ms (10hz) we have to send whatever we haver to
-   * the SolODL.  Given the mis-match in frequencies and
+   * the SolODL (the sender ticks faster than that, so it
+   * can spread the channels out over the 100ms).  Given the mis-match in frequencies and
    * that we don't have any synchronization between the
    * devices...we just keep a "current value" and when
    * we get DL-32 data, we set the current value.  When
-   * we need to send to the Solo DL, we send the current
-   * value.  No fancy buffering.
+   * we need to send to the Solo DL, the sender thread
+   * sends the current value.  No fancy buffering.
    *
    * The sampling rate of 2, 5 or 10hz (depending on the
    * channel) means even we get a sample wrong...a better
@@ -892,32 +2211,75 @@ bool ECUBridge::loop(void) {
    *
    */
 
-  /* setup for selecting (event watching */
+  /*
+   * setup for event watching, we use epoll so we don't have to
+   * rebuild descriptor sets every time around, and a monotonic
+   * timerfd for the sender's SoloDL send tick.
+   *
+   */
+
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+
+  if(epfd < 0) {
+    error(string("loop() - can not create epoll set: ") + strerror(errno));
+    return false;
+  }
+
+  timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+  if(timerfd < 0) {
+    error(string("loop() - can not create send timer: ") + strerror(errno));
+    close(epfd);
+    epfd = -1;
+    return false;
+  }
+
+  /* the command worker pokes this when it has work for us */
+
+  wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+  if(wakefd < 0) {
+    error(string("loop() - can not create wake up event: ") + strerror(errno));
+    close(timerfd);
+    close(epfd);
+    timerfd = -1;
+    epfd    = -1;
+    return false;
+  }
+
+  bool ok = watch(cmdPort->getHandle()) && watch(cable->getHandle()) && watch(wakefd);
 
-  int maxfd = 0;
+  if(ok && (dl32 != NULL)) {
+    ok = watch(dl32->getHandle(), true);
+  }
+
+  if(ok && (canInput != NULL)) {
+    ok = watch(canInput->getHandle());
+  }
 
-  fd_set readfds;
-  fd_set writefds;
-  fd_set exceptfds;
+  if(!ok) {
+    error("loop() - can not setup event watching.");
+    close(wakefd);
+    close(timerfd);
+    close(epfd);
+    wakefd  = -1;
+    timerfd = -1;
+    epfd    = -1;
+    return false;
+  }
 
   /*
-   * setup the "current value" essentially the vectors of raw, processed (normal) and
-   * and output data.
+   * setup the "current value" of the raw data, the normal and output
+   * data are produced from it each time it changes, and handed over
+   * to the sender.
    *
    */
 
   unsigned int rawData[SoloDLChannelMax+1];
-  unsigned int normalData[SoloDLChannelMax+1];
-  unsigned int outputData[SoloDLChannelMax+1];
-
-  {
-    for(int zz=0; zz<=SoloDLChannelMax; zz++) {
+  uint64_t     rawStamp  = 0;
+  uint64_t     dataStamp = 0;
 
-      rawData[zz]    = 0;
-      normalData[zz] = 0;
-      outputData[zz] = 0;
-    }
-  }
+  memset(rawData, 0, sizeof(rawData));
 
   /* reset stats to 0 */
 
@@ -925,184 +2287,184 @@ bool ECUBridge::loop(void) {
   stats.tx     = 0;
   stats.cmds   = 0;
   stats.uptime = 0;
+  stats.late   = 0;
+  stats.busy   = 0;
+  stats.shifted = 0;
+  stats.reads   = 0;
+  stats.resyncs = 0;
+  stats.skipped = 0;
 
-  /*
-   * setup for timing, we need to track up time, and we need to have a regular
-   * cycle of 100ms, regardless of having data from the DL-32 or not.
-   *
-   */
+  latencyHist.reset();
+  periodHist.reset();
+  wakeHist.reset();
 
-  struct timeval     selectTimeout;
-  time_t started   = time(NULL);
-  time_t checkTime = started;
-
-  timeval tv1;
-  timeval tv2;
-  timeval tv3;
-  timeval tv4;
-  timeval perf1;
-  timeval perf2;
-  timeval perf3;
-  timeval result;
-  timeval lastDL32;
-  timeval lastSoloDL;
-  timeval startDL32;
-  timeval startSoloDL;
-
-  float   cycleTime = 0.0;
-
-  if(gettimeofday(&tv1, NULL) != 0) {
-    error("loop() - can't get time of day.");
-    return false;
-  }
-  lastDL32   = tv1;
-  lastSoloDL = tv1;
+  const uint64_t started = monotonic_ns();
+
+  /* make sure the sender has something to send right away */
+
+  publishFrame(rawData, dataStamp, rawStamp, 0);
 
-  selectTimeout.tv_sec  = 0;
-  selectTimeout.tv_usec = 10 * 1000; /* 100ms (10hz) timeouts */
+  /* keep the sender from ever page faulting if asked to */
+
+  if(lockMemory) {
+
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      warning(string("loop() - can not lock memory: ") + strerror(errno));
+    } else {
+      info("loop() - memory is locked.");
+    }
+  }
 
   /* ok, we are good to go */
 
   info("loop() - entering event loop...");
 
-  running = true;
+  TRACE_THREAD("acquisition");
 
-  long delta                = 0;
-  long prevDelta            = 0;
-  long workTime             = 0;
-  long prevWorkTime         = 0;
-  long sleepFor             = 0;
-  long prevSleepFor         = 0;
+  running    = true;
+  breakbreak = false;
 
-  bool debugTiming = false;
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+    jobsOpen = true;
+  }
 
-  /*
-   * loop until we tell ourselves to stop.  We do what we can to keep
-   * things in sync for our 100ms window on sending to the SoloDL, but
-   * because we are all in one thread, there are going to be cases
-   * where we miss the mark. When we come out of a select() if we are
-   * close but not at the timeout and the DL-32 is ready...we'll do
-   * that work, andn possible be over the mark...if say the DL-32
-   * reading time was more than the remaining time to the next send
-   * mark.
-   *
-   * We can't do much about that without a lot more complexity; using
-   * threads, hardware interrupts etc.  Given that those boundary conditions
-   * happen infrequently, and the SoloDL doesn't seem bothered by it...
-   * we use it as is.
-   *
-   * If we ever need to be super precise though, we should move to a
-   * a threaded model or even use separate processes for reading / writing;
-   * and then have a shared memory chunk between the two so that the
-   * DL-32 can contribute its data (via semaphore), and let the kernel
-   * handle slicing the processes (effectively doing threading for us).
-   *
-   * For now its a single thread / loop and is deemed accruate enough.
-   *
-   */
+  clients.open();
 
-  while(!breakbreak) {
+  taps.reset();
 
-    /*
-     * track the cycle time in ms, to make sure we are hitting
-     * our 100ms mark.
-     *
-     */
+  std::thread sender;
+  std::thread worker;
+  std::thread tapper;
 
-    tv3 = tv1;
+  try {
 
-    if(gettimeofday(&tv1, NULL) != 0) {
-      error("loop() - can't get time of day.");
-      running = false;
-      return false;
-    }
+    sender = std::thread(&ECUBridge::sendLoop, this);
+    tapper = std::thread(&ECUBridge::tapLoop, this);
+    worker = std::thread(&ECUBridge::commandLoop, this);
 
-    /* wait for something to happen */
+  } catch(const std::system_error & e) {
 
-    FD_ZERO(&readfds);
-    FD_ZERO(&writefds);
-    FD_ZERO(&exceptfds);
-    maxfd = 0;
+    error(string("loop() - can not start sender/tap/command threads: ") + e.what());
 
-    if(dl32 != NULL) {
+    breakbreak = true;
 
-      int h = dl32->getHandle();
+    if(sender.joinable()) {
+      sender.join();
+    }
 
-      FD_SET(h, &readfds);
-      if(h >= maxfd) {
-        maxfd = h;
-      }
+    if(tapper.joinable()) {
+      tapper.join();
     }
 
-    if(cmdPort != NULL) {
+    close(wakefd);
+    close(timerfd);
+    close(epfd);
+    wakefd  = -1;
+    timerfd = -1;
+    epfd    = -1;
+    running = false;
 
-      int h = cmdPort->getHandle();
+    return false;
+  }
 
-      FD_SET(h, &readfds);
-      if(h >= maxfd) {
-        maxfd = h;
-      }
-    }
+  /*
+   * loop until we tell ourselves to stop.  The acquisition side
+   * only has to keep the "current value" up to date; it never has
+   * to worry about the SoloDL send window, so we can take as long
+   * as we need for a DL-32 read or a command.
+   *
+   */
 
-    if(cable != NULL) {
+  struct epoll_event events[8];
+  bool clean = true;
 
-      int h = cable->getHandle();
+  while(!breakbreak) {
 
-      FD_SET(h, &readfds);
-      if(h >= maxfd) {
-        maxfd = h;
-      }
-    }
+    /* wake up at least once a second so we notice a stop request */
 
-    maxfd++;
+    int n = 0;
 
-    long waitTime   = selectTimeout.tv_usec;
-    long actualWait = waitTime;
-    long winRemain  = 0;
+    {
+      TRACE_SCOPE("epoll wait");
 
-    gettimeofday(&perf1, NULL);
+      n = epoll_wait(epfd, events, 8, 1000);
+    }
 
-    if(selectTimeout.tv_usec < 1000) {
+    if(n < 0) {
 
-      /*
-       * if we are waiting for < 1ms, try to get more precise by
-       * using nanosleep() for the delay, and the select only
-       * for the file descriptor test.
-       *
-       */
+      if(errno == EINTR) {
 
-      struct timespec req;
-      req.tv_sec  = 0;
-      req.tv_nsec = selectTimeout.tv_usec * 1000;
+        /* a signal (SIGHUP etc.) interrupted us */
 
-      nanosleep(&req, NULL);
+        continue;
+      }
 
-      selectTimeout.tv_sec  = 0;
-      selectTimeout.tv_usec = 0;
+      error(string("loop() - epoll error: ") + strerror(errno));
+      clean = false;
+      break;
     }
 
-    int status = select(maxfd, &readfds, NULL, NULL, &selectTimeout);
-
-    gettimeofday(&perf2, NULL);
-
-    timersub(&perf2, &perf1, &result);
-    actualWait = result.tv_usec;
+    /* what happened? */
 
-    if(debugTiming) {
-      info(string("X: req. wait: ") + to_string(waitTime) + string(" act. wait: ") + to_string(actualWait));
+    bool usbReady   = false;
+    bool dl32Ready  = false;
+    bool canReady   = false;
+    bool cmdReady   = false;
+    bool jobReady   = false;
+
+    for(int i=0; i<n; i++) {
+
+      int fd = events[i].data.fd;
+
+      if(fd == cable->getHandle()) {
+        usbReady  = true;
+      } else if(fd == cmdPort->getHandle()) {
+        cmdReady  = true;
+      } else if(fd == wakefd) {
+        jobReady  = true;
+      } else if((dl32 != NULL) && (fd == dl32->getHandle())) {
+        dl32Ready = true;
+      } else if((canInput != NULL) && (fd == canInput->getHandle())) {
+        canReady  = true;
+      }
     }
 
     /* - - - - start of work block - - - - - - */
 
-    /* what happened? */
+    /*
+     * safe point; between loads, so this is where commands that change
+     * the ChannelManager are applied.  Re-publish the current value
+     * through the (possibly) new mapping.
+     *
+     */
 
-    if(status < 0) {
+    if(jobReady) {
 
-      error(string("loop() - select error: ") + strerror(errno));
-      error(string("loop() - maxfd: ") + to_string(maxfd) + string(" wait: ") + to_string(waitTime));
-      running = false;
-      return false;
+      TRACE_SCOPE("command");
+
+      bool changed = runJobs();
 
+      if(swapChannels()) {
+        changed = true;
+      }
+
+      if(changed) {
+        publishFrame(rawData, dataStamp, rawStamp, 0);
+      }
+    }
+
+    /*
+     * SIGHUP; the reload is slow (it reads the .ini file) so the
+     * command worker does it.  If its backed up, try again next time
+     * around.
+     *
+     */
+
+    if(reloadPending.exchange(false)) {
+      if(!clients.push(ReloadClient)) {
+        reloadPending = true;
+      }
     }
 
     /*
@@ -1111,7 +2473,9 @@ bool ECUBridge::loop(void) {
      *
      */
 
-    if(FD_ISSET(cable->getHandle(), &readfds)) {
+    if(usbReady) {
+
+      TRACE_SCOPE("usb event");
 
       /*
        * the call to getEvent() will force a cable re-scan,
@@ -1165,6 +2529,10 @@ bool ECUBridge::loop(void) {
 
       if(oldStatus != newStatus) {
 
+        /* keep the sender off the ports while we swap them */
+
+        std::lock_guard<std::mutex> ports(portLock);
+
         if(newStatus) {
 
           info("loop() - USB cable is connected!!");
@@ -1173,8 +2541,8 @@ bool ECUBridge::loop(void) {
 
           if(!portMapper->configure()) {
             error(string("loop() - can not reconfigure port mapper: ") + portMapper->getError());
-            running = false;
-            return false;
+            clean = false;
+            break;
           }
           info("portmapper.");
 
@@ -1185,44 +2553,37 @@ bool ECUBridge::loop(void) {
 
             if(device.empty()) {
               error("loop() - can not find DL-32 device.");
-              running = false;
-              return false;
+              clean = false;
+              break;
             }
 
             /* open it */
 
-            dl32 = new DL32Port(device);
+            dl32 = new DL32Port(device, true);
 
             if(!dl32->isReady()) {
               error(string("loop() - can not open DL-32: ") + dl32->getError());
-              running = false;
-              return false;
+              clean = false;
+              break;
             }
-          }
-          info("dl32.");
-
-          /* setup the SoloDL port */
 
-          {
-            string device = portMapper->getDevice(Device::SOLODL);
-
-            if(device.empty()) {
-              error("loop() - can not find Solo DL device.");
-              running = false;
-              return false;
+            if(!watch(dl32->getHandle(), true)) {
+              clean = false;
+              break;
             }
+          }
+          info("dl32.");
 
-            /* open it */
-
-            solodl = new SoloDLPort(device);
+          /* setup the SoloDL port and any other sinks */
 
-            if(!solodl->isReady()) {
-              error(string("loop() - can not open Solo DL: ") + dl32->getError());
-              running = false;
-              return false;
-            }
+          if(!openSinks(true)) {
+            error("loop() - can not open Solo DL.");
+            clean = false;
+            break;
           }
-          info("solodl.");
+          info("output sinks.");
+          noteSerial();
+
           info("loop() - DL-32/SoloDL ports have re-connected.");
 
         } else {
@@ -1231,11 +2592,18 @@ bool ECUBridge::loop(void) {
 
           /* we to remove the ports they aren't usable now. */
 
+          if(dl32 != NULL) {
+            unwatch(dl32->getHandle());
+          }
+
           delete dl32;
           dl32 = NULL;
 
-          delete solodl;
-          solodl = NULL;
+          closeSinks();
+
+          dl32Ready = false;
+
+          noteSerial();
 
           info("loop() - DL-32/SoloDL ports have been closed.");
         }
@@ -1243,151 +2611,96 @@ bool ECUBridge::loop(void) {
     }
 
     /*
-     * we have to send out to the Solo DL every 100ms (10hz),
-     * but only if the USB cable is actually connected.
+     * if the DL-32 is ready with data, we grab it and hand
+     * it over to the sender.  But only if the USB cable is
+     * connected.
      *
      */
 
-    bool doSend = false;
-
-    timersub(&perf2, &lastSoloDL, &result);
-    winRemain = 100.0 - (result.tv_usec / 1000.0);
-
-    if(debugTiming) {
-      info(string("X: time to send: ") + to_string(winRemain));
-    }
-    if(winRemain <= 1.0 ) {
-
-      /* less than a milisecond away, send it now. */
-
-      doSend = true;
-
-    } else if((winRemain <= 3.0) && (cable->isConnected()) && (FD_ISSET(dl32->getHandle(), &readfds))) {
+    if(dl32Ready && (cable->isConnected() || portMapper->isFixed(Device::DL32))) {
 
       /*
-       * we are likely going to suck up as much or more time reading from DL-32 than we
-       * actually have until we should be sending...so just send now, its a little early
-       * but better than missing our window.
+       * take whatever bytes are there and get right back to the loop;
+       * if a packet is only part way in we keep it for next time, and
+       * the sender just keeps sending the last value on schedule.
        *
        */
 
-      if(debugTiming) {
+      bool readOk = false;
+      bool fresh  = false;
+
+      {
+        TRACE_SCOPE("dl32 read");
 
-        info("X: sending early.");
-        doSend = true;
+        readOk = dl32->pollSamples(rawData, fresh, &rawStamp);
       }
-    }
 
-    if(doSend) {
+      stats.reads   = (long)dl32->getReads();
+      stats.resyncs = (long)dl32->getParser().getResyncs();
+      stats.skipped = (long)dl32->getParser().getSkipped();
+
+      if(!readOk) {
 
-      gettimeofday(&startSoloDL, NULL);
+        warning(string("loop() - failed to read samples correctly from DL-32:") + dl32->getError());
 
-      if(cable->isConnected()) {
+      } else if(fresh) {
 
         /*
-         * we timed out, we are at the 100ms mark, we need to send
-         * data to the Solo DL
+         * we have sample data, set the "current value".  If more than
+         * one packet came in, each one goes through in turn so the
+         * streaming filters see every sample; the newest ends up as
+         * the current value.
          *
          */
 
-        if(!channelMgr->load(rawData, normalData, outputData)) {
-
-          warning(string("loop() - failed to load data: ") + channelMgr->getError());
-
-        } else {
-
-          /* send it */
-
-          if(!solodl->writeSamples(outputData)) {
-
-            warning(string("loop() - failed to send data: ") + solodl->getError());
-
-          } else {
-
-            /* data was sent, update stats */
-
-            stats.tx++;
+        const unsigned int dl32Fresh = (1u << (DL32ChannelMax+1)) - 2;
 
-            if((stats.tx % 600) == 0) {
+        do {
 
-              /* warn once a minute if the DL-32 appears to be off line */
-
-              if(stats.rx == 0) {
-                warning("loop() - sending to SoloDL but not receiving anything from DL-32.  Is it powered?");
-              }
-            }
-
-            /*
-             * send the data out to the data taps to let other
-             * programs monitor what we are doing.
-             *
-             */
-
-            if(!monitorData(rawTap,    rawData)) {
-              warning(string("loop() - failed to tap raw data: ") + getError());
-            }
+          stats.rx++;
 
-            if(!monitorData(normalTap, normalData)) {
-              warning(string("loop() - failed to tap normal data: ") + getError());
-            }
+          dataStamp = rawStamp;
 
-            if(!monitorData(outputTap, outputData)) {
-              warning(string("loop() - failed to tap output data: ") + getError());
-            }
+          if(!publishFrame(rawData, dataStamp, rawStamp, dl32Fresh)) {
+            warning(string("loop() - failed to publish frame: ") + getError());
           }
-        }
-      }
-
-      gettimeofday(&lastSoloDL, NULL);
-
-      if(debugTiming) {
 
-        info(string("X: Solo DL cycle: ") + to_string(100.0 - winRemain));
-
-        timersub(&lastSoloDL, &startSoloDL, &result);
-
-        info(string("X: Solo DL work time: ") + to_string(result.tv_usec / 1000.0));
+        } while(dl32->nextSamples(rawData, &rawStamp));
       }
-
     }
 
     /*
-     * if the DL-32 is ready with data, we grab it.  But
-     * only if the USB cable is connected.
+     * CAN channels go in the same "current value" as the DL-32's.  The
+     * frame is stamped with when the CAN frames were read, so the
+     * latency is the CAN data's own; the DL-32's stamp goes along
+     * separately, so the sender's phase lock stays with the DL-32 no
+     * matter how often the CAN values change.
      *
      */
 
-    if(cable->isConnected()) {
-
-      if(FD_ISSET(dl32->getHandle(), &readfds)) {
+    if(canReady) {
 
-        gettimeofday(&startDL32, NULL);
+      bool         readOk   = false;
+      bool         fresh    = false;
+      unsigned int canFresh = 0;
+      uint64_t     canStamp = 0;
 
-        timersub(&startDL32, &lastDL32, &result);
-        long sinceDL32 = result.tv_usec / 1000.0;
+      {
+        TRACE_SCOPE("can read");
 
-        /* we have sample data, set the "current value" */
-
-        if(!dl32->readSamples(rawData)) {
-
-          warning(string("loop() - failed to read samples correctly from DL-32:") + dl32->getError());
-
-        } else {
-
-          /* update stats */
-
-          stats.rx++;
-        }
+        readOk = canInput->pollSamples(rawData, fresh, &canFresh, &canStamp);
+      }
 
-        gettimeofday(&lastDL32, NULL);
+      if(!readOk) {
 
-        if(debugTiming) {
+        warning(string("loop() - failed to read CAN input: ") + canInput->getError());
 
-          info(string("X: DL-32 cycle: ") + to_string(sinceDL32));
+      } else if(fresh) {
 
-          timersub(&lastDL32, &startDL32, &result);
+        dataStamp = canStamp;
 
-          info(string("X: DL-32 work time: ") + to_string(result.tv_usec / 1000.0));
+        if(!publishFrame(rawData, dataStamp, rawStamp, canFresh)) {
+          warning(string("loop() - failed to publish frame: ") + getError());
         }
       }
     }
@@ -1398,160 +2711,79 @@ bool ECUBridge::loop(void) {
      *
      */
 
-    if(FD_ISSET(cmdPort->getHandle(), &readfds)) {
-
-      /* we have a client trying to do a command */
-
-      if(!cmdPort->accept()) {
-
-        warning(string("loop() - could not accept client command: ") + cmdPort->getError());
-
-      } else {
-
-        string command = "";
+    if(cmdReady) {
 
-        /* read the command */
-
-        if(!cmdPort->receive(command)) {
-
-          warning(string("loop() - could not receive command: ") + cmdPort->getError());
-
-        } else {
-
-          /* do the command and send back the results */
-
-          command = trim(command);
+      /*
+       * we have a client trying to do a command, we only accept it
+       * here, the command worker does the talking.  If the worker is
+       * backed up, tell the client right away rather than letting
+       * them pile up.
+       *
+       */
 
-          string result = "END";
+      int clientFd = -1;
 
-          if(!doCommand(command, result)) {
+      if(!cmdPort->accept(clientFd)) {
 
-            warning(string("loop() - could not do command (") + command + string("): ") + getError());
-            result = "ERROR: Could not execute command.";
-          }
+        warning(string("loop() - could not accept client command: ") + cmdPort->getError());
 
-          if(!cmdPort->send(result)) {
+      } else if(!clients.push(clientFd)) {
 
-            warning(string("loop() - could not send command (") + command + string(") results: ") + cmdPort->getError());
-          }
-        }
+        stats.busy++;
 
-        /* each client gets one command at a time (we only have 100ms to work with) */
+        warning("loop() - command worker is busy, turning client away.");
 
-        cmdPort->drop();
+        cmdPort->send(clientFd, "ERROR: busy, try again.");
+        cmdPort->drop(clientFd);
       }
-
-      /* update stats */
-
-      stats.cmds++;
     }
 
-    gettimeofday(&perf3, NULL);
-
     /* - - - - end of work block - - - - - - */
 
-    /*
-     * we did some work, now figure out how to set our timeout
-     * so we hit the next 100ms mark.
-     *
-     */
-
-    checkTime = time(NULL);
-
-    stats.uptime = checkTime - started;
+    stats.uptime = (monotonic_ns() - started) / 1000000000ULL;
+  }
 
-    if(gettimeofday(&tv2, NULL) != 0) {
-      error("can't get time of day.");
-      return false;
-    }
+  /* stop the sender and command worker, and tear down event watching */
 
-    /*
-     * regardless of when commands arrive or when DL-32 data
-     * arrives, we have to be sending data to the SoloDL every
-     * 100ms (10hz).  So we must be relative to lastSoloDL,
-     * we want to be waking up again no more than 100ms after
-     * lastSoloDL.  If we wake up for other reasons (before
-     * then), DL-32 or commands...then re-calculate the remainder
-     * of wait time for that 100ms cycle.
-     *
-     */
+  breakbreak = true;
 
-    prevDelta     = delta;
+  clients.close();
 
-    timersub(&tv2, &lastSoloDL, &result);
+  cancelJobs();
 
-    delta         = result.tv_usec;
+  worker.join();
+  sender.join();
+  tapper.join();
 
-    long cycle    = 100 * 1000;
-    prevSleepFor  = sleepFor;
-    sleepFor      = cycle - delta;
+  /* anybody still waiting in line just gets dropped */
 
-    if(true) {
+  int clientFd = -1;
 
-      /*
-       * try to make a fine grained adjustment; we may end up
-       * arriving late (sleeping too long) or being swapped
-       * out etc.   So don't actually wait the full time we
-       * want to; if the sleep time is more than 1ms, then we
-       * take off 1ms.  We hope to trade more calls to select()
-       * for a chance to zero in on our target window size.
-       *
-       * For actual precise timing; standard Linux doesn't do
-       * precise; it only does things with +/- 1ms of precision,
-       * and anyways if you call a system call (like say select())
-       * then you are yielding, and you may not get control back
-       * when you think...it may be sooner or later depending on
-       * what else is going on with other programs, interrupts
-       * etc.
-       *
-       * To actually be precise with our send window, we would have
-       * to move to using hardware timers.  We probably don't need
-       * that though, as long as we are reasonably close to sending
-       * stuff to the Solo DL at 10Hz. we should be ok.
-       *
-       *
-       */
+  while(clients.tryPop(clientFd)) {
 
-      if(sleepFor >= 1000) {
-        sleepFor -= 1000;
-      }
+    if(clientFd == ReloadClient) {
+      continue;
     }
 
-    if(sleepFor < 0) {
-
-      /*
-       * we are running late, we don't expect to have anything better than about
-       * 1ms resolution, and we expect to be late some times becuase we have both
-       * read and write jammed into the same thread, but if things look really late,
-       * take note.
-       *
-       */
-
-      if(((delta/1000.0)-100.0) >= 10.0) {
-        warning(string("loop() - send window too big (>100ms): ") + to_string(delta/1000.0) + "ms.");
-      }
-
-      sleepFor = 0;
-
-    } else if(sleepFor > cycle) {
-
-      warning(string("loop() - trying to sleep too long (>100ms): ") + to_string(sleepFor));
+    cmdPort->send(clientFd, "ERROR: bridge is stopping.");
+    cmdPort->drop(clientFd);
+  }
 
-      sleepFor = cycle;
-    }
+  /* a reload nobody picked up */
 
-    if(debugTiming) {
-      info(string("X: delta: ") + to_string(delta) + string(" sleep: ") + to_string(sleepFor));
-    }
+  delete freshMgr.exchange(NULL);
 
-    selectTimeout.tv_sec  = 0;
-    selectTimeout.tv_usec = sleepFor;
+  close(wakefd);
+  close(timerfd);
+  close(epfd);
 
-  }
+  wakefd  = -1;
+  timerfd = -1;
+  epfd    = -1;
 
   running = false;
 
-  return true;
+  return clean;
 }
 
 /* standard destructor */
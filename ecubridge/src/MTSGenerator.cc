@@ -0,0 +1,176 @@
+#include "MTSGenerator.hh"
+
+#include <math.h>
+
+/**
+ *
+ * configure() - set what the packets carry.
+ *
+ * @param n int - # of aux channels, 1..MTSMaxChannels (the bridge
+ * only uses the first DL32ChannelMax).
+ *
+ * @param wave MTSWaveform - the shape the values follow.
+ *
+ * @param seconds double - how long one cycle of the wave takes.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool MTSGenerator::configure(int n, MTSWaveform wave, double seconds) {
+
+  if((n < 1) || (n > MTSMaxChannels)) {
+    error(string("configure() - channels must be 1..") + to_string((int)MTSMaxChannels));
+    return false;
+  }
+
+  if(seconds <= 0.0) {
+    error("configure() - the waveform period must be more than 0.");
+    return false;
+  }
+
+  channels = n;
+  waveform = wave;
+  period   = seconds;
+
+  memset(values, 0, sizeof(values));
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * setFaults() - the chance (0..1) of each kind of damage being
+ * done to a packet.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool MTSGenerator::setFaults(double truncate, double badHeader, double subPacket) {
+
+  if((truncate < 0.0) || (truncate > 1.0) || (badHeader < 0.0) || (badHeader > 1.0) ||
+     (subPacket < 0.0) || (subPacket > 1.0)) {
+    error("setFaults() - fault chances must be 0..1");
+    return false;
+  }
+
+  truncateChance  = truncate;
+  badHeaderChance = badHeader;
+  subPacketChance = subPacket;
+
+  /* all done */
+
+  return true;
+}
+
+/* xorshift32, quick and repeatable */
+
+uint32_t MTSGenerator::random(void) {
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+
+  return state;
+}
+
+/**
+ *
+ * sample() - (packet() helper) a channel's value at time t, each
+ * channel is a little further along the wave than the one before.
+ *
+ */
+
+unsigned int MTSGenerator::sample(int chan, double t) {
+
+  double phase = fmod((t / period) + ((double)(chan - 1) / (double)channels), 1.0);
+
+  switch(waveform) {
+
+    case MTSWaveform::RAMP:
+      return (unsigned int)(phase * 1023.0);
+
+    case MTSWaveform::SINE:
+      return (unsigned int)(511.5 + (511.5 * sin(2.0 * M_PI * phase)));
+
+    case MTSWaveform::NOISE:
+      return random() & 0x3FF;
+  }
+
+  return 0;
+}
+
+/**
+ *
+ * packet() - build the next packet.
+ *
+ * @param buf unsigned char array - where to put it, at least
+ * MTSMaxPacket bytes.
+ *
+ * @param t double - the time (seconds) the values are sampled at.
+ *
+ * @return size_t - the # of bytes in the packet.
+ *
+ */
+
+size_t MTSGenerator::packet(unsigned char *buf, double t) {
+
+  /* a sub-packet goes in before this channel (0 for none) */
+
+  int subAt = 0;
+
+  if((subPacketChance > 0.0) && (chance() < subPacketChance)) {
+    subAt = 1 + (int)(random() % (uint32_t)channels);
+    subPackets++;
+  }
+
+  int words = channels + (subAt > 0 ? 1 : 0);
+
+  /* header - 1010 001L  1LLL LLLL */
+
+  size_t n = 0;
+
+  buf[n++] = 0xA2 | ((words >> 7) & 0x01);
+  buf[n++] = 0x80 | (words & 0x7F);
+
+  for(int chan=1; chan<=channels; chan++) {
+
+    if(chan == subAt) {
+
+      /* LM-1 words start 1..., LC-1 words start 01.. */
+
+      if(random() & 1) {
+        buf[n++] = 0x80 | (random() & 0x7F);
+      } else {
+        buf[n++] = 0x40 | (random() & 0x3F);
+      }
+      buf[n++] = random() & 0x7F;
+    }
+
+    /* aux words - 0000 0DDD  0DDD DDDD (10 bits of value) */
+
+    values[chan] = sample(chan, t);
+
+    buf[n++] = (values[chan] >> 7) & 0x07;
+    buf[n++] = values[chan] & 0x7F;
+  }
+
+  /* and now the damage */
+
+  if((badHeaderChance > 0.0) && (chance() < badHeaderChance)) {
+    buf[0] &= 0x7F;
+    badHeaders++;
+  }
+
+  if((truncateChance > 0.0) && (chance() < truncateChance)) {
+    n = 2 + (random() % (uint32_t)(n - 2));
+    truncated++;
+  }
+
+  packets++;
+
+  return n;
+}
@@ -0,0 +1,94 @@
+#include "OutputSink.hh"
+#include "ConfigManager.hh"
+
+/**
+ *
+ * configureRate() - (configure() helper) read rate_hz from the
+ * sink's section, 1..hz.
+ *
+ * @param hz int - the sender's tick rate.
+ *
+ * @param defaultHz int - if rate_hz isn't set.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool OutputSink::configureRate(int hz, int defaultHz) {
+
+  IniFile & ini = ConfigManager::instance();
+
+  rateHz = defaultHz;
+
+  string tmp = trim(ini.getValue(name, "rate_hz"));
+
+  if(!tmp.empty()) {
+
+    if(!is_numeric(tmp)) {
+      error(string("configure() - [") + name + string("] rate_hz must be a number: ") + tmp);
+      return false;
+    }
+
+    rateHz = (int)strtol(tmp.c_str(), NULL, 10);
+  }
+
+  if((rateHz < 1) || (rateHz > hz)) {
+    error(string("configure() - [") + name + string("] rate_hz must be 1..") + to_string(hz));
+    return false;
+  }
+
+  tickHz = hz;
+  tick   = 0;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * due() - (send() helper) count a tick, true if a frame is due on
+ * it; rateHz frames every tickHz ticks, as evenly as they'll go.
+ *
+ */
+
+bool OutputSink::due(void) {
+
+  if((tickHz == 0) || (rateHz == 0)) {
+    return false;
+  }
+
+  /* we're due whenever tick * rate / tickHz clicks over */
+
+  unsigned long before = (tick * rateHz) / tickHz;
+
+  tick++;
+
+  bool isDue = ((tick * rateHz) / tickHz) != before;
+
+  if(tick >= (unsigned long)tickHz) {
+    tick = 0;
+  }
+
+  return isDue;
+}
+
+/**
+ *
+ * describe() - status lines for the "status" command, one per line
+ * (each ending in a new line).
+ *
+ */
+
+string OutputSink::describe(void) {
+
+  string info;
+
+  {
+    std::lock_guard<std::mutex> guard(infoLock);
+    info = portInfo;
+  }
+
+  return name + string(": ") + to_string(sent) + string(" sent, ") + to_string(failed)
+    + string(" failed; port ") + info + string("\n");
+}
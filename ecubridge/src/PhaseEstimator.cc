@@ -0,0 +1,133 @@
+#include "PhaseEstimator.hh"
+
+#include <math.h>
+
+/*
+ * filter gains; alpha is how much of a prediction error goes into
+ * the phase, beta how much goes into the period.  Small, because
+ * the DL-32 clock is steady and its the jitter we want to ignore.
+ *
+ */
+
+static const double PhaseAlpha  = 0.25;
+static const double PhaseBeta   = 0.05;
+static const double JitterGain  = 0.10;
+
+/* frames we want to see before we trust the prediction */
+
+static const unsigned long PhaseMinFrames = 4;
+
+/**
+ *
+ * arrival() - tell the estimator a frame arrived.  The same stamp
+ * given again (the same frame re-published) is ignored.
+ *
+ * @param stamp uint64_t - when the frame arrived.
+ *
+ */
+
+void PhaseEstimator::arrival(uint64_t stamp) {
+
+  if((stamp == 0) || (stamp <= last)) {
+    return;
+  }
+
+  if(frames == 0) {
+
+    /* first frame, just a phase to start from */
+
+    ref    = (double)stamp;
+    last   = stamp;
+    frames = 1;
+
+    return;
+  }
+
+  if(period <= 0.0) {
+
+    /* second frame, our first guess at the period */
+
+    period = (double)(stamp - last);
+    ref    = (double)stamp;
+    last   = stamp;
+    frames = 2;
+
+    return;
+  }
+
+  /*
+   * how many periods since the reference?  Normally 1, but if frames
+   * were missed (or we just didn't see them) its more.  A long silence
+   * means we've lost track, start over.
+   *
+   */
+
+  double elapsed = (double)stamp - ref;
+  double n       = floor((elapsed / period) + 0.5);
+
+  if((n < 1.0) || (n > 20.0)) {
+
+    reset();
+    arrival(stamp);
+
+    return;
+  }
+
+  double predicted = ref + (n * period);
+  double err       = (double)stamp - predicted;
+
+  ref     = predicted + (PhaseAlpha * err);
+  period += (PhaseBeta * err) / n;
+  jitter += JitterGain * (fabs(err) - jitter);
+
+  last = stamp;
+  frames++;
+}
+
+/**
+ *
+ * locked() - true if we know the period and phase well enough to
+ * predict, and the frames are still coming.
+ *
+ * @param now uint64_t - the current time.
+ *
+ */
+
+bool PhaseEstimator::locked(uint64_t now) const {
+
+  if((frames < PhaseMinFrames) || (period <= 0.0)) {
+    return false;
+  }
+
+  /* if we've missed 3 frames in a row, the input has gone quiet */
+
+  if((double)now > (ref + (3.0 * period))) {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ *
+ * next() - the predicted arrival of the first frame at or after
+ * the given time.  Only meaningful if locked().
+ *
+ * @param after uint64_t - the time of interest.
+ *
+ */
+
+uint64_t PhaseEstimator::next(uint64_t after) const {
+
+  if(period <= 0.0) {
+    return after;
+  }
+
+  double n = ceil(((double)after - ref) / period);
+
+  if(n < 0.0) {
+    n = 0.0;
+  }
+
+  return (uint64_t)(ref + (n * period));
+}
@@ -0,0 +1,216 @@
+#include "SerialSink.hh"
+#include "ConfigManager.hh"
+
+/**
+ *
+ * configure() - read baud, rate_hz and data from the sink's section.
+ *
+ * @param hz int - the sender's tick rate.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialSink::configure(int hz) {
+
+  IniFile & ini = ConfigManager::instance();
+
+  if(!ini.isReady()) {
+    error("configure() - no configuration.");
+    return false;
+  }
+
+  string tmp = trim(ini.getValue(name, "baud"));
+
+  baud = tmp.empty() ? string("57600") : tmp;
+
+  if(!is_numeric(baud)) {
+    error(string("configure() - [") + name + string("] baud must be a number: ") + baud);
+    return false;
+  }
+
+  if(!configureRate(hz, (hz < 10) ? hz : 10)) {
+    return false;
+  }
+
+  tmp = trim(strtolower(ini.getValue(name, "data")));
+
+  if(tmp.empty() || (tmp == "normal")) {
+    data = NORMAL;
+  } else if(tmp == "raw") {
+    data = RAW;
+  } else if(tmp == "output") {
+    data = OUTPUT;
+  } else {
+    error(string("configure() - [") + name + string("] data must be raw, normal or output: ") + tmp);
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * open() - open the sink's port.
+ *
+ * @param mapper PortMapper - where to find the port.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialSink::open(PortMapper & mapper) {
+
+  if(port != NULL) {
+    return true;
+  }
+
+  string device = mapper.getDevice(name);
+
+  if(device.empty()) {
+    error(string("open() - can not find the ") + name + string(" device."));
+    return false;
+  }
+
+  port = new RS232Port(device, baud + string(",8,N,1"), false);
+
+  if(!port->isReady()) {
+    error(string("open() - can not open ") + name + string(": ") + port->getError());
+    delete port;
+    port = NULL;
+    return false;
+  }
+
+  /*
+   * we only ever write, and from the sender's (real time) thread; if
+   * the tty buffer fills up write() has to come right back rather
+   * than stall the sender, the frame is just dropped (see send()).
+   *
+   */
+
+  if(!port->setNonBlocking()) {
+    error(string("open() - can not make ") + name + string(" non-blocking: ") + port->getError());
+    delete port;
+    port = NULL;
+    return false;
+  }
+
+  notePort(device + string(" at ") + baud + string(" baud, ") + to_string(rateHz) + string(" Hz"));
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * close() - close the sink's port.
+ *
+ */
+
+void SerialSink::close(void) {
+
+  if(port == NULL) {
+    return;
+  }
+
+  delete port;
+  port = NULL;
+
+  notePort("not open");
+}
+
+/**
+ *
+ * send() - if a frame is due on this tick, encode it and send it.
+ *
+ * @param frame SampleFrame - the current values.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialSink::send(const SampleFrame & frame) {
+
+  if((port == NULL) || !due()) {
+    return true;
+  }
+
+  /* the last frame still hasn't gone out?  don't pile up stale ones */
+
+  if(backlogCheck) {
+
+    long queued = port->outputQueued();
+
+    if(queued < 0) {
+
+      warning(string("send() - can't see the ") + name + string(" output queue, not checking for a backlog."));
+      backlogCheck = false;
+
+    } else if(queued > 0) {
+
+      dropped++;
+      return true;
+    }
+  }
+
+  size_t n = encode(frame, buffer, sizeof(buffer));
+
+  if(n == 0) {
+    return true;
+  }
+
+  int     fd    = port->getHandle();
+  ssize_t wrote = 0;
+
+  do {
+    wrote = write(fd, buffer, n);
+  } while((wrote < 0) && (errno == EINTR));
+
+  if(wrote < 0) {
+
+    /* the tty buffer is full, drop the frame (the next one is newer) */
+
+    if((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      dropped++;
+      return true;
+    }
+
+    failed++;
+    error(string("send() - can't write to ") + name + string(": ") + strerror(errno));
+    return false;
+  }
+
+  bytes += (size_t)wrote;
+
+  /*
+   * only part of it fit; we don't wait around for the rest, the device
+   * re-syncs on the next frame.
+   *
+   */
+
+  if((size_t)wrote < n) {
+    dropped++;
+    return true;
+  }
+
+  sent++;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * describe() - bytes sent and frames dropped, too.
+ *
+ */
+
+string SerialSink::describe(void) {
+
+  return OutputSink::describe() + string("  ") + name + string(": ") + to_string(bytes)
+    + string(" bytes, ") + to_string(dropped) + string(" frames dropped (backlog or port full)\n");
+}
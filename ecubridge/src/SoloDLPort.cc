@@ -1,5 +1,97 @@
 #include "SoloDLPort.hh"
 
+/**
+ *
+ * configuredTickHz() - how often writeSamples() expects to
+ * be called; the [solodl] tick_hz setting, or
+ * SoloDLDefaultTickHz if its not set.
+ *
+ * @return int - the tick rate (Hz), or 0 if the setting
+ * is bad.
+ *
+ */
+
+int SoloDLPort::configuredTickHz(void) {
+
+  IniFile ini = ConfigManager::instance();
+
+  if(!ini.isReady()) {
+    return SoloDLDefaultTickHz;
+  }
+
+  string tmp = trim(ini.getValue("solodl", "tick_hz"));
+
+  if(tmp.empty()) {
+    return SoloDLDefaultTickHz;
+  }
+
+  if(!is_numeric(tmp)) {
+    return 0;
+  }
+
+  int hz = (int)strtol(tmp.c_str(), NULL, 10);
+
+  if((hz < 1) || (hz > TimingWheelMaxHz)) {
+    return 0;
+  }
+
+  return hz;
+}
+
+/**
+ *
+ * schedule() - (re)plan the output schedule from the tick
+ * rate and the [solodl] rate_N settings (any channel that
+ * doesn't have one keeps its AIMFreq rate).
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SoloDLPort::schedule(void) {
+
+  int hz = configuredTickHz();
+
+  if(hz == 0) {
+    error(string("schedule() - [solodl] tick_hz must be 1..") + to_string((int)TimingWheelMaxHz) + string(" Hz."));
+    return false;
+  }
+
+  IniFile ini = ConfigManager::instance();
+
+  if(ini.isReady()) {
+
+    for(int chan=1; chan<=SoloDLChannelMax; chan++) {
+
+      string tmp = trim(ini.getValue("solodl", string("rate_") + to_string(chan)));
+
+      if(tmp.empty()) {
+        continue;
+      }
+
+      if(!is_numeric(tmp)) {
+        error(string("schedule() - [solodl] rate_") + to_string(chan) + string(" is not a number: ") + tmp);
+        return false;
+      }
+
+      rates[chan] = (int)strtol(tmp.c_str(), NULL, 10);
+    }
+  }
+
+  if(!wheel.configure(hz, rates, SoloDLChannelMax)) {
+    error(string("schedule() - bad output schedule: ") + wheel.getError());
+    return false;
+  }
+
+  backlogLimit = SoloDLBytesPerSecond / hz;
+
+  info(string("schedule() - output scheduled on a ") + to_string(hz) + string(" Hz tick."));
+
+  /* all done */
+
+  return true;
+}
+
 /**
  *
  * writeSamples() - assuming data is ready to be
@@ -14,10 +106,10 @@
  *
  * @return bool - exactly false on error.
  *
- * NOTE: we assume (per AIM protocol) that this method
- * will be called with a frequency of 10hz (every 100ms).
- * If you don't call it with that frequency, you will
- * need to adjust the code below.
+ * NOTE: this must be called at the tick rate (see
+ * getTickHz()), every call advances the output schedule
+ * by one tick and sends only the channels due on that
+ * tick.  The samples array is not changed.
  *
  * NOTE: channels are assumed to be in this following
  * order from samples[1] .. samples[15]:
@@ -50,67 +142,99 @@ bool SoloDLPort::writeSamples(unsigned int *samples) {
 
   int fd = getHandle();
 
-  /* tick to the next (100ms) slice of a second */
+  /* tick to the next slot, and send whatever is due */
+
+  const vector<unsigned short> & due = wheel.next();
 
-  slot = 1 + slot % 10;
+  if(due.empty()) {
+    return true;
+  }
 
   /*
-   * scan through the channels, and send then only if
-   * its time to send them.
+   * if the SoloDL (or the cable) stalled, what we wrote before is still
+   * queued up.  More than a tick's worth means it's stale; when the
+   * device comes back it should get fresh values, not a replay of the
+   * last few seconds.  So either throw the backlog away, or don't add
+   * to it (the channels we skip go out on their next tick, with
+   * whatever the value is by then).
    *
    */
 
-  for(unsigned short chan=1; chan<=SoloDLChannelMax; chan++) {
+  if(backlogCheck) {
+
+    long queued = outputQueued();
 
-    if((slot % factor[chan]) != 0) {
+    if(queued < 0) {
 
-      /* not time to send this channel yet */
+      warning("writeSamples() - can't see the output queue, not checking for a backlog.");
+      backlogCheck = false;
 
-      samples[chan] = 0;
-      continue;
+    } else if(queued > backlogLimit) {
+
+      if(!flushBacklog) {
+        backlogSkips++;
+        return true;
+      }
+
+      if(flushOutput()) {
+        backlogFlushes++;
+        flushedBytes += (unsigned long)queued;
+      }
     }
+  }
 
-    /*
-     * format a packet for this channel, encoding the proper
-     * channel id as Solo DL expects
-     *
-     */
+  /*
+   * format a packet for each channel, encoding the proper channel id
+   * as Solo DL expects, all into one buffer (see AIMProtocol.hh).
+   *
+   */
 
-    unsigned int checksum = 0;
-    char packet[5];
+  unsigned char *p = burst;
 
-    packet[0] = chanMap[chan];
-    packet[1] = 0xA3;
-    packet[2] = samples[chan] >> 8;
-    packet[3] = samples[chan] % 256;
+  for(size_t i=0; i<due.size(); i++) {
 
-    for(int j=0; j<4; j++) {
-      checksum += packet[j];
-    }
+    unsigned short chan = due[i];
 
-    checksum %= 256;
-    packet[4] = (unsigned short)checksum;
+    aimEncode(p, chan, samples[chan]);
+
+    p += AIMPacketSize;
+  }
 
-    /* send it! */
+  /* send it! (normally in one go, the port blocks) */
 
-    size_t n = write(fd, packet, 5);
+  size_t length = (size_t)(p - burst);
+  size_t done   = 0;
+
+  while(done < length) {
+
+    ssize_t n = write(fd, burst + done, length - done);
+
+    writeCalls++;
 
     if(n < 0) {
 
-      error("can't write data.");
-      return false;
+      if(errno == EINTR) {
+        continue;
+      }
 
-    } if(n != 5) {
+      error(string("can't write data: ") + strerror(errno));
+      return false;
+    }
 
+    if(n == 0) {
       error("didn't write whole packet.");
       return false;
     }
+
+    done += (size_t)n;
   }
 
+  bytesSent += length;
+  ticksSent++;
+
   /*
-   * we've scanned through all channels and sent out
-   * those that need to be sent per they're expected
-   * sample frequency.
+   * we've sent out the channels that are due on this
+   * tick, per their expected sample frequency.
    *
    */
 
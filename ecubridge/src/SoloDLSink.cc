@@ -0,0 +1,163 @@
+#include "SoloDLSink.hh"
+
+/**
+ *
+ * configure() - the SoloDL's schedule is planned by the port
+ * itself, from [solodl]; the sender must be ticking at its rate.
+ *
+ * @param hz int - the sender's tick rate.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SoloDLSink::configure(int hz) {
+
+  if(hz != SoloDLPort::configuredTickHz()) {
+    error(string("configure() - the sender ticks at ") + to_string(hz) + string(" Hz, not the [solodl] tick_hz."));
+    return false;
+  }
+
+  tickHz = hz;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * open() - open the SoloDL port.
+ *
+ * @param mapper PortMapper - where to find the port.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SoloDLSink::open(PortMapper & mapper) {
+
+  if(port != NULL) {
+    return true;
+  }
+
+  string device = mapper.getDevice(Device::SOLODL);
+
+  if(device.empty()) {
+    error("open() - can not find Solo DL device.");
+    return false;
+  }
+
+  port = new SoloDLPort(device);
+
+  if(!port->isReady()) {
+    error(string("open() - can not open Solo DL: ") + port->getError());
+    delete port;
+    port = NULL;
+    return false;
+  }
+
+  notePort(port->describeLatency());
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * close() - close the SoloDL port.
+ *
+ */
+
+void SoloDLSink::close(void) {
+
+  if(port == NULL) {
+    return;
+  }
+
+  baseBytes   += port->getBytesSent();
+  baseWrites  += port->getWriteCalls();
+  baseTicks   += port->getTicksSent();
+  baseSkips   += port->getBacklogSkips();
+  baseFlushes += port->getBacklogFlushes();
+  baseFlushed += port->getFlushedBytes();
+
+  delete port;
+  port = NULL;
+
+  notePort("not open");
+}
+
+/**
+ *
+ * send() - send the output channels due on this tick.
+ *
+ * @param frame SampleFrame - the current values.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SoloDLSink::send(const SampleFrame & frame) {
+
+  if(port == NULL) {
+    return true;
+  }
+
+  /* writeSamples() is allowed to modify what its given */
+
+  unsigned int outputData[SoloDLChannelMax+1];
+
+  memcpy(outputData, frame.output, sizeof(outputData));
+
+  bool sentOk = port->writeSamples(outputData);
+
+  bytes   = baseBytes   + port->getBytesSent();
+  writes  = baseWrites  + port->getWriteCalls();
+  sent    = baseTicks   + port->getTicksSent();
+  skips   = baseSkips   + port->getBacklogSkips();
+  flushes = baseFlushes + port->getBacklogFlushes();
+  flushed = baseFlushed + port->getFlushedBytes();
+
+  if(!sentOk) {
+    failed++;
+    error(string("send() - failed to send data: ") + port->getError());
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * describe() - bytes and write() calls per tick, and what we did
+ * about backlogs.
+ *
+ */
+
+string SoloDLSink::describe(void) {
+
+  unsigned long ticks = sent;
+  unsigned long total = bytes;
+  unsigned long calls = writes;
+
+  char perTick[64];
+
+  snprintf(perTick, sizeof(perTick), "%.1f bytes, %.2f write() calls",
+    (ticks > 0) ? (double)total / (double)ticks : 0.0,
+    (ticks > 0) ? (double)calls / (double)ticks : 0.0);
+
+  string status = OutputSink::describe();
+
+  status += string("solodl: ") + to_string(total) + string(" bytes in ") + to_string(calls)
+    + string(" write() calls, ") + string(perTick) + string(" per tick\n");
+
+  status += string("backlog: ") + to_string(skips) + string(" ticks skipped, ")
+    + to_string(flushes) + string(" flushes, ") + to_string(flushed)
+    + string(" stale bytes dropped\n");
+
+  return status;
+}
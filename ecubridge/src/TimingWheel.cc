@@ -0,0 +1,279 @@
+#include "TimingWheel.hh"
+
+#include <algorithm>
+#include <math.h>
+
+/**
+ *
+ * configure() - plan the wheel.
+ *
+ * @param hz int - ticks per second, 1..TimingWheelMaxHz.
+ *
+ * @param rates int array - the rate (Hz) of each channel, channels
+ * are [1] .. [channels], 0 means never send it.  No rate may be
+ * more than the tick rate.
+ *
+ * @param channels int - the # of channels.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool TimingWheel::configure(int hz, const int *rates, int channels) {
+
+  unReady();
+
+  if((hz < 1) || (hz > TimingWheelMaxHz)) {
+    error(string("configure() - tick rate must be 1..") + to_string((int)TimingWheelMaxHz) + string(" Hz, not: ") + to_string(hz));
+    return false;
+  }
+
+  if((rates == NULL) || (channels < 1)) {
+    error("configure() - no channels.");
+    return false;
+  }
+
+  for(int chan=1; chan<=channels; chan++) {
+
+    if((rates[chan] < 0) || (rates[chan] > hz)) {
+      error(string("configure() - channel ") + to_string(chan) + string(" rate ") + to_string(rates[chan])
+        + string(" Hz must be 0..") + to_string(hz) + string(" Hz (the tick rate)."));
+      return false;
+    }
+  }
+
+  tickHz = hz;
+  slot   = -1;
+
+  wheel.assign(tickHz, vector<unsigned short>());
+
+  vector<int> load(tickHz, 0);
+
+  /*
+   * place the fastest channels first, they have the least freedom
+   * in where they can go.  Ties go in channel order so the plan is
+   * always the same for the same configuration.
+   *
+   */
+
+  vector<int> order;
+
+  for(int chan=1; chan<=channels; chan++) {
+    if(rates[chan] > 0) {
+      order.push_back(chan);
+    }
+  }
+
+  std::stable_sort(order.begin(), order.end(), [rates](int a, int b) { return rates[a] > rates[b]; });
+
+  /*
+   * greedy first; each channel (fastest first) takes the phase where
+   * the busiest slot it would land on is the least busy (then the
+   * least total load).
+   *
+   */
+
+  vector<int> phase(channels+1, 0);
+  int         total = 0;
+
+  for(size_t i=0; i<order.size(); i++) {
+
+    int    chan     = order[i];
+    int    rate     = rates[chan];
+    double interval = (double)tickHz / (double)rate;
+    int    phases   = (int)ceil(interval);
+
+    int bestPhase = 0;
+    int bestMax   = -1;
+    int bestSum   = 0;
+
+    for(int p=0; p<phases; p++) {
+
+      int worst = 0;
+      int sum   = 0;
+
+      for(int k=0; k<rate; k++) {
+
+        int s = slotOf(p, k, interval);
+
+        worst  = std::max(worst, load[s]);
+        sum   += load[s];
+      }
+
+      if((bestMax < 0) || (worst < bestMax) || ((worst == bestMax) && (sum < bestSum))) {
+        bestPhase = p;
+        bestMax   = worst;
+        bestSum   = sum;
+      }
+    }
+
+    phase[chan] = bestPhase;
+
+    for(int k=0; k<rate; k++) {
+      load[slotOf(bestPhase, k, interval)]++;
+    }
+
+    total += rate;
+  }
+
+  /*
+   * greedy can paint itself into a corner (i.e. the 5hz channels take
+   * phases that leave no room for the 2hz ones), so see if a search
+   * can do better; start from the best possible (packets spread
+   * perfectly evenly) and work up to what greedy got.
+   *
+   */
+
+  int greedyMax = 0;
+
+  for(int s=0; s<tickHz; s++) {
+    greedyMax = std::max(greedyMax, load[s]);
+  }
+
+  for(int limit=(total + tickHz - 1) / tickHz; limit<greedyMax; limit++) {
+
+    vector<int> tryLoad(tickHz, 0);
+    vector<int> tryPhase(channels+1, 0);
+    long        budget = 200000;
+
+    if(fit(order, rates, 0, limit, tryLoad, tryPhase, budget)) {
+      phase = tryPhase;
+      break;
+    }
+  }
+
+  /* fill in the wheel */
+
+  for(size_t i=0; i<order.size(); i++) {
+
+    int    chan     = order[i];
+    double interval = (double)tickHz / (double)rates[chan];
+
+    for(int k=0; k<rates[chan]; k++) {
+      wheel[slotOf(phase[chan], k, interval)].push_back((unsigned short)chan);
+    }
+  }
+
+  /* within a slot, send in channel order */
+
+  for(int s=0; s<tickHz; s++) {
+    std::sort(wheel[s].begin(), wheel[s].end());
+  }
+
+  makeReady();
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * slotOf() - the slot a channel's k'th send lands on, if it
+ * starts at the given phase and repeats every 'interval' slots.
+ *
+ */
+
+int TimingWheel::slotOf(int phase, int k, double interval) const {
+  return ((int)floor(phase + (k * interval) + 1e-9)) % tickHz;
+}
+
+/**
+ *
+ * fit() - (configure() helper) depth first search for phases of
+ * order[i..] that keep every slot at or under 'limit' packets.
+ * Gives up (false) when 'budget' runs out.
+ *
+ */
+
+bool TimingWheel::fit(const vector<int> & order, const int *rates, size_t i, int limit,
+                      vector<int> & load, vector<int> & phase, long & budget) const {
+
+  if(i >= order.size()) {
+    return true;
+  }
+
+  if(--budget <= 0) {
+    return false;
+  }
+
+  int    chan     = order[i];
+  int    rate     = rates[chan];
+  double interval = (double)tickHz / (double)rate;
+  int    phases   = (int)ceil(interval);
+
+  /*
+   * channels with the same rate are interchangeable, so only try
+   * phases in increasing order among them, no point trying every
+   * permutation of the same plan.
+   *
+   */
+
+  int first = 0;
+
+  if((i > 0) && (rates[order[i-1]] == rate)) {
+    first = phase[order[i-1]];
+  }
+
+  for(int p=first; p<phases; p++) {
+
+    bool fits = true;
+
+    for(int k=0; (k<rate) && fits; k++) {
+      if(load[slotOf(p, k, interval)] >= limit) {
+        fits = false;
+      }
+    }
+
+    if(!fits) {
+      continue;
+    }
+
+    for(int k=0; k<rate; k++) {
+      load[slotOf(p, k, interval)]++;
+    }
+
+    phase[chan] = p;
+
+    if(fit(order, rates, i+1, limit, load, phase, budget)) {
+      return true;
+    }
+
+    for(int k=0; k<rate; k++) {
+      load[slotOf(p, k, interval)]--;
+    }
+
+    if(budget <= 0) {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+/**
+ *
+ * describe() - human readable plan, one line per slot:
+ *
+ *   slot 0: 1 3
+ *   slot 1: 2 ...
+ *
+ */
+
+string TimingWheel::describe(void) const {
+
+  string plan = "";
+
+  for(size_t s=0; s<wheel.size(); s++) {
+
+    plan += string("slot ") + to_string(s) + string(":");
+
+    for(size_t i=0; i<wheel[s].size(); i++) {
+      plan += string(" ") + to_string(wheel[s][i]);
+    }
+
+    plan += "\n";
+  }
+
+  return plan;
+}
@@ -63,16 +63,14 @@ void signalHandler(int sig) {
     case SIGHUP:
       {
         /*
-         * reconfigure...this is a little aggressive, we should
-         * really make this be a pending request that loop() then
-         * handles.  Forcing it like this might have bad impacts
-         * on local variables in loop().
+         * reload the channel configuration.  This only flags the
+         * request, the bridge does the actual reload on its own
+         * threads.
          *
          */
 
         if(bridge != NULL) {
-          LogManager::info("[signal] requesting configure...");
-          bridge->configure();
+          bridge->requestReload();
         }
       }
       break;
@@ -0,0 +1,204 @@
+#include "CANSocket.hh"
+
+#include <fstream>
+#include <signal.h>
+
+INITIALIZE_EASYLOGGINGPP
+
+/*
+ * ecucanplay - play a candump log (candump -l) onto a CAN interface,
+ * so the bridge's CAN input (see [can input]) can be run against a
+ * recording without the car.  On a virtual interface:
+ *
+ *   modprobe vcan
+ *   ip link add dev vcan0 type vcan
+ *   ip link set up vcan0
+ *
+ * and set interface = vcan0 in [can input].  Frames that are due at
+ * the same time go out in one batch (see CANSocket::send()).
+ *
+ */
+
+static volatile sig_atomic_t stopping = 0;
+
+void signalHandler(int sig) {
+  (void)sig;
+  stopping = 1;
+}
+
+void usage(void) {
+  cout << "usage: ecucanplay <candump log> <interface> [speed] [loop]" << endl;
+  cout << endl;
+  cout << "  speed - 1 for real time (default), N for N times faster, max for" << endl;
+  cout << "          as fast as the interface will take it." << endl;
+  cout << "  loop  - start over at the end of the log." << endl;
+}
+
+/* (main() helper) wait until the absolute time 'due' */
+
+void sleepUntil(uint64_t due) {
+
+  struct timespec ts;
+  ts.tv_sec  = due / 1000000000ULL;
+  ts.tv_nsec = due % 1000000000ULL;
+
+  while(!stopping && (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)) {
+  }
+}
+
+int main(int argc, const char* argv[]) {
+
+  if(argc < 3) {
+    usage();
+    return 1;
+  }
+
+  string fileName = argv[1];
+  string ifName   = argv[2];
+  double speed    = 1.0;
+  bool loop       = false;
+
+  if(argc >= 4) {
+
+    string arg = trim(strtolower(argv[3]));
+
+    if(arg == "max") {
+      speed = 0.0;
+    } else {
+      speed = atof(arg.c_str());
+      if(speed <= 0.0) {
+        usage();
+        return 1;
+      }
+    }
+  }
+
+  if(argc >= 5) {
+    loop = (trim(strtolower(argv[4])) == "loop");
+  }
+
+  /* read the whole log up front, so reading never holds up the timing */
+
+  vector<struct can_frame> frames;
+  vector<double>           stamps;
+
+  {
+    ifstream log(fileName.c_str());
+
+    if(!log.is_open()) {
+      cout << "[ecucanplay] can not open log: " << fileName << endl;
+      return 1;
+    }
+
+    string line;
+    unsigned long skipped = 0;
+
+    while(getline(log, line)) {
+
+      struct can_frame frame;
+      double stamp = 0.0;
+      string logged;
+
+      if(!CANSocket::parseLog(line, frame, stamp, logged)) {
+        skipped++;
+        continue;
+      }
+
+      frames.push_back(frame);
+      stamps.push_back(stamp);
+    }
+
+    if(frames.empty()) {
+      cout << "[ecucanplay] no frames in the log." << endl;
+      return 1;
+    }
+
+    cout << "[ecucanplay] " << frames.size() << " frames, " << skipped << " lines skipped." << endl;
+  }
+
+  CANSocket bus(ifName);
+
+  if(!bus.isReady()) {
+    cout << "[ecucanplay] can not open CAN interface: " << ifName << endl;
+    return 1;
+  }
+
+  /* we only send */
+
+  bus.setFilter(vector<canid_t>());
+
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  unsigned long long sent    = 0;
+  unsigned long long dropped = 0;
+  unsigned long long calls   = 0;
+  unsigned long passes       = 0;
+
+  while(!stopping) {
+
+    /*
+     * each frame goes out at the same offset from the start as it was
+     * logged at (scaled by the speed), on an absolute clock; everything
+     * that's due by then goes in the same batch.
+     *
+     */
+
+    uint64_t start = monotonic_ns();
+    size_t   next  = 0;
+
+    while(!stopping && (next < frames.size())) {
+
+      uint64_t due = start;
+
+      if(speed > 0.0) {
+        due += (uint64_t)(((stamps[next] - stamps[0]) / speed) * 1000000000.0);
+        sleepUntil(due);
+      }
+
+      uint64_t now   = monotonic_ns();
+      size_t   batch = 1;
+
+      while(((next + batch) < frames.size()) && (batch < CANSocketMaxBatch)) {
+
+        if(speed > 0.0) {
+
+          uint64_t later = start + (uint64_t)(((stamps[next + batch] - stamps[0]) / speed) * 1000000000.0);
+
+          if(later > now) {
+            break;
+          }
+        }
+
+        batch++;
+      }
+
+      int n = bus.send(&frames[next], (int)batch);
+
+      calls++;
+
+      if(n < 0) {
+        cout << "[ecucanplay] can not send on " << ifName << endl;
+        stopping = 1;
+        break;
+      }
+
+      sent    += n;
+      dropped += batch - n;
+      next    += batch;
+    }
+
+    passes++;
+
+    cout << "[ecucanplay] pass " << passes << ": " << sent << " frames sent in " << calls
+         << " calls, " << dropped << " dropped (queue full)." << endl;
+
+    if(!loop) {
+      break;
+    }
+  }
+
+  /* all done */
+
+  return 0;
+}
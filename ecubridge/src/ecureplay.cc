@@ -0,0 +1,165 @@
+#include "SerialCapture.hh"
+#include "PseudoTerminal.hh"
+
+#include <signal.h>
+
+INITIALIZE_EASYLOGGINGPP
+
+/*
+ * ecureplay - play a DL-32 capture (see the "capture" command) back
+ * into a pty, so the bridge can be run against real data without the
+ * car.  Point the bridge at the pty with the [dl32] (and [solodl])
+ * device setting:
+ *
+ *   [dl32]
+ *   device = /var/tmp/ecubridge-dl32
+ *
+ * and whatever the bridge sends to the SoloDL is read and thrown away
+ * (counted) on the other pty.
+ *
+ */
+
+static volatile sig_atomic_t stopping = 0;
+
+void signalHandler(int sig) {
+  (void)sig;
+  stopping = 1;
+}
+
+void usage(void) {
+  cout << "usage: ecureplay <capture file> [speed] [loop]" << endl;
+  cout << endl;
+  cout << "  speed - 1 for real time (default), N for N times faster, max for" << endl;
+  cout << "          as fast as the bridge will take it." << endl;
+  cout << "  loop  - start over at the end of the capture." << endl;
+  cout << endl;
+  cout << "  The DL-32 pty is /var/tmp/ecubridge-dl32, the SoloDL pty is" << endl;
+  cout << "  /var/tmp/ecubridge-solodl." << endl;
+}
+
+int main(int argc, const char* argv[]) {
+
+  if(argc < 2) {
+    usage();
+    return 1;
+  }
+
+  string fileName = argv[1];
+  double speed    = 1.0;
+  bool loop       = false;
+
+  if(argc >= 3) {
+
+    string arg = trim(strtolower(argv[2]));
+
+    if(arg == "max") {
+      speed = 0.0;
+    } else {
+      speed = atof(arg.c_str());
+      if(speed <= 0.0) {
+        usage();
+        return 1;
+      }
+    }
+  }
+
+  if(argc >= 4) {
+    loop = (trim(strtolower(argv[3])) == "loop");
+  }
+
+  SerialCapture capture;
+
+  if(!capture.openRead(fileName)) {
+    cout << "[ecureplay] can not open capture: " << fileName << endl;
+    return 1;
+  }
+
+  PseudoTerminal dl32("/var/tmp/ecubridge-dl32");
+  PseudoTerminal solodl("/var/tmp/ecubridge-solodl");
+
+  if(!dl32.isReady() || !solodl.isReady()) {
+    cout << "[ecureplay] can not create the ptys." << endl;
+    return 1;
+  }
+
+  cout << "[ecureplay] DL-32 on " << dl32.getSlaveName() << " (/var/tmp/ecubridge-dl32)" << endl;
+  cout << "[ecureplay] SoloDL on " << solodl.getSlaveName() << " (/var/tmp/ecubridge-solodl)" << endl;
+
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  unsigned long long sent   = 0;
+  unsigned long long drained = 0;
+  unsigned long passes      = 0;
+
+  vector<unsigned char> bytes;
+  uint64_t stamp = 0;
+
+  while(!stopping) {
+
+    /*
+     * each record goes out at the same offset from the start as it was
+     * read at (scaled by the speed), on an absolute clock so the time
+     * we spend writing doesn't add up.
+     *
+     */
+
+    uint64_t first = 0;
+    uint64_t start = monotonic_ns();
+
+    while(!stopping && capture.next(stamp, bytes)) {
+
+      if(first == 0) {
+        first = stamp;
+      }
+
+      if(speed > 0.0) {
+
+        uint64_t due = start + (uint64_t)((double)(stamp - first) / speed);
+
+        struct timespec ts;
+        ts.tv_sec  = due / 1000000000ULL;
+        ts.tv_nsec = due % 1000000000ULL;
+
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+          if(stopping) {
+            break;
+          }
+        }
+      }
+
+      if(!dl32.send(bytes.data(), bytes.size(), &stopping)) {
+        if(!stopping) {
+          cout << "[ecureplay] can not write to the DL-32 pty." << endl;
+        }
+        stopping = 1;
+        break;
+      }
+
+      sent += bytes.size();
+
+      long n = solodl.drain();
+      if(n > 0) {
+        drained += n;
+      }
+    }
+
+    if(!capture.isReady()) {
+      cout << "[ecureplay] capture is damaged: " << capture.getError() << endl;
+      return 1;
+    }
+
+    passes++;
+
+    cout << "[ecureplay] pass " << passes << ": " << capture.getRecords() << " reads, "
+         << sent << " bytes sent, " << drained << " SoloDL bytes received." << endl;
+
+    if(!loop || !capture.rewind()) {
+      break;
+    }
+  }
+
+  /* all done */
+
+  return 0;
+}
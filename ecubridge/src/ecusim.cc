@@ -0,0 +1,219 @@
+#include "MTSGenerator.hh"
+#include "PseudoTerminal.hh"
+
+#include <signal.h>
+#include <getopt.h>
+
+INITIALIZE_EASYLOGGINGPP
+
+/*
+ * ecusim - a pretend DL-32 on a pty, for load testing the bridge.  It
+ * sends made up MTS packets (see MTSGenerator) at whatever rate we
+ * like, well past the real DL-32's ~12 a second, paced as if they were
+ * going down a serial line at the given baud.  Point the bridge at the
+ * pty with the [dl32] (and [solodl]) device setting:
+ *
+ *   [dl32]
+ *   device = /var/tmp/ecubridge-dl32
+ *
+ * Whatever the bridge sends to the SoloDL is read and counted on the
+ * other pty.  Once a second we print what we sent, so the rate where
+ * the bridge (or the Pi) can't keep up shows as the send falling
+ * behind ("late" packets) and the "status" command's resync/skip
+ * counters.
+ *
+ */
+
+static volatile sig_atomic_t stopping = 0;
+
+void signalHandler(int sig) {
+  (void)sig;
+  stopping = 1;
+}
+
+void usage(void) {
+  cout << "usage: ecusim [options]" << endl;
+  cout << endl;
+  cout << "  -c channels   - aux channels per packet, 1..32 (default 5)" << endl;
+  cout << "  -r rate       - packets a second, 0 for as fast as the baud allows (default 12)" << endl;
+  cout << "  -w waveform   - ramp, sine or noise (default ramp)" << endl;
+  cout << "  -p seconds    - waveform period (default 10)" << endl;
+  cout << "  -b baud       - pace the bytes as if sent at this baud, 0 for no pacing (default 19200)" << endl;
+  cout << "  -t percent    - truncate this % of packets" << endl;
+  cout << "  -h percent    - break the header of this % of packets" << endl;
+  cout << "  -s percent    - put an LM-1/LC-1 sub-packet in this % of packets" << endl;
+  cout << "  -S seed       - random seed for the faults and noise (default 1)" << endl;
+  cout << "  -d seconds    - run this long, 0 for until stopped (default 0)" << endl;
+  cout << endl;
+  cout << "  The DL-32 pty is /var/tmp/ecubridge-dl32, the SoloDL pty is" << endl;
+  cout << "  /var/tmp/ecubridge-solodl." << endl;
+}
+
+int main(int argc, char* argv[]) {
+
+  int channels      = DL32ChannelMax;
+  double rate       = 12.0;
+  MTSWaveform wave  = MTSWaveform::RAMP;
+  double period     = 10.0;
+  long baud         = 19200;
+  double truncate   = 0.0;
+  double badHeader  = 0.0;
+  double subPacket  = 0.0;
+  uint32_t seed     = 1;
+  double duration   = 0.0;
+
+  int opt;
+
+  while((opt = getopt(argc, argv, "c:r:w:p:b:t:h:s:S:d:")) != -1) {
+
+    switch(opt) {
+
+      case 'c': channels  = atoi(optarg); break;
+      case 'r': rate      = atof(optarg); break;
+      case 'p': period    = atof(optarg); break;
+      case 'b': baud      = atol(optarg); break;
+      case 't': truncate  = atof(optarg) / 100.0; break;
+      case 'h': badHeader = atof(optarg) / 100.0; break;
+      case 's': subPacket = atof(optarg) / 100.0; break;
+      case 'S': seed      = (uint32_t)strtoul(optarg, NULL, 10); break;
+      case 'd': duration  = atof(optarg); break;
+
+      case 'w':
+        {
+          string arg = trim(strtolower(optarg));
+
+          if(arg == "ramp") {
+            wave = MTSWaveform::RAMP;
+          } else if(arg == "sine") {
+            wave = MTSWaveform::SINE;
+          } else if(arg == "noise") {
+            wave = MTSWaveform::NOISE;
+          } else {
+            usage();
+            return 1;
+          }
+        }
+        break;
+
+      default:
+        usage();
+        return 1;
+    }
+  }
+
+  if((rate < 0.0) || (baud < 0) || ((rate == 0.0) && (baud == 0))) {
+    cout << "[ecusim] need a rate, a baud or both." << endl;
+    return 1;
+  }
+
+  MTSGenerator generator;
+
+  generator.seed(seed);
+
+  if(!generator.configure(channels, wave, period) || !generator.setFaults(truncate, badHeader, subPacket)) {
+    cout << "[ecusim] bad options." << endl;
+    return 1;
+  }
+
+  PseudoTerminal dl32("/var/tmp/ecubridge-dl32");
+  PseudoTerminal solodl("/var/tmp/ecubridge-solodl");
+
+  if(!dl32.isReady() || !solodl.isReady()) {
+    cout << "[ecusim] can not create the ptys." << endl;
+    return 1;
+  }
+
+  cout << "[ecusim] DL-32 on " << dl32.getSlaveName() << " (/var/tmp/ecubridge-dl32)" << endl;
+  cout << "[ecusim] SoloDL on " << solodl.getSlaveName() << " (/var/tmp/ecubridge-solodl)" << endl;
+
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+
+  /*
+   * each packet is due one period after the last, or when the last
+   * one would have finished going down the wire at 'baud' (10 bits a
+   * byte for 8N1), whichever is later.  Absolute deadlines, so the time
+   * we take doesn't add up.
+   *
+   */
+
+  uint64_t interval = (rate > 0.0) ? (uint64_t)(1000000000.0 / rate) : 0;
+  uint64_t start    = monotonic_ns();
+  uint64_t due      = start;
+  uint64_t report   = start + 1000000000ULL;
+  uint64_t end      = (duration > 0.0) ? start + (uint64_t)(duration * 1000000000.0) : 0;
+
+  unsigned char buf[MTSMaxPacket];
+
+  unsigned long long sent    = 0;
+  unsigned long long drained = 0;
+  unsigned long packets      = 0;
+  unsigned long late         = 0;
+
+  while(!stopping) {
+
+    struct timespec ts;
+    ts.tv_sec  = due / 1000000000ULL;
+    ts.tv_nsec = due % 1000000000ULL;
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+      if(stopping) {
+        break;
+      }
+    }
+
+    size_t n = generator.packet(buf, (double)(due - start) / 1000000000.0);
+
+    if(!dl32.send(buf, n, &stopping)) {
+      if(!stopping) {
+        cout << "[ecusim] can not write to the DL-32 pty." << endl;
+      }
+      break;
+    }
+
+    sent += n;
+    packets++;
+
+    long got = solodl.drain();
+    if(got > 0) {
+      drained += got;
+    }
+
+    /* when is the next one due? */
+
+    uint64_t wire = (baud > 0) ? (uint64_t)((n * 10ULL * 1000000000ULL) / (uint64_t)baud) : 0;
+
+    due += std::max(interval, wire);
+
+    /* if the pty was full (the bridge is behind), we're late */
+
+    uint64_t now = monotonic_ns();
+
+    if(now > due) {
+      late++;
+      due = now;
+    }
+
+    if(now >= report) {
+
+      cout << "[ecusim] " << packets << " packets/s, " << sent << " bytes sent, "
+           << late << " late, " << drained << " SoloDL bytes received; "
+           << generator.getTruncated() << " truncated, " << generator.getBadHeaders()
+           << " bad headers, " << generator.getSubPackets() << " sub-packets so far." << endl;
+
+      packets = 0;
+      late    = 0;
+      report += 1000000000ULL;
+    }
+
+    if((end != 0) && (now >= end)) {
+      break;
+    }
+  }
+
+  cout << "[ecusim] " << generator.getPackets() << " packets sent." << endl;
+
+  /* all done */
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include "Object.hh"
+#include "AIMProtocol.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/*
+ * The reference packets below are what writePacket() in
+ * prototype/AimWriter.py produces; if this file compiles, the
+ * encoding matches.
+ *
+ */
+
+/* channel ids and rates, in the prototype's order */
+
+static_assert(AIMIds[1]  == 1   && AIMIds[2]  == 5   && AIMIds[3]  == 9   && AIMIds[4]  == 13  &&
+              AIMIds[5]  == 17  && AIMIds[6]  == 21  && AIMIds[7]  == 33  && AIMIds[8]  == 45  &&
+              AIMIds[9]  == 69  && AIMIds[10] == 97  && AIMIds[11] == 101 && AIMIds[12] == 105 &&
+              AIMIds[13] == 109 && AIMIds[14] == 113 && AIMIds[15] == 125, "channel ids");
+
+static_assert(AIMRates[1]  == 10 && AIMRates[2]  == 10 && AIMRates[3]  == 5  && AIMRates[4]  == 2  &&
+              AIMRates[5]  == 2  && AIMRates[6]  == 5  && AIMRates[7]  == 5  && AIMRates[8]  == 10 &&
+              AIMRates[9]  == 10 && AIMRates[10] == 2  && AIMRates[11] == 2  && AIMRates[12] == 10 &&
+              AIMRates[13] == 2  && AIMRates[14] == 5  && AIMRates[15] == 2, "channel rates");
+
+/* 82 packets a second, 4100 bits a second; fits easily in 19200 baud */
+
+static_assert(aimLoad() == 82, "protocol load");
+static_assert((aimLoad() * AIMPacketSize * 10) < 19200, "protocol fits the baud rate");
+
+/* the constant part of the checksum */
+
+static_assert(AIMIdSums[1]  == 0xA4, "RPM id sum");
+static_assert(AIMIdSums[15] == 0x20, "ERRORFLAG id sum (wraps)");
+
+/* whole packets: (1, 0) -> 01 a3 00 00 a4 */
+
+constexpr AIMPacket rpmZero = aimPacket<1>(0);
+
+static_assert(rpmZero.bytes[0] == 0x01 && rpmZero.bytes[1] == 0xA3 && rpmZero.bytes[2] == 0x00 &&
+              rpmZero.bytes[3] == 0x00 && rpmZero.bytes[4] == 0xA4, "RPM 0");
+
+/* (1, 0x1234) -> 01 a3 12 34 ea */
+
+constexpr AIMPacket rpm = aimPacket<1>(0x1234);
+
+static_assert(rpm.bytes[0] == 0x01 && rpm.bytes[1] == 0xA3 && rpm.bytes[2] == 0x12 &&
+              rpm.bytes[3] == 0x34 && rpm.bytes[4] == 0xEA, "RPM 0x1234");
+
+/* (5, 6000) -> 05 a3 17 70 2f */
+
+constexpr AIMPacket wheelSpeed = aimPacket<2>(6000);
+
+static_assert(wheelSpeed.bytes[0] == 0x05 && wheelSpeed.bytes[2] == 0x17 &&
+              wheelSpeed.bytes[3] == 0x70 && wheelSpeed.bytes[4] == 0x2F, "WHEELSPEED 6000");
+
+/* (69, 1013) -> 45 a3 03 f5 e0 */
+
+constexpr AIMPacket manifPress = aimPacket<9>(1013);
+
+static_assert(manifPress.bytes[0] == 0x45 && manifPress.bytes[2] == 0x03 &&
+              manifPress.bytes[3] == 0xF5 && manifPress.bytes[4] == 0xE0, "MANIFPRESS 1013");
+
+/* (113, 3) -> 71 a3 00 03 17 */
+
+constexpr AIMPacket gear = aimPacket<14>(3);
+
+static_assert(gear.bytes[0] == 0x71 && gear.bytes[2] == 0x00 &&
+              gear.bytes[3] == 0x03 && gear.bytes[4] == 0x17, "GEAR 3");
+
+/* (125, 0xffff) -> 7d a3 ff ff 1e */
+
+constexpr AIMPacket errorFlag = aimPacket<15>(0xFFFF);
+
+static_assert(errorFlag.bytes[0] == 0x7D && errorFlag.bytes[2] == 0xFF &&
+              errorFlag.bytes[3] == 0xFF && errorFlag.bytes[4] == 0x1E, "ERRORFLAG 0xffff");
+
+/* only the low 16 bits of a value are sent */
+
+static_assert(aimChecksum(1, 0x11234) == aimChecksum(1, 0x1234), "values are 16 bits");
+
+int main(int argc, const char* argv[]) {
+
+  cout << "AIM protocol unit tests..." << endl;
+
+  /* the sender's encoder has to agree with the compile time one */
+
+  unsigned int values[5] = { 0, 1, 0x1234, 0x80FF, 0xFFFF };
+
+  for(int chan=1; chan<=SoloDLChannelMax; chan++) {
+
+    for(int i=0; i<5; i++) {
+
+      unsigned char p[AIMPacketSize];
+
+      aimEncode(p, chan, values[i]);
+
+      /* the prototype's way; sum the 4 bytes, mod 256 */
+
+      unsigned int sum = 0;
+
+      for(int j=0; j<4; j++) {
+        sum += p[j];
+      }
+
+      if((p[0] != AIMIds[chan]) || (p[1] != 0xA3) || (p[2] != ((values[i] >> 8) & 0xFF)) ||
+         (p[3] != (values[i] & 0xFF)) || (p[4] != (sum % 256)) || (p[4] != aimChecksum(chan, values[i]))) {
+        cout << "[FAIL] channel " << chan << " value " << values[i] << endl;
+        return 1;
+      }
+    }
+  }
+
+  cout << "[OK] encoder" << endl;
+
+  cout << "AIM protocol unit testing done." << endl;
+
+  return 0;
+}
@@ -0,0 +1,403 @@
+#include "AIMCANSink.hh"
+#include "CANInput.hh"
+#include "ConfigManager.hh"
+
+#include <fstream>
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/**
+ *
+ * checkStream() - check a sequential stream carries the given
+ * values and has a good tail.
+ *
+ */
+
+bool checkStream(const unsigned char *s, const unsigned int *values) {
+
+  unsigned int sum = 0;
+
+  for(int i=0; i<AIMSeqSize-1; i++) {
+    sum += s[i];
+  }
+
+  if((sum & 0xFF) != s[AIMSeqSize-1]) {
+    cout << "[FAIL] bad checksum " << (int)s[AIMSeqSize-1] << ", expected " << (sum & 0xFF) << endl;
+    return false;
+  }
+
+  if((s[30] != 30) || (s[31] != 0xFC) || (s[32] != 0xFB) || (s[33] != 0xFA)) {
+    cout << "[FAIL] bad count/markers" << endl;
+    return false;
+  }
+
+  for(int chan=1; chan<=SoloDLChannelMax; chan++) {
+
+    unsigned int value = s[2*(chan-1)] | (s[2*(chan-1)+1] << 8);
+
+    if(value != (values[chan] & 0xFFFF)) {
+      cout << "[FAIL] channel " << chan << " is " << value << ", expected " << values[chan] << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ *
+ * readLog() - the frames in test/can-sample.log (run from the top
+ * or from test/).
+ *
+ */
+
+bool readLog(vector<struct can_frame> & frames) {
+
+  ifstream log("can-sample.log");
+
+  if(!log.is_open()) {
+    log.open("test/can-sample.log");
+  }
+
+  if(!log.is_open()) {
+    cout << "[FAIL] can not open can-sample.log" << endl;
+    return false;
+  }
+
+  string line;
+
+  while(getline(log, line)) {
+
+    struct can_frame frame;
+    double stamp = 0.0;
+    string ifName;
+
+    if(CANSocket::parseLog(line, frame, stamp, ifName)) {
+      frames.push_back(frame);
+    }
+  }
+
+  return true;
+}
+
+/**
+ *
+ * checkInput() - the input channels after decoding can-sample.log.
+ *
+ */
+
+bool checkInput(const unsigned int *samples) {
+
+  /*
+   * 6 and 7 from the two 0x5F3 frames (the 2nd is too short for 7);
+   * 11 is 8 again, with a .dbc (motorola) start bit, and 12 is from the
+   * extended 0x5F3, which 6 mustn't pick up.
+   *
+   */
+
+  const int          chans[]    = {6, 7, 8, 9, 11, 12};
+  const unsigned int expected[] = {10, 2000, 0x3456, 2, 0x3456, 12345};
+
+  for(int i=0; i<6; i++) {
+    if(samples[chans[i]] != expected[i]) {
+      cout << "[FAIL] channel " << chans[i] << " is " << samples[chans[i]] << ", expected " << expected[i] << endl;
+      return false;
+    }
+  }
+
+  if((samples[1] != 0) || (samples[10] != 0)) {
+    cout << "[FAIL] unmapped channels were set." << endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "CAN tests..." << endl;
+
+  string ifName = (argc > 1) ? string(argv[1]) : string("vcan0");
+
+  /* the sink and the input both configure from here */
+
+  string iniName = "/tmp/cantest.ini";
+
+  {
+    ofstream ini(iniName.c_str());
+
+    ini << "[aimcan]" << endl << "type = aimcan" << endl << "interface = " << ifName << endl
+        << "can_id = 0x5F0" << endl << "rate_hz = 50" << endl << endl
+        << "[can input]" << endl << "interface = " << ifName << endl
+        << "chan_6 = 0x5F3, 0, 16" << endl
+        << "chan_7 = 0x5F3, 16, 16, little" << endl
+        << "chan_8 = 0x18FEEE00, 8, 16, big" << endl
+        << "chan_9 = 0x18FEEE00, 4, 4, big" << endl
+        << "chan_11 = 0x18FEEE00, 15, 16, motorola" << endl
+        << "chan_12 = 0x5F3x, 0, 16" << endl;
+  }
+
+  ConfigManager::instance(iniName);
+
+  {
+    cout << "[stream] ..." << endl;
+
+    unsigned int  values[SoloDLChannelMax+1];
+    unsigned char stream[AIMSeqSize];
+
+    for(int i=0; i<1000; i++) {
+
+      for(int chan=0; chan<=SoloDLChannelMax; chan++) {
+        values[chan] = (i * 257 + chan * 4099) & 0xFFFF;
+      }
+
+      aimSequential(stream, values);
+
+      if(!checkStream(stream, values)) {
+        return 1;
+      }
+    }
+
+    /* RPM 0x1234 goes out low byte first */
+
+    values[1] = 0x1234;
+
+    aimSequential(stream, values);
+
+    if((stream[0] != 0x34) || (stream[1] != 0x12)) {
+      cout << "[FAIL] not little endian." << endl;
+      return 1;
+    }
+
+    cout << "[OK] stream" << endl;
+  }
+
+  {
+    cout << "[units] ..." << endl;
+
+    /*
+     * known physical values, as the UART carries them (what the output
+     * transforms give), and the bytes PROT_CAN should carry for them
+     *
+     */
+
+    struct {
+      int          chan;
+      const char  *what;
+      unsigned int uart;
+      unsigned int can;
+    } units[] = {
+      {1,  "6500 RPM",            6500,  6500},
+      {2,  "123.4 km/h",          1234,  1234},
+      {3,  "4.5 bar oil",         4500,  45},
+      {4,  "112.3 C oil",         2123,  1123},
+      {5,  "-5.0 C water",        950,   0xFFCE},
+      {6,  "3.04 bar fuel",       3040,  30},
+      {7,  "13.80 V",             1380,  1380},
+      {8,  "87.5 % throttle",     875,   875},
+      {9,  "1013 mbar",           1013,  1013},
+      {10, "35.5 C air",          1355,  355},
+      {11, "752 C EGT",           8520,  752},
+      {12, "0.987 lambda",        987,   987},
+      {13, "28.0 C fuel",         1280,  280},
+      {14, "neutral",             1,     0},
+      {15, "error flags",         0x0042, 0x0042}
+    };
+
+    unsigned int  values[SoloDLChannelMax+1];
+    unsigned char stream[AIMSeqSize];
+
+    values[0] = 0;
+
+    for(auto & u : units) {
+      values[u.chan] = aimCANValue(u.chan, u.uart);
+    }
+
+    aimSequential(stream, values);
+
+    for(auto & u : units) {
+
+      unsigned int value = stream[2*(u.chan-1)] | (stream[2*(u.chan-1)+1] << 8);
+
+      if(value != u.can) {
+        cout << "[FAIL] " << u.what << " went out as " << value << ", expected " << u.can << endl;
+        return 1;
+      }
+    }
+
+    /* gears count from neutral (0) on CAN, from reverse (0) on the UART */
+
+    if((aimCANValue(14, 3) != 2) || (aimCANValue(14, 0) != 0xFFFF)) {
+      cout << "[FAIL] gear is off by one." << endl;
+      return 1;
+    }
+
+    cout << "[OK] units" << endl;
+  }
+
+  vector<struct can_frame> logged;
+
+  {
+    cout << "[candump log] ..." << endl;
+
+    if(!readLog(logged)) {
+      return 1;
+    }
+
+    /* the remote frame isn't data */
+
+    if(logged.size() != 5) {
+      cout << "[FAIL] got " << logged.size() << " frames, expected 5" << endl;
+      return 1;
+    }
+
+    if((logged[1].can_id != (0x18FEEE00 | CAN_EFF_FLAG)) || (logged[2].can_dlc != 2) ||
+       (logged[4].can_id != (0x5F3 | CAN_EFF_FLAG))) {
+      cout << "[FAIL] frames parsed wrong." << endl;
+      return 1;
+    }
+
+    cout << "[OK] candump log" << endl;
+  }
+
+  {
+    cout << "[input fields] ..." << endl;
+
+    CANInput input;
+
+    if(!input.isReady() || !input.isEnabled()) {
+      cout << "[FAIL] can not configure the CAN input." << endl;
+      return 1;
+    }
+
+    unsigned int samples[CMMaxChannels+1];
+
+    memset(samples, 0, sizeof(samples));
+
+    for(auto & frame : logged) {
+      input.decode(frame, samples);
+    }
+
+    if(!checkInput(samples)) {
+      return 1;
+    }
+
+    cout << "[OK] input fields" << endl;
+  }
+
+  /*
+   * end to end on a virtual CAN interface, if there is one:
+   *
+   *   modprobe vcan
+   *   ip link add dev vcan0 type vcan
+   *   ip link set up vcan0
+   *
+   */
+
+  {
+    cout << "[" << ifName << "] ..." << endl;
+
+    CANSocket listener(ifName);
+
+    if(!listener.isReady()) {
+      cout << "[SKIP] no " << ifName << " (see the comments in test/cantest.cc)" << endl;
+      return 0;
+    }
+
+    AIMCANSink sink("aimcan");
+
+    if(sink.onCable() || !sink.configure(50) || !sink.open()) {
+      cout << "[FAIL] can not open the sink." << endl;
+      return 1;
+    }
+
+    /* 10 streams, picking them back up off the bus as they go */
+
+    SampleFrame frame;
+
+    memset(&frame, 0, sizeof(frame));
+
+    unsigned int  expected[SoloDLChannelMax+1];
+    unsigned char stream[AIMSeqFrames * 8];
+    int           got     = 0;
+    int           streams = 0;
+
+    for(int i=0; i<10; i++) {
+
+      for(int chan=1; chan<=SoloDLChannelMax; chan++) {
+        frame.output[chan] = 1000 + i * 100 + chan;
+        expected[chan]     = aimCANValue(chan, frame.output[chan]);
+      }
+
+      if(!sink.send(frame)) {
+        cout << "[FAIL] send failed." << endl;
+        return 1;
+      }
+
+      struct can_frame in;
+
+      while(read(listener.getHandle(), &in, sizeof(in)) == sizeof(in)) {
+
+        if(in.can_id != 0x5F0) {
+          continue;
+        }
+
+        memcpy(stream + got, in.data, in.can_dlc);
+
+        got += in.can_dlc;
+
+        if(got < AIMSeqSize) {
+          continue;
+        }
+
+        if(!checkStream(stream, expected)) {
+          return 1;
+        }
+
+        got = 0;
+        streams++;
+      }
+    }
+
+    if(streams != 10) {
+      cout << "[FAIL] got " << streams << " streams, expected 10" << endl;
+      return 1;
+    }
+
+    cout << sink.describe();
+
+    /* the candump log back in through the CAN input */
+
+    CANInput input;
+
+    if(!input.open()) {
+      cout << "[FAIL] can not open the CAN input." << endl;
+      return 1;
+    }
+
+    if(listener.send(logged.data(), logged.size()) != (int)logged.size()) {
+      cout << "[FAIL] can not send the log." << endl;
+      return 1;
+    }
+
+    unsigned int samples[CMMaxChannels+1];
+    bool fresh = false;
+
+    memset(samples, 0, sizeof(samples));
+
+    if(!input.pollSamples(samples, fresh) || !fresh || !checkInput(samples)) {
+      cout << "[FAIL] CAN input didn't get the log." << endl;
+      return 1;
+    }
+
+    cout << input.describe();
+
+    cout << "[OK] " << ifName << endl;
+  }
+
+  /* all done */
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include "util.hh"
+#include "SerialCapture.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/**
+ *
+ * readAll() - open a capture and read it to the end; how many records
+ * it had, and if the reader is still good after.
+ *
+ */
+
+static bool readAll(const string & fileName, int & count, bool & ready) {
+
+  SerialCapture capture;
+
+  if(!capture.openRead(fileName)) {
+    cout << "[FAIL] can not open " << fileName << ": " << capture.getError() << endl;
+    return false;
+  }
+
+  vector<unsigned char> bytes;
+  uint64_t stamp = 0;
+
+  count = 0;
+
+  while(capture.next(stamp, bytes)) {
+    count++;
+  }
+
+  ready = capture.isReady();
+
+  return true;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "Serial capture unit tests..." << endl;
+
+  string fileName = "/tmp/capturetest.cap";
+
+  {
+    cout << "[write/read] ..." << endl;
+
+    SerialCapture capture;
+
+    unsigned char bytes[] = {0x81, 0x00, 0x12, 0x34, 0x56};
+
+    if(!capture.create(fileName) || !capture.append(1000, bytes, sizeof(bytes)) ||
+       !capture.append(2000, bytes, 2)) {
+      cout << "[FAIL] can not write " << fileName << ": " << capture.getError() << endl;
+      return 1;
+    }
+
+    capture.close();
+
+    int  count = 0;
+    bool ready = false;
+
+    if(!readAll(fileName, count, ready)) {
+      return 1;
+    }
+
+    /* a clean end leaves the reader good (it can rewind) */
+
+    if((count != 2) || !ready) {
+      cout << "[FAIL] read " << count << " records, " << (ready ? "ready" : "not ready") << endl;
+      return 1;
+    }
+
+    cout << "[OK] write/read" << endl;
+  }
+
+  {
+    cout << "[truncated] ..." << endl;
+
+    struct stat info;
+
+    if(stat(fileName.c_str(), &info) != 0) {
+      cout << "[FAIL] can not stat " << fileName << endl;
+      return 1;
+    }
+
+    /* part way through the last record's bytes, then its stamp */
+
+    off_t cuts[] = {info.st_size - 1, info.st_size - 2 - 2 - 4};
+
+    for(auto cut : cuts) {
+
+      int  count = 0;
+      bool ready = true;
+
+      if((truncate(fileName.c_str(), cut) != 0) || !readAll(fileName, count, ready)) {
+        cout << "[FAIL] can not truncate " << fileName << " to " << cut << endl;
+        return 1;
+      }
+
+      if((count != 1) || ready) {
+        cout << "[FAIL] cut to " << cut << ": read " << count << " records, "
+             << (ready ? "ready" : "not ready") << ", should be damaged." << endl;
+        return 1;
+      }
+    }
+
+    cout << "[OK] truncated" << endl;
+  }
+
+  unlink(fileName.c_str());
+
+  cout << "done." << endl;
+
+  return 0;
+}
@@ -0,0 +1,592 @@
+#include "ChannelManager.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/* frames per timing run */
+
+static const int BenchFrames = 1000000;
+
+/**
+ *
+ * same() - load() and loadChained() have to agree, on every channel,
+ * for lots of made up frames (including the edges).
+ *
+ */
+
+static bool same(ChannelManager & cm) {
+
+  unsigned int input[CMMaxChannels+1];
+  unsigned int normal1[CMMaxChannels+1], output1[CMMaxChannels+1];
+  unsigned int normal2[CMMaxChannels+1], output2[CMMaxChannels+1];
+
+  for(int n=0; n<10000; n++) {
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+
+      switch(n) {
+        case 0:
+          input[i] = 0;
+          break;
+        case 1:
+          input[i] = 0xFFFF;
+          break;
+        default:
+          input[i] = (unsigned int)(rand() % 100000);
+          break;
+      }
+    }
+
+    if(!cm.load(input, normal1, output1) || !cm.loadChained(input, normal2, output2)) {
+      cout << "[FAIL] can not load: " << cm.getError() << endl;
+      return false;
+    }
+
+    for(int i=1; i<=CMMaxChannels; i++) {
+
+      if((normal1[i] != normal2[i]) || (output1[i] != output2[i])) {
+        cout << "[FAIL] channel " << i << " of " << input[i] << ": compiled " << normal1[i] << "/"
+             << output1[i] << ", chained " << normal2[i] << "/" << output2[i] << endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ *
+ * bench() - ns per frame for load() and loadChained().
+ *
+ */
+
+static void bench(ChannelManager & cm, const string & what) {
+
+  unsigned int input[CMMaxChannels+1];
+  unsigned int normal[CMMaxChannels+1], output[CMMaxChannels+1];
+
+  for(int i=0; i<=CMMaxChannels; i++) {
+    input[i] = (unsigned int)(rand() % 10000);
+  }
+
+  uint64_t start = monotonic_ns();
+
+  for(int n=0; n<BenchFrames; n++) {
+    input[1] = (unsigned int)n;
+    cm.loadChained(input, normal, output);
+  }
+
+  uint64_t chained = monotonic_ns() - start;
+
+  start = monotonic_ns();
+
+  for(int n=0; n<BenchFrames; n++) {
+    input[1] = (unsigned int)n;
+    cm.load(input, normal, output);
+  }
+
+  uint64_t compiled = monotonic_ns() - start;
+
+  char buf[1024];
+
+  sprintf(buf, "  %-24s %2d/30 compiled, chained %6.1f ns/frame, compiled %6.1f ns/frame",
+    what.c_str(), cm.compiled(), (double)chained / BenchFrames, (double)compiled / BenchFrames);
+
+  cout << buf << endl;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "Channel manager load() benchmark..." << endl;
+
+  srand(1);
+
+  IniFile & ini = ConfigManager::instance((argc > 1) ? string(argv[1]) : string("etc/ecubridge.ini"));
+
+  if(!ini.isReady()) {
+    cout << "[FAIL] can not read the configuration (run from the top, or give an .ini file)." << endl;
+    return 1;
+  }
+
+  ChannelManager cm;
+
+  if(!cm.isReady()) {
+    cout << "[FAIL] can not configure channel manager: " << cm.getError() << endl;
+    return 1;
+  }
+
+  {
+    cout << "[as configured] ..." << endl;
+
+    if(!same(cm)) {
+      return 1;
+    }
+
+    bench(cm, "as configured");
+
+    cout << "[OK] as configured" << endl;
+  }
+
+  {
+    cout << "[all passthrough] ..." << endl;
+
+    for(int i=1; i<=CMMaxChannels; i++) {
+      cm.setInputFilter(i, new PassthroughTransform());
+    }
+
+    if(!same(cm)) {
+      return 1;
+    }
+
+    bench(cm, "all passthrough");
+
+    cout << "[OK] all passthrough" << endl;
+  }
+
+  {
+    cout << "[patched, manual] ..." << endl;
+
+    /* reverse the channels, so most pull from a later one */
+
+    for(int i=1; i<=(CMMaxChannels/2); i++) {
+      cm.patch(i, CMMaxChannels + 1 - i);
+    }
+
+    DataTransformer *manual = new ManualTransform();
+
+    manual->setParam(0, 42);
+
+    cm.setInputFilter(3, manual);
+    cm.setOutputFilter(9, new NullTransform());
+
+    if(!same(cm)) {
+      return 1;
+    }
+
+    bench(cm, "patched, manual");
+
+    cout << "[OK] patched, manual" << endl;
+  }
+
+  {
+    cout << "[table filters] ..." << endl;
+
+    /* a made up thermistor, and a table through a scaling transform */
+
+    ini.setValue("table thermistor", "step", "1024");
+    ini.setValue("table thermistor", "values", "150, 100, 60, 35, 20");
+    ini.setValue("input filter", "chan_2", "table, thermistor");
+    ini.setValue("output filter", "chan_3", "table, thermistor");
+
+    ChannelManager tables(ini);
+
+    if(!tables.isReady()) {
+      cout << "[FAIL] can not configure table filters: " << tables.getError() << endl;
+      return 1;
+    }
+
+    if(!same(tables)) {
+      return 1;
+    }
+
+    vector<unsigned int> normal;
+    vector<unsigned int> output;
+
+    if(!tables.curve(2, normal, output) || (normal.size() != LookupSize)) {
+      cout << "[FAIL] can not get channel 2's curve: " << tables.getError() << endl;
+      return 1;
+    }
+
+    /* on a point, half way down (rounded), and held past the last point */
+
+    if((normal[0] != 150) || (normal[1024] != 100) || (normal[1536] != 80) ||
+       (normal[1023] != 100) || (normal[4095] != 20)) {
+      cout << "[FAIL] table values are wrong: " << normal[0] << " " << normal[1024] << " "
+           << normal[1536] << " " << normal[1023] << " " << normal[4095] << endl;
+      return 1;
+    }
+
+    bench(tables, "table filters");
+
+    cout << "[OK] table filters" << endl;
+  }
+
+  {
+    cout << "[curve filters] ..." << endl;
+
+    ini.setValue("input filter", "chan_3", "piecewise, 100:0, 1100:500, 3100:4500");
+    ini.setValue("output filter", "chan_3", "passthrough");
+    ini.setValue("input filter", "chan_4", "poly, 10, 0.5, 0.001");
+    ini.setValue("input filter", "chan_5", "deadband, 2048, 16");
+    ini.setValue("output filter", "chan_1", "clamp, 1000, 9000");
+    ini.setValue("output filter", "chan_4", "poly, -40, 0.25");
+
+    ChannelManager curves(ini);
+
+    if(!curves.isReady()) {
+      cout << "[FAIL] can not configure curve filters: " << curves.getError() << endl;
+      return 1;
+    }
+
+    if(!same(curves)) {
+      return 1;
+    }
+
+    vector<unsigned int> normal;
+    vector<unsigned int> output;
+
+    struct {
+      int          chan;
+      unsigned int x;
+      unsigned int normal;
+      unsigned int output;
+    } expect[] = {
+      {3,   50,     0,       0},  /* flat before the first point (oil press x 1000) */
+      {3,  600,   250,  250000},
+      {3, 2100,  2500, 2500000},
+      {3, 4000,  4500, 4500000},  /* flat after the last */
+      {4,  100,    70,    1000},  /* 10 + 50 + 10; 70/4 - 40 < 0, so (0 + 100) * 10 */
+      {4, 1000,  1510,    4380},  /* 1510/4 - 40 = 337.5, rounded up, (338 + 100) * 10 */
+      {5, 2040,  2048, 21480},  /* within the deadband (water temp, (x + 100) * 10) */
+      {5, 2000,  2000, 21000},
+      {1,  500,   500,  1000},  /* clamped on the way out */
+      {1, 4095,  4095,  4095}
+    };
+
+    for(auto & e : expect) {
+
+      if(!curves.curve(e.chan, normal, output)) {
+        cout << "[FAIL] can not get channel " << e.chan << "'s curve: " << curves.getError() << endl;
+        return 1;
+      }
+
+      if((normal[e.x] != e.normal) || (output[e.x] != e.output)) {
+        cout << "[FAIL] channel " << e.chan << " at " << e.x << ": " << normal[e.x] << "/" << output[e.x]
+             << ", expected " << e.normal << "/" << e.output << endl;
+        return 1;
+      }
+    }
+
+    bench(curves, "curve filters");
+
+    cout << "[OK] curve filters" << endl;
+  }
+
+  {
+    cout << "[stream filters] ..." << endl;
+
+    ini.setValue("input filter", "chan_1", "ema, 0.5");
+    ini.setValue("input filter", "chan_2", "average, 4");
+    ini.setValue("input filter", "chan_3", "median, 3");
+    ini.setValue("input filter", "chan_4", "rate, 10");
+    ini.setValue("input filter", "chan_5", "debounce, 3");
+
+    ChannelManager streams(ini);
+
+    if(!streams.isReady()) {
+      cout << "[FAIL] can not configure stream filters: " << streams.getError() << endl;
+      return 1;
+    }
+
+    /* one sample at a time, a column per channel */
+
+    unsigned int samples[7][6] = {
+      {0, 100, 10,  10,   0, 2},
+      {0, 200, 20, 500, 100, 3},  /* a spike on 3 */
+      {0, 200, 30,  12, 100, 3},
+      {0, 200, 40,  14,   5, 2},
+      {0, 200, 50,  13,   5, 3},
+      {0, 200, 50,  13,   5, 3},
+      {0, 200, 50,  13,   5, 3}
+    };
+
+    unsigned int expect[7][6] = {
+      {0, 100, 10,  10,   0, 2},
+      {0, 150, 15,  10,  10, 2},
+      {0, 175, 20,  12,  20, 2},
+      {0, 188, 25,  14,  10, 2},
+      {0, 194, 35,  13,   5, 2},
+      {0, 197, 43,  13,   5, 2},
+      {0, 198, 48,  13,   5, 3}
+    };
+
+    unsigned int input[CMMaxChannels+1];
+    unsigned int normal[CMMaxChannels+1], output[CMMaxChannels+1];
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+      input[i] = 0;
+    }
+
+    for(int n=0; n<7; n++) {
+
+      for(int i=1; i<=5; i++) {
+        input[i] = samples[n][i];
+      }
+
+      if(!streams.load(input, normal, output)) {
+        cout << "[FAIL] can not load: " << streams.getError() << endl;
+        return 1;
+      }
+
+      for(int i=1; i<=5; i++) {
+
+        if(normal[i] != expect[n][i]) {
+          cout << "[FAIL] sample " << n << " on channel " << i << ": " << normal[i]
+               << ", expected " << expect[n][i] << endl;
+          return 1;
+        }
+      }
+    }
+
+    /* no new samples, the same again; and curve() doesn't disturb them */
+
+    vector<unsigned int> curveNormal;
+    vector<unsigned int> curveOutput;
+
+    if(!streams.curve(1, curveNormal, curveOutput) || (curveNormal[1234] != 1234)) {
+      cout << "[FAIL] channel 1's curve should be settled: " << streams.getError() << endl;
+      return 1;
+    }
+
+    input[1] = 0;
+    input[2] = 0;
+
+    if(!streams.load(input, normal, output, 0) || (normal[1] != 198) || (normal[2] != 48)) {
+      cout << "[FAIL] without a new sample, the last value: " << normal[1] << " " << normal[2] << endl;
+      return 1;
+    }
+
+    if(!streams.load(input, normal, output) || (normal[1] != 99) || (normal[2] != 38)) {
+      cout << "[FAIL] new samples after a curve(): " << normal[1] << " " << normal[2] << endl;
+      return 1;
+    }
+
+    bench(streams, "stream filters");
+
+    cout << "[OK] stream filters" << endl;
+  }
+
+  {
+    cout << "[stream of a constant] ..." << endl;
+
+    /* a manual channel into a streaming filter isn't folded from one sample */
+
+    ini.setValue("input filter", "chan_1", "passthrough");
+    ini.setValue("input filter", "chan_7", "manual, 42");
+    ini.setValue("output filter", "chan_7", "average, 4");
+
+    ChannelManager steady(ini);
+
+    if(!steady.isReady()) {
+      cout << "[FAIL] can not configure a stream of a constant: " << steady.getError() << endl;
+      return 1;
+    }
+
+    unsigned int input[CMMaxChannels+1];
+    unsigned int normal[CMMaxChannels+1], output[CMMaxChannels+1];
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+      input[i] = 0;
+    }
+
+    input[1] = 2000;
+
+    /* fill chan_7's average from the (live) chan_1, then patch the 42 back */
+
+    steady.patch(1, 7);
+
+    for(int n=0; n<4; n++) {
+      steady.load(input, normal, output);
+    }
+
+    steady.patch(1, 7);
+
+    /* batt volt x 1000; a sample a frame, without chan_7 ever being new */
+
+    for(int n=0; n<4; n++) {
+      steady.load(input, normal, output, 0);
+    }
+
+    if((normal[7] != 42) || (output[7] != 42000)) {
+      cout << "[FAIL] chan_7 should have settled on 42: " << normal[7] << "/" << output[7] << endl;
+      return 1;
+    }
+
+    ini.setValue("input filter", "chan_7", "null");
+    ini.setValue("output filter", "chan_7", "passthrough");
+
+    cout << "[OK] stream of a constant" << endl;
+  }
+
+  {
+    cout << "[expressions] ..." << endl;
+
+    unsigned int normal[CMMaxChannels+1];
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+      normal[i] = (unsigned int)(i * 100);
+    }
+
+    struct {
+      const char   *text;
+      int           size;
+      unsigned int  value;
+    } expect[] = {
+      {"2 * (3 + 4) - max(1, 5)",            1,   9},  /* all folded */
+      {"chan_3 / 0",                         3,   0},
+      {"-chan_1 + 250",                      4, 150},
+      {"chan_1 * 0.0125",                    3,   1},  /* 1.25, rounded */
+      {"(chan_4 > 350) + 2 * (chan_2 <= 150) + 4 * !0", 11, 5},
+      {"min(chan_5, 1000) == 500 && abs(-chan_1) >= 100", 11, 1},
+      {"chan_1 - 2000",                      3,   0},  /* kept to 0.. */
+    };
+
+    for(auto & e : expect) {
+
+      ChannelExpression expr;
+
+      if(!expr.compile(e.text) || (expr.size() != e.size) || (expr.eval(normal) != e.value)) {
+        cout << "[FAIL] " << e.text << ": " << expr.size() << " steps, " << expr.eval(normal)
+             << ", expected " << e.size << " steps, " << e.value << endl;
+        return 1;
+      }
+    }
+
+    const char *bad[] = {"chan_16", "1 +", "(1", "max(1)", "foo(2)", "1 $ 2", ""};
+
+    for(auto text : bad) {
+
+      ChannelExpression expr;
+
+      if(expr.compile(text)) {
+        cout << "[FAIL] should not compile: " << text << endl;
+        return 1;
+      }
+    }
+
+    cout << "[OK] expressions" << endl;
+  }
+
+  {
+    cout << "[can mapped] ..." << endl;
+
+    for(int i=1; i<=5; i++) {
+      ini.setValue("input filter", string("chan_") + to_string(i), "passthrough");
+    }
+
+    /* CAN fields come in as raw counts, they mustn't hit a null transform */
+
+    ini.setValue("can input", "chan_6", "0x5F3, 0, 16");
+    ini.setValue("can input", "chan_8", "0x5F3, 16, 16");
+    ini.setValue("input filter", "chan_6", "passthrough");
+    ini.setValue("input filter", "chan_8", "poly, 0, 2");
+    ini.setValue("output filter", "chan_6", "passthrough");
+    ini.setValue("output filter", "chan_8", "passthrough");
+
+    ChannelManager mapped(ini);
+
+    if(!mapped.isReady()) {
+      cout << "[FAIL] can not configure CAN mapped channels: " << mapped.getError() << endl;
+      return 1;
+    }
+
+    if(!same(mapped)) {
+      return 1;
+    }
+
+    unsigned int input[CMMaxChannels+1];
+    unsigned int normal[CMMaxChannels+1], output[CMMaxChannels+1];
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+      input[i] = 0;
+    }
+
+    input[6] = 1234;
+    input[8] = 300;
+
+    /* fuel press x 1000, throttle x 10 */
+
+    if(!mapped.load(input, normal, output) || (normal[6] != 1234) || (output[6] != 1234000) ||
+       (normal[8] != 600) || (output[8] != 6000)) {
+      cout << "[FAIL] CAN mapped values are wrong: " << normal[6] << "/" << output[6] << " "
+           << normal[8] << "/" << output[8] << endl;
+      return 1;
+    }
+
+    ini.setValue("can input", "chan_6", "");
+    ini.setValue("can input", "chan_8", "");
+
+    cout << "[OK] can mapped" << endl;
+  }
+
+  {
+    cout << "[derived channels] ..." << endl;
+
+    for(int i=1; i<=5; i++) {
+      ini.setValue("input filter", string("chan_") + to_string(i), "passthrough");
+    }
+
+    /* gear from rpm / wheel speed, and an error flag from limits */
+
+    ini.setValue("derived", "chan_14", "1 + (chan_1 / max(chan_2, 1) < 150) + (chan_1 / max(chan_2, 1) < 100)");
+    ini.setValue("derived", "chan_15", "(chan_4 > 1200) + 2 * (chan_3 < 50) + 4 * (chan_14 > 2)");
+    ini.setValue("input filter", "chan_14", "passthrough");
+    ini.setValue("input filter", "chan_15", "passthrough");
+
+    ChannelManager derived(ini);
+
+    if(!derived.isReady()) {
+      cout << "[FAIL] can not configure derived channels: " << derived.getError() << endl;
+      return 1;
+    }
+
+    if(!same(derived)) {
+      return 1;
+    }
+
+    unsigned int input[CMMaxChannels+1];
+    unsigned int normal[CMMaxChannels+1], output[CMMaxChannels+1];
+
+    for(int i=0; i<=CMMaxChannels; i++) {
+      input[i] = 0;
+    }
+
+    input[1] = 3000;
+    input[2] = 25;
+    input[3] = 40;
+    input[4] = 1300;
+
+    if(!derived.load(input, normal, output) || (normal[14] != 2) || (normal[15] != 3)) {
+      cout << "[FAIL] derived values are wrong: " << normal[14] << " " << normal[15] << endl;
+      return 1;
+    }
+
+    input[2] = 40;
+
+    if(!derived.load(input, normal, output) || (normal[14] != 3) || (normal[15] != 7)) {
+      cout << "[FAIL] derived values are wrong: " << normal[14] << " " << normal[15] << endl;
+      return 1;
+    }
+
+    bench(derived, "derived channels");
+
+    /* only lower derived channels can be used */
+
+    ini.setValue("derived", "chan_6", "chan_14 * 10");
+
+    ChannelManager later(ini);
+
+    if(later.isReady()) {
+      cout << "[FAIL] chan_6 should not be able to use chan_14." << endl;
+      return 1;
+    }
+
+    cout << "[OK] derived channels" << endl;
+  }
+
+  cout << "done." << endl;
+
+  return 0;
+}
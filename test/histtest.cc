@@ -0,0 +1,97 @@
+#include "util.hh"
+#include "Histogram.hh"
+
+int main(int argc, const char* argv[]) {
+
+  cout << "Histogram unit tests..." << endl;
+
+  {
+    cout << "[empty] ..." << endl;
+
+    Histogram hist;
+
+    if((hist.count() != 0) || (hist.percentile(50.0) != 0) || (hist.max() != 0)) {
+      cout << "[FAIL] empty histogram isn't empty." << endl;
+      return 1;
+    }
+
+    cout << "[OK] empty: " << hist.summary() << endl;
+  }
+
+  {
+    cout << "[percentile] ..." << endl;
+
+    Histogram hist;
+
+    /* 1..100000 once each, so pXX should be XX% of 100000 */
+
+    for(uint32_t i=1; i<=100000; i++) {
+      hist.record(i);
+    }
+
+    if(hist.count() != 100000) {
+      cout << "[FAIL] wrong count: " << hist.count() << endl;
+      return 1;
+    }
+
+    if(hist.max() != 100000) {
+      cout << "[FAIL] wrong max: " << hist.max() << endl;
+      return 1;
+    }
+
+    double checks[] = { 50.0, 90.0, 99.0, 99.9 };
+
+    for(int i=0; i<4; i++) {
+
+      double   expect = checks[i] * 1000.0;
+      uint32_t value  = hist.percentile(checks[i]);
+
+      /* buckets are 1/16th of a power of two, so within ~6.25% */
+
+      if((value < expect) || (value > (expect * 1.0625))) {
+        cout << "[FAIL] p" << checks[i] << " is " << value << " expected ~" << expect << endl;
+        return 1;
+      }
+    }
+
+    cout << "[OK] percentile: " << hist.summary() << endl;
+  }
+
+  {
+    cout << "[small/large] ..." << endl;
+
+    Histogram hist;
+
+    hist.record(0);
+    hist.record(7);
+    hist.record(0xFFFFFFFF);
+
+    if(hist.percentile(1.0) != 0) {
+      cout << "[FAIL] p1 should be exact for small values: " << hist.percentile(1.0) << endl;
+      return 1;
+    }
+
+    if(hist.percentile(50.0) != 7) {
+      cout << "[FAIL] p50 should be exact for small values: " << hist.percentile(50.0) << endl;
+      return 1;
+    }
+
+    if(hist.percentile(100.0) != 0xFFFFFFFF) {
+      cout << "[FAIL] p100 should be the max: " << hist.percentile(100.0) << endl;
+      return 1;
+    }
+
+    hist.reset();
+
+    if(hist.count() != 0) {
+      cout << "[FAIL] reset() didn't." << endl;
+      return 1;
+    }
+
+    cout << "[OK] small/large" << endl;
+  }
+
+  cout << "Histogram unit testing done." << endl;
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+#include "DL32Parser.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/**
+ *
+ * packet() - build a DL-32 packet with the given channel values
+ * (the words as the DL-32 sends them), returns the # of bytes.
+ *
+ */
+
+size_t packet(unsigned char *buf, const unsigned int *values, int channels) {
+
+  size_t n = 0;
+
+  buf[n++] = 0xA2 | ((channels >> 7) & 0x01);
+  buf[n++] = 0x80 | (channels & 0x7F);
+
+  for(int i=0; i<channels; i++) {
+    buf[n++] = (values[i] >> 8) & 0x3F;
+    buf[n++] = values[i] & 0x7F;
+  }
+
+  return n;
+}
+
+/**
+ *
+ * same() - check a frame has the given values.
+ *
+ */
+
+bool same(const DL32Frame & frame, const unsigned int *values, int channels) {
+
+  if(frame.channels != channels) {
+    cout << "[FAIL] got " << frame.channels << " channels, expected " << channels << endl;
+    return false;
+  }
+
+  for(int i=0; i<channels; i++) {
+    if(frame.samples[i+1] != values[i]) {
+      cout << "[FAIL] channel " << (i+1) << " is " << frame.samples[i+1] << ", expected " << values[i] << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "DL-32 parser unit tests..." << endl;
+
+  unsigned int a[5] = { 100, 0x0110, 0x0205, 0x0300, 0x0A7F };
+  unsigned int b[5] = { 1, 2, 3, 4, 5 };
+
+  unsigned char buf[256];
+  DL32Frame     frame;
+
+  {
+    cout << "[one packet] ..." << endl;
+
+    DL32Parser parser;
+
+    size_t n = packet(buf, a, 5);
+
+    if((parser.feed(buf, n, 42) != 1) || !parser.next(frame) || !same(frame, a, 5) || (frame.stamp != 42)) {
+      cout << "[FAIL] one packet" << endl;
+      return 1;
+    }
+
+    cout << "[OK] one packet" << endl;
+  }
+
+  {
+    cout << "[split packets] ..." << endl;
+
+    DL32Parser parser;
+
+    /* two packets, fed a byte at a time */
+
+    size_t n = packet(buf, a, 5);
+    n += packet(buf + n, b, 5);
+
+    size_t got = 0;
+
+    for(size_t i=0; i<n; i++) {
+
+      got += parser.feed(buf + i, 1, i);
+
+      if((i == 0) && !parser.partial()) {
+        cout << "[FAIL] a header byte didn't start a packet." << endl;
+        return 1;
+      }
+    }
+
+    if((got != 2) || (parser.pending() != 2)) {
+      cout << "[FAIL] expected 2 frames, got " << got << endl;
+      return 1;
+    }
+
+    if(!parser.next(frame) || !same(frame, a, 5) || !parser.next(frame) || !same(frame, b, 5)) {
+      return 1;
+    }
+
+    if(parser.getResyncs() != 0) {
+      cout << "[FAIL] clean input caused a resync." << endl;
+      return 1;
+    }
+
+    cout << "[OK] split packets" << endl;
+  }
+
+  {
+    cout << "[garbage and resync] ..." << endl;
+
+    DL32Parser parser;
+
+    size_t n = 0;
+
+    /* junk, a false header, a packet, more junk, a packet */
+
+    buf[n++] = 0x01;
+    buf[n++] = 0x7F;
+    buf[n++] = 0xA2;
+    buf[n++] = 0x05;
+
+    n += packet(buf + n, a, 5);
+
+    buf[n++] = 0x33;
+
+    n += packet(buf + n, b, 5);
+
+    if(parser.feed(buf, n, 7) != 2) {
+      cout << "[FAIL] expected 2 frames." << endl;
+      return 1;
+    }
+
+    if(!parser.latest(frame) || !same(frame, b, 5) || (parser.pending() != 0)) {
+      cout << "[FAIL] latest() should give the newest and drop the rest." << endl;
+      return 1;
+    }
+
+    if((parser.getSkipped() != 5) || (parser.getResyncs() != 2)) {
+      cout << "[FAIL] skipped " << parser.getSkipped() << " bytes in " << parser.getResyncs()
+           << " resyncs, expected 5 in 2" << endl;
+      return 1;
+    }
+
+    cout << "[OK] garbage and resync" << endl;
+  }
+
+  {
+    cout << "[overflow] ..." << endl;
+
+    DL32Parser parser;
+
+    for(int i=0; i<(DL32ParserMaxFrames + 3); i++) {
+
+      b[0] = i;
+
+      size_t n = packet(buf, b, 5);
+
+      parser.feed(buf, n, i);
+    }
+
+    if((parser.pending() != DL32ParserMaxFrames) || (parser.getOverwritten() != 3)) {
+      cout << "[FAIL] queue didn't keep the newest frames." << endl;
+      return 1;
+    }
+
+    if(!parser.next(frame) || (frame.samples[1] != 3)) {
+      cout << "[FAIL] oldest frame should be #3, got " << frame.samples[1] << endl;
+      return 1;
+    }
+
+    cout << "[OK] overflow" << endl;
+  }
+
+  cout << "DL-32 parser unit testing done." << endl;
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "Object.hh"
+#include "PhaseEstimator.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/* a made up DL-32; 85ms frames, +/- 'wobble' ns of jitter */
+
+static const uint64_t FramePeriod = 85000000ULL;
+
+static uint64_t frameAt(uint64_t start, int n, uint64_t wobble) {
+
+  uint64_t t = start + ((uint64_t)n * FramePeriod);
+
+  if(wobble > 0) {
+    t += (uint64_t)(rand() % (2 * wobble)) - wobble;
+  }
+
+  return t;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "Phase estimator unit tests..." << endl;
+
+  srand(1);
+
+  const uint64_t start = 1000000000ULL;
+
+  {
+    cout << "[steady frames] ..." << endl;
+
+    PhaseEstimator estimator;
+
+    for(int n=0; n<3; n++) {
+      estimator.arrival(frameAt(start, n, 0));
+    }
+
+    if(estimator.locked(frameAt(start, 2, 0))) {
+      cout << "[FAIL] locked after only 3 frames." << endl;
+      return 1;
+    }
+
+    for(int n=3; n<50; n++) {
+      estimator.arrival(frameAt(start, n, 0));
+    }
+
+    uint64_t now = frameAt(start, 49, 0) + 1000000ULL;
+
+    if(!estimator.locked(now)) {
+      cout << "[FAIL] not locked after 50 frames." << endl;
+      return 1;
+    }
+
+    uint64_t predicted = estimator.next(now);
+
+    if(predicted != frameAt(start, 50, 0)) {
+      cout << "[FAIL] predicted " << predicted << " expected " << frameAt(start, 50, 0) << endl;
+      return 1;
+    }
+
+    cout << "[OK] steady frames" << endl;
+  }
+
+  {
+    cout << "[jitter and missed frames] ..." << endl;
+
+    PhaseEstimator estimator;
+
+    /* 1ms of jitter, and every 7th frame goes missing */
+
+    for(int n=0; n<200; n++) {
+
+      if((n % 7) == 6) {
+        continue;
+      }
+
+      estimator.arrival(frameAt(start, n, 1000000ULL));
+    }
+
+    uint64_t now       = frameAt(start, 199, 0) + 1000000ULL;
+    uint64_t predicted = estimator.next(now);
+    uint64_t expected  = frameAt(start, 200, 0);
+    uint64_t err       = (predicted > expected) ? (predicted - expected) : (expected - predicted);
+
+    if(!estimator.locked(now) || (err > 1000000ULL)) {
+      cout << "[FAIL] prediction off by " << err << " ns" << endl;
+      return 1;
+    }
+
+    uint64_t period = estimator.getPeriod();
+
+    if((period < (FramePeriod - 200000ULL)) || (period > (FramePeriod + 200000ULL))) {
+      cout << "[FAIL] period " << period << " expected ~" << FramePeriod << endl;
+      return 1;
+    }
+
+    cout << "[OK] jitter and missed frames" << endl;
+  }
+
+  {
+    cout << "[silent input] ..." << endl;
+
+    PhaseEstimator estimator;
+
+    for(int n=0; n<20; n++) {
+      estimator.arrival(frameAt(start, n, 0));
+    }
+
+    /* the same frame again changes nothing */
+
+    estimator.arrival(frameAt(start, 19, 0));
+
+    if(!estimator.locked(frameAt(start, 20, 0))) {
+      cout << "[FAIL] a repeated frame broke the lock." << endl;
+      return 1;
+    }
+
+    /* nothing for half a second; back to the fixed cadence */
+
+    if(estimator.locked(frameAt(start, 19, 0) + 500000000ULL)) {
+      cout << "[FAIL] still locked with no input." << endl;
+      return 1;
+    }
+
+    cout << "[OK] silent input" << endl;
+  }
+
+  cout << "Phase estimator unit testing done." << endl;
+
+  return 0;
+}
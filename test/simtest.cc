@@ -0,0 +1,257 @@
+#include "MTSGenerator.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/**
+ *
+ * matches() - check a parsed frame has what the generator put in
+ * its last packet.
+ *
+ */
+
+bool matches(const DL32Frame & frame, const MTSGenerator & generator) {
+
+  int channels = std::min(generator.getChannels(), (int)DL32ChannelMax);
+
+  if(frame.channels != channels) {
+    cout << "[FAIL] got " << frame.channels << " channels, expected " << channels << endl;
+    return false;
+  }
+
+  for(int chan=1; chan<=channels; chan++) {
+    unsigned int expected = MTSGenerator::word(generator.getValue(chan));
+    if(frame.samples[chan] != expected) {
+      cout << "[FAIL] channel " << chan << " is " << frame.samples[chan] << ", expected " << expected << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "MTS generator unit tests..." << endl;
+
+  unsigned char buf[MTSMaxPacket];
+  DL32Frame     frame;
+
+  {
+    cout << "[clean packets] ..." << endl;
+
+    MTSWaveform waves[3] = { MTSWaveform::RAMP, MTSWaveform::SINE, MTSWaveform::NOISE };
+
+    for(int w=0; w<3; w++) {
+
+      MTSGenerator generator;
+      DL32Parser   parser;
+
+      generator.configure(5, waves[w], 1.0);
+
+      for(int i=0; i<200; i++) {
+
+        size_t n = generator.packet(buf, (double)i / 100.0);
+
+        if((parser.feed(buf, n, i+1) != 1) || !parser.next(frame) || !matches(frame, generator)) {
+          cout << "[FAIL] packet " << i << " of waveform " << w << endl;
+          return 1;
+        }
+
+        for(int chan=1; chan<=5; chan++) {
+          if(generator.getValue(chan) > 1023) {
+            cout << "[FAIL] value out of range: " << generator.getValue(chan) << endl;
+            return 1;
+          }
+        }
+      }
+
+      if((parser.getSkipped() != 0) || (parser.getResyncs() != 0)) {
+        cout << "[FAIL] clean packets were skipped." << endl;
+        return 1;
+      }
+    }
+
+    cout << "[OK] clean packets" << endl;
+  }
+
+  {
+    cout << "[more channels than the DL-32] ..." << endl;
+
+    MTSGenerator generator;
+    DL32Parser   parser;
+
+    generator.configure(MTSMaxChannels, MTSWaveform::SINE, 2.0);
+
+    size_t n = generator.packet(buf, 0.3);
+
+    if((n != (size_t)(2 + (2 * MTSMaxChannels))) || (parser.feed(buf, n, 1) != 1) ||
+       !parser.next(frame) || !matches(frame, generator)) {
+      cout << "[FAIL] wide packet" << endl;
+      return 1;
+    }
+
+    cout << "[OK] more channels than the DL-32" << endl;
+  }
+
+  {
+    cout << "[sub-packets] ..." << endl;
+
+    MTSGenerator generator;
+    DL32Parser   parser;
+
+    generator.configure(5, MTSWaveform::RAMP, 1.0);
+    generator.setFaults(0.0, 0.0, 1.0);
+
+    for(int i=0; i<100; i++) {
+
+      size_t n = generator.packet(buf, (double)i / 100.0);
+
+      if(n != 14) {
+        cout << "[FAIL] sub-packet not added" << endl;
+        return 1;
+      }
+
+      /* LM-1/LC-1 words are skipped, the aux channels come through */
+
+      if((parser.feed(buf, n, i+1) != 1) || !parser.next(frame) || !matches(frame, generator)) {
+        cout << "[FAIL] packet " << i << " with a sub-packet" << endl;
+        return 1;
+      }
+    }
+
+    cout << "[OK] sub-packets" << endl;
+  }
+
+  {
+    cout << "[bad headers] ..." << endl;
+
+    MTSGenerator generator;
+    DL32Parser   parser;
+
+    generator.configure(5, MTSWaveform::RAMP, 1.0);
+    generator.setFaults(0.0, 0.5, 0.0);
+    generator.seed(42);
+
+    unsigned long good = 0;
+
+    for(int i=0; i<200; i++) {
+
+      unsigned long before = generator.getBadHeaders();
+
+      size_t n = generator.packet(buf, (double)i / 100.0);
+
+      size_t got = parser.feed(buf, n, i+1);
+
+      if(generator.getBadHeaders() != before) {
+
+        if(got != 0) {
+          cout << "[FAIL] a packet with a bad header was parsed" << endl;
+          return 1;
+        }
+
+        continue;
+      }
+
+      if((got != 1) || !parser.next(frame) || !matches(frame, generator)) {
+        cout << "[FAIL] a good packet after a bad one was lost" << endl;
+        return 1;
+      }
+
+      good++;
+    }
+
+    if((generator.getBadHeaders() == 0) || (good == 0) || (parser.getResyncs() == 0)) {
+      cout << "[FAIL] expected both good and bad packets" << endl;
+      return 1;
+    }
+
+    cout << "[OK] bad headers" << endl;
+  }
+
+  {
+    cout << "[truncated packets] ..." << endl;
+
+    MTSGenerator generator;
+    DL32Parser   parser;
+
+    generator.configure(5, MTSWaveform::RAMP, 1.0);
+    generator.setFaults(0.2, 0.0, 0.0);
+    generator.seed(7);
+
+    for(int i=0; i<500; i++) {
+      size_t n = generator.packet(buf, (double)i / 100.0);
+      parser.feed(buf, n, i+1);
+    }
+
+    /* a truncated packet eats part of the next, but we get back in sync */
+
+    generator.setFaults(0.0, 0.0, 0.0);
+
+    bool synced = false;
+
+    for(int i=0; (i<10) && !synced; i++) {
+
+      size_t n = generator.packet(buf, (double)i / 100.0);
+
+      if(parser.feed(buf, n, i+1) > 0) {
+        synced = parser.latest(frame) && matches(frame, generator);
+      }
+    }
+
+    if(!synced || (generator.getTruncated() == 0) || (parser.getResyncs() == 0)) {
+      cout << "[FAIL] did not recover from truncated packets" << endl;
+      return 1;
+    }
+
+    cout << "[OK] truncated packets" << endl;
+  }
+
+  {
+    cout << "[repeatable] ..." << endl;
+
+    MTSGenerator a;
+    MTSGenerator b;
+
+    a.configure(5, MTSWaveform::NOISE, 1.0);
+    b.configure(5, MTSWaveform::NOISE, 1.0);
+    a.setFaults(0.1, 0.1, 0.1);
+    b.setFaults(0.1, 0.1, 0.1);
+    a.seed(99);
+    b.seed(99);
+
+    unsigned char other[MTSMaxPacket];
+
+    for(int i=0; i<100; i++) {
+      size_t n = a.packet(buf, (double)i / 100.0);
+      size_t m = b.packet(other, (double)i / 100.0);
+      if((n != m) || (memcmp(buf, other, n) != 0)) {
+        cout << "[FAIL] the same seed gave different packets" << endl;
+        return 1;
+      }
+    }
+
+    cout << "[OK] repeatable" << endl;
+  }
+
+  {
+    cout << "[bad settings] ..." << endl;
+
+    MTSGenerator generator;
+
+    if(generator.configure(0, MTSWaveform::RAMP, 1.0) ||
+       generator.configure(MTSMaxChannels+1, MTSWaveform::RAMP, 1.0) ||
+       generator.configure(5, MTSWaveform::RAMP, 0.0) ||
+       generator.setFaults(1.5, 0.0, 0.0)) {
+      cout << "[FAIL] bad settings were accepted" << endl;
+      return 1;
+    }
+
+    cout << "[OK] bad settings" << endl;
+  }
+
+  cout << "MTS generator unit testing done." << endl;
+
+  return 0;
+}
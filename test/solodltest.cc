@@ -86,7 +86,8 @@ int main(int argc, const char* argv[]) {
   cout << "generating data..." << endl;
 
   time_t   t1  = time(NULL);
-  int    sent  = 10 * 60; /* 1 minute of send */
+  int  tickHz  = port.getTickHz();
+  int    sent  = tickHz * 60; /* 1 minute of send */
   int oddeven  = 0;
 
   char buf[1024];
@@ -147,12 +148,12 @@ int main(int argc, const char* argv[]) {
 
     cout << buf << endl;
 
-    /* align ourselves to send the next one on the next 100ms tick */
+    /* align ourselves to send the next one on the next tick */
 
     /*
-     * send data every 100ms (10hz), the above work used some
-     * time, so figure out where are now (between 100ms ticks)
-     * and sleep for the remainder
+     * send data every tick (the output schedule tick rate), the
+     * above work used some time, so figure out where are now
+     * (between ticks) and sleep for the remainder
      *
      */
 
@@ -169,7 +170,7 @@ int main(int argc, const char* argv[]) {
       delta = result.tv_usec;
     }
 
-    unsigned long cycle    = 100 * 1000;
+    unsigned long cycle    = 1000000 / tickHz;
     unsigned long sleepFor = cycle - delta;
 
     if(sleepFor < 0) {
@@ -189,7 +190,7 @@ int main(int argc, const char* argv[]) {
 
     /* flip pattern every 5sec */
 
-    if((sent % 50) == 0) {
+    if((sent % (5 * tickHz)) == 0) {
 
       if(oddeven) {
 
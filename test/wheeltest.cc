@@ -0,0 +1,149 @@
+#include "TimingWheel.hh"
+#include "SoloDLPort.hh"
+
+/* we have to allow EasyLogger to setup global variables */
+
+INITIALIZE_EASYLOGGINGPP
+
+/**
+ *
+ * check() - run the wheel for one second and make sure every
+ * channel was sent exactly 'rate' times, and no tick had more
+ * than 'maxLoad' packets on it.
+ *
+ */
+
+bool check(TimingWheel & wheel, const int *rates, int channels, int maxLoad) {
+
+  vector<int> sent(channels+1, 0);
+  int busiest = 0;
+
+  for(int tick=0; tick<wheel.getTickHz(); tick++) {
+
+    const vector<unsigned short> & due = wheel.next();
+
+    busiest = std::max(busiest, (int)due.size());
+
+    for(size_t i=0; i<due.size(); i++) {
+      sent[due[i]]++;
+    }
+  }
+
+  for(int chan=1; chan<=channels; chan++) {
+    if(sent[chan] != rates[chan]) {
+      cout << "[FAIL] channel " << chan << " sent " << sent[chan] << " times, expected " << rates[chan] << endl;
+      return false;
+    }
+  }
+
+  if(busiest > maxLoad) {
+    cout << "[FAIL] busiest tick had " << busiest << " packets, expected at most " << maxLoad << endl;
+    cout << wheel.describe();
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char* argv[]) {
+
+  cout << "Timing wheel unit tests..." << endl;
+
+  /* the AIM UART default profile */
+
+  int aim[SoloDLChannelMax+1] = {
+    0,
+    (int)AIMFreq::RPM,        (int)AIMFreq::WHEELSPEED,    (int)AIMFreq::OILPRESS,
+    (int)AIMFreq::OILTEMP,    (int)AIMFreq::WATERTEMP,     (int)AIMFreq::FUELPRESS,
+    (int)AIMFreq::BATTVOLT,   (int)AIMFreq::THROTANG,      (int)AIMFreq::MANIFPRESS,
+    (int)AIMFreq::AIRCHARGETEMP, (int)AIMFreq::EXHTEMP,    (int)AIMFreq::LAMBDA,
+    (int)AIMFreq::FUELTEMP,   (int)AIMFreq::GEAR,          (int)AIMFreq::ERRORFLAG
+  };
+
+  {
+    cout << "[10hz AIM profile] ..." << endl;
+
+    TimingWheel wheel;
+
+    if(!wheel.configure(10, aim, SoloDLChannelMax)) {
+      cout << "[FAIL] can not configure: " << wheel.getError() << endl;
+      return 1;
+    }
+
+    /* 82 packets a second over 10 ticks */
+
+    if(!check(wheel, aim, SoloDLChannelMax, 9)) {
+      return 1;
+    }
+
+    cout << "[OK] 10hz AIM profile" << endl;
+  }
+
+  {
+    cout << "[50hz AIM profile] ..." << endl;
+
+    TimingWheel wheel;
+
+    if(!wheel.configure(50, aim, SoloDLChannelMax)) {
+      cout << "[FAIL] can not configure: " << wheel.getError() << endl;
+      return 1;
+    }
+
+    /* 82 packets a second over 50 ticks, never more than 2 at once */
+
+    if(!check(wheel, aim, SoloDLChannelMax, 2)) {
+      return 1;
+    }
+
+    /* and a second time around the wheel is the same */
+
+    if(!check(wheel, aim, SoloDLChannelMax, 2)) {
+      return 1;
+    }
+
+    cout << "[OK] 50hz AIM profile" << endl;
+  }
+
+  {
+    cout << "[odd rates] ..." << endl;
+
+    int odd[5] = { 0, 4, 6, 8, 20 };
+
+    TimingWheel wheel;
+
+    if(!wheel.configure(40, odd, 4)) {
+      cout << "[FAIL] can not configure: " << wheel.getError() << endl;
+      return 1;
+    }
+
+    if(!check(wheel, odd, 4, 2)) {
+      return 1;
+    }
+
+    cout << "[OK] odd rates" << endl;
+  }
+
+  {
+    cout << "[bad rates] ..." << endl;
+
+    int bad[3] = { 0, 10, 20 };
+
+    TimingWheel wheel;
+
+    if(wheel.configure(10, bad, 2)) {
+      cout << "[FAIL] a rate above the tick rate was accepted." << endl;
+      return 1;
+    }
+
+    if(wheel.configure(0, bad, 2)) {
+      cout << "[FAIL] a 0 tick rate was accepted." << endl;
+      return 1;
+    }
+
+    cout << "[OK] bad rates" << endl;
+  }
+
+  cout << "Timing wheel unit testing done." << endl;
+
+  return 0;
+}
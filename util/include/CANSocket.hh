@@ -0,0 +1,143 @@
+#ifndef CANSOCKET_HH
+#define CANSOCKET_HH
+
+#include "Object.hh"
+
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+/* the most frames we hand the kernel in one call */
+
+enum CANSocketMaxBatch {CANSocketMaxBatch=64};
+
+/**
+ *
+ * CANSocket - a raw SocketCAN socket bound to one interface (can0, or
+ * vcan0 for testing).  Frames are handed to and from the kernel in
+ * batches, one system call for all of them (sendmmsg()/recvmmsg()), so
+ * a whole AIM data stream costs the sender one call no matter how many
+ * frames it is.  Which frames we receive at all is up to setFilter(),
+ * the kernel drops the rest without waking us.
+ *
+ * The socket is non-blocking; if the interface's queue is full (i.e.
+ * nobody on the bus is acking) frames are dropped, not waited on.
+ *
+ */
+
+class CANSocket : public Object {
+
+  private:
+
+    int fd;
+
+    /* the interface we're bound to */
+
+    string ifName;
+
+    /* sendmmsg()/recvmmsg() want a header and an iovec per frame */
+
+    struct mmsghdr msgs[CANSocketMaxBatch];
+    struct iovec   iovs[CANSocketMaxBatch];
+
+    CANSocket(const CANSocket &);
+    CANSocket &operator=(const CANSocket &);
+
+  protected:
+
+  public:
+
+    /**
+     *
+     * CANSocket() - open a raw CAN socket on the given interface.
+     *
+     * @param name string - the interface, i.e. can0
+     *
+     */
+
+    CANSocket(const string & name);
+
+    int getHandle(void) const {
+      return fd;
+    }
+
+    const string & getInterface(void) const {
+      return ifName;
+    }
+
+    /**
+     *
+     * send() - send a batch of frames in one system call.
+     *
+     * @param frames can_frame array - the frames, in order.
+     *
+     * @param n int - how many (at most CANSocketMaxBatch).
+     *
+     * @return int - the # of frames the kernel took (fewer than n if
+     * its queue filled up, 0 if it was full already), -1 on error.
+     *
+     */
+
+    int send(const struct can_frame *frames, int n);
+
+    /**
+     *
+     * receive() - read whatever frames are waiting (without waiting),
+     * in one system call.
+     *
+     * @param frames can_frame array - where to put them.
+     *
+     * @param n int - the most to read (at most CANSocketMaxBatch).
+     *
+     * @return int - the # of frames read, 0 if there weren't any, -1
+     * on error.
+     *
+     */
+
+    int receive(struct can_frame *frames, int n);
+
+    /**
+     *
+     * setFilter() - only receive frames with these ids (ids with
+     * CAN_EFF_FLAG set, or above 0x7FF, are extended ids).  An empty
+     * list receives nothing, for a socket we only send on.
+     *
+     * @param ids vector<canid_t> - the ids.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool setFilter(const vector<canid_t> & ids);
+
+    /**
+     *
+     * parseLog() - parse one line of a candump log (candump -l, or
+     * what canplayer plays back):
+     *
+     *   (1436509052.249713) vcan0 5F0#0102030405060708
+     *
+     * remote frames (5F0#R) and CAN FD frames (5F0##1...) aren't data
+     * we can use, they are treated as bad lines.
+     *
+     * @param line string - the line.
+     *
+     * @param frame can_frame - the frame.
+     *
+     * @param stamp double - the time stamp (seconds).
+     *
+     * @param ifName string - the interface it was logged on.
+     *
+     * @return bool - exactly false if the line isn't a frame.
+     *
+     */
+
+    static bool parseLog(const string & line, struct can_frame & frame, double & stamp, string & ifName);
+
+    /* standard destructor */
+
+    virtual ~CANSocket(void);
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef HISTOGRAM_HH
+#define HISTOGRAM_HH
+
+#include "util.hh"
+
+#include <atomic>
+
+/**
+ *
+ * Histogram - a fixed size log-linear (HDR style) histogram of
+ * 32 bit values, typically microseconds.  Values below 32 get a
+ * bucket each, above that every power of two is split into 16
+ * linear buckets, so any value is reported to within about 6%
+ * of its true value no matter how big it is.
+ *
+ * Recording is one array increment, there is no allocation and
+ * no locking, so it's cheap enough to do on every cycle of the
+ * real time path.  One thread records, any other thread may read
+ * percentiles at the same time (it may just be off by the last
+ * couple of samples).
+ *
+ */
+
+class Histogram {
+
+  private:
+
+    enum {
+      LINEAR   = 32,  /* values 0..31 get their own bucket */
+      SUBBITS  = 4,   /* 16 buckets per power of two above that */
+      BUCKETS  = LINEAR + (28 * (1 << SUBBITS))
+    };
+
+    std::atomic<uint32_t> counts[BUCKETS];
+
+    std::atomic<uint32_t> largest;
+
+    /**
+     *
+     * bucketOf() - map a value to its bucket index.
+     *
+     */
+
+    static int bucketOf(uint32_t value);
+
+    /**
+     *
+     * valueOf() - the highest value that lands in the given
+     * bucket (what we report for percentiles, so we never under
+     * state a latency).
+     *
+     */
+
+    static uint32_t valueOf(int bucket);
+
+    Histogram(const Histogram &);
+    Histogram &operator=(const Histogram &);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    Histogram(void) {
+      reset();
+    }
+
+    /**
+     *
+     * record() - count one value.
+     *
+     * @param value uint32_t - the value to count.
+     *
+     */
+
+    void record(uint32_t value) {
+
+      counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+
+      if(value > largest.load(std::memory_order_relaxed)) {
+        largest.store(value, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     *
+     * count() - the number of values recorded so far.
+     *
+     */
+
+    uint64_t count(void) const;
+
+    /**
+     *
+     * percentile() - fetch the value at the given percentile.
+     *
+     * @param pct double - the percentile (0..100) i.e. 99.0 for p99.
+     *
+     * @return uint32_t - the value, or 0 if nothing has been recorded.
+     *
+     */
+
+    uint32_t percentile(double pct) const;
+
+    /**
+     *
+     * max() - the largest value recorded so far (exact).
+     *
+     */
+
+    uint32_t max(void) const {
+      return largest.load(std::memory_order_relaxed);
+    }
+
+    /**
+     *
+     * summary() - one line summary for humans, like:
+     *
+     *   p50: 120 p99: 480 max: 1021 n: 6000
+     *
+     */
+
+    string summary(void) const;
+
+    /**
+     *
+     * reset() - forget everything recorded so far.
+     *
+     */
+
+    void reset(void);
+
+    /* standard destructor */
+
+    ~Histogram() {
+
+    }
+};
+
+#endif
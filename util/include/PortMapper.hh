@@ -18,11 +18,22 @@ class PortMapper : public Object {
 
   private:
 
-    map<Device, string> devicePaths;
+    /*
+     * everything is kept by device name (the section names in the
+     * configuration), so any of the cable's ports can be used, not just
+     * the DL-32 and SoloDL ones.
+     *
+     */
+
+    map<string, string> devicePaths;
+
+    /* devices given a fixed path in the configuration (not on the cable) */
 
-    map<Device, int> cableOrder;
+    map<string, string> fixedPaths;
 
-    map<string, Device> deviceEnums;
+    map<string, int> cableOrder;
+
+    vector<string> deviceNames;
 
     /* private methods */
 
@@ -33,11 +44,11 @@ class PortMapper : public Object {
      * mapped in from the USB port.
      *
      * When this call is done devicePaths and cableOrder will
-     * be filled in.
+     * be filled in, for deviceNames.
      *
      */
 
-    bool findFT4232H(vector<string> & devices);
+    bool findFT4232H(void);
 
   protected:
 
@@ -72,8 +83,9 @@ class PortMapper : public Object {
       Object::operator=(obj);
 
       devicePaths = obj.devicePaths;
+      fixedPaths  = obj.fixedPaths;
       cableOrder  = obj.cableOrder;
-      deviceEnums = obj.deviceEnums;
+      deviceNames = obj.deviceNames;
 
       return *this;
     }
@@ -88,12 +100,52 @@ class PortMapper : public Object {
      */
 
     string getDevice(const Device & code) {
+      return getDevice(deviceName(code));
+    }
+
+    /* the same, by the device's name (its section in the configuration) */
 
-      if(devicePaths.count(code) == 0) {
+    string getDevice(const string & name) {
+
+      if(devicePaths.count(name) == 0) {
         return "";
       }
 
-      return devicePaths[code];
+      return devicePaths[name];
+    }
+
+    /**
+     *
+     * isFixed() - true if the device was given a fixed path in the
+     * configuration, rather than being found on the USB cable.
+     *
+     */
+
+    bool isFixed(const Device & code) {
+      return isFixed(deviceName(code));
+    }
+
+    bool isFixed(const string & name) {
+      return fixedPaths.count(name) > 0;
+    }
+
+    /**
+     *
+     * deviceName() - the configuration name of one of our built in
+     * devices.
+     *
+     */
+
+    static string deviceName(const Device & code) {
+
+      switch(code) {
+        case Device::DL32:
+          return "dl32";
+        case Device::SOLODL:
+          return "solodl";
+      }
+
+      return "";
     }
 
     /**
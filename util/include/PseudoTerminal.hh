@@ -0,0 +1,116 @@
+#ifndef PSEUDOTERMINAL_HH
+#define PSEUDOTERMINAL_HH
+
+#include "Object.hh"
+
+#include <signal.h>
+
+/* how long send() waits for room before it looks at its stop flag again */
+
+enum SendWaitMs {SendWaitMs=100};
+
+/**
+ *
+ * PseudoTerminal - a pty pair we can pretend to be a serial device
+ * with (for replaying captures, simulating a DL-32 etc.).  We hold the
+ * master side, and the slave side (i.e. /dev/pts/5) is what the program
+ * under test opens as if it were /dev/ttyUSB1.  Since the pts number
+ * changes from run to run, the slave can also be given a fixed name
+ * with a symlink (see the [dl32] device setting in PortMapper).
+ *
+ * We keep the slave open ourselves as well, so the master doesn't see
+ * a hangup every time the program under test closes and re-opens it.
+ *
+ */
+
+class PseudoTerminal : public Object {
+
+  private:
+
+    /* the master side (ours) and our own handle on the slave */
+
+    int master;
+    int slave;
+
+    /* the slave's path, and the symlink to it (if any) */
+
+    string slaveName;
+    string linkName;
+
+    PseudoTerminal(const PseudoTerminal &);
+    PseudoTerminal &operator=(const PseudoTerminal &);
+
+  protected:
+
+  public:
+
+    /**
+     *
+     * PseudoTerminal() - create the pty pair, the slave is put in raw
+     * mode so nothing we write is echoed or mangled.
+     *
+     * @param link string - if not empty, make this a symlink to the
+     * slave (replacing any old symlink).
+     *
+     */
+
+    PseudoTerminal(const string & link="");
+
+    /**
+     *
+     * getHandle() - the master side, write here and the program on
+     * the slave reads it; what it writes we can read here.
+     *
+     */
+
+    int getHandle(void) const {
+      return master;
+    }
+
+    /**
+     *
+     * getSlaveName() - the slave device, i.e. /dev/pts/5
+     *
+     */
+
+    const string & getSlaveName(void) const {
+      return slaveName;
+    }
+
+    /**
+     *
+     * send() - write all the given bytes to the slave side, waiting if
+     * the pty is full (the program under test is behind).  While waiting
+     * it looks at 'stop' every SendWaitMs, so a program that has stopped
+     * reading can't hang us.
+     *
+     * @param bytes unsigned char array - the bytes.
+     *
+     * @param n size_t - how many.
+     *
+     * @param stop sig_atomic_t pointer - if not NULL, give up (false)
+     * once it's set (i.e. by a signal handler).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool send(const unsigned char *bytes, size_t n, volatile sig_atomic_t *stop = NULL);
+
+    /**
+     *
+     * drain() - read (and throw away) whatever the program under test
+     * wrote to the slave, without waiting.
+     *
+     * @return long - the # of bytes drained, -1 on error.
+     *
+     */
+
+    long drain(void);
+
+    /* standard destructor */
+
+    virtual ~PseudoTerminal(void);
+};
+
+#endif
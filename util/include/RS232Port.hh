@@ -80,6 +80,15 @@ class RS232Port : public Object {
 
     int readTimeoutSeconds;
 
+    /**
+     *
+     * lowLatency - true if the driver accepted ASYNC_LOW_LATENCY (see
+     * configureLatency()).
+     *
+     */
+
+    bool lowLatency;
+
   protected:
 
   public:
@@ -91,7 +100,7 @@ class RS232Port : public Object {
      */
 
     RS232Port(const string & path="", const string & params="", bool doBlock=true) :
-      Object("RS232Port"), fd(-1), args(""), mode(""), device(""), blocking(false) {
+      Object("RS232Port"), fd(-1), args(""), mode(""), device(""), blocking(false), lowLatency(false) {
 
       memset(&oldOptions, 0, sizeof(struct termios));
       memset(&options, 0, sizeof(struct termios));
@@ -129,6 +138,7 @@ class RS232Port : public Object {
       options    = obj.options;
       device     = obj.device;
       blocking   = obj.blocking;
+      lowLatency = obj.lowLatency;
 
       readTimeoutSeconds = obj.readTimeoutSeconds;
 
@@ -228,6 +238,127 @@ class RS232Port : public Object {
 
     int waitForBytes(int maxRetry=0);
 
+    /**
+     *
+     * setNonBlocking() - turn O_NONBLOCK on (or off) for the open port,
+     * so read() returns right away (EAGAIN) when there is nothing there.
+     *
+     * @param on bool - true for non-blocking.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool setNonBlocking(bool on=true);
+
+    /**
+     *
+     * outputQueued() - how many bytes we've written that are still
+     * waiting in the kernel to go out (TIOCOUTQ).
+     *
+     * @return long - the # of bytes, -1 on error.
+     *
+     */
+
+    long outputQueued(void);
+
+    /**
+     *
+     * flushOutput() - throw away anything written that hasn't gone out
+     * yet (tcflush(TCOFLUSH)).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool flushOutput(void);
+
+    /**
+     *
+     * setLowLatency() - ask the serial driver to hand us received bytes
+     * right away (ASYNC_LOW_LATENCY via TIOCSSERIAL) instead of batching
+     * them up.  Not every driver supports it.
+     *
+     * @param on bool - true for low latency.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool setLowLatency(bool on=true);
+
+    /**
+     *
+     * setLatencyTimer() - program the USB serial adapter's latency timer
+     * (/sys/bus/usb-serial/devices/<tty>/latency_timer), this is how long
+     * an FTDI chip holds on to a partly full buffer before sending it to
+     * us; 16ms out of the box.  Only FTDI style adapters have one.
+     *
+     * @param ms int - 1..255 milliseconds.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool setLatencyTimer(int ms);
+
+    /**
+     *
+     * getLatencyTimer() - read back the adapter's latency timer (ms),
+     * -1 if it doesn't have one (or we can't read it).
+     *
+     */
+
+    int getLatencyTimer(void);
+
+    /**
+     *
+     * setReadTiming() - set VMIN/VTIME; a blocking read() waits for 'vmin'
+     * bytes, or until the line has been quiet for 'vtime' tenths of a
+     * second.  (Non-blocking reads ignore both.)
+     *
+     * @param vmin int - 0..255 bytes.
+     *
+     * @param vtime int - 0..255 tenths of a second.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool setReadTiming(int vmin, int vtime);
+
+    /**
+     *
+     * configureLatency() - apply the latency settings from the given
+     * section of the configuration, all optional:
+     *
+     *   low_latency   - true/false, ASYNC_LOW_LATENCY
+     *   latency_timer - 1..255 ms, the adapter's latency timer
+     *   vmin, vtime   - read timing for blocking reads (a non-blocking
+     *                   port doesn't use them, and says so)
+     *
+     * Settings the port/driver doesn't support are only warned about,
+     * the port still works, just not as quickly.
+     *
+     * @param section string - the .ini section (i.e. "dl32")
+     *
+     * @return bool - exactly false if a setting is invalid.
+     *
+     */
+
+    bool configureLatency(const string & section);
+
+    /**
+     *
+     * describeLatency() - human readable summary of the effective
+     * latency settings, i.e. "low latency: on, latency timer: 1 ms,
+     * vmin: 12, vtime: 1"; a non-blocking port doesn't use vmin/vtime,
+     * so it just says "non-blocking" instead.
+     *
+     */
+
+    string describeLatency(void);
+
     /* standard destructor */
 
     virtual ~RS232Port(void) {
@@ -0,0 +1,138 @@
+#ifndef SERIALCAPTURE_HH
+#define SERIALCAPTURE_HH
+
+#include "Object.hh"
+
+/**
+ *
+ * SerialCapture - a recording of a serial byte stream, exactly as we
+ * read() it, with the monotonic time (nanoseconds) of each read, so
+ * it can be played back later with the same timing.
+ *
+ * The file is an 8 byte magic ("ECUCAP01") followed by one record per
+ * read:
+ *
+ *   stamp   - uint64_t, monotonic nanoseconds
+ *   length  - uint16_t, # of bytes
+ *   bytes   - the data
+ *
+ * Numbers are in the host's byte order; captures are made and played
+ * back on the Pi.
+ *
+ * A capture is either being written (create()/append()) or read
+ * (openRead()/next()), not both.
+ *
+ */
+
+class SerialCapture : public Object {
+
+  private:
+
+    FILE *fp;
+
+    bool writing;
+
+    /* records written/read so far */
+
+    unsigned long records;
+
+    SerialCapture(const SerialCapture &);
+    SerialCapture &operator=(const SerialCapture &);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    SerialCapture(void) : Object("SerialCapture"), fp(NULL), writing(false), records(0) {
+      unReady();
+    }
+
+    /**
+     *
+     * create() - start a new capture file (replacing any old one).
+     *
+     * @param fileName string - the capture file.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool create(const string & fileName);
+
+    /**
+     *
+     * append() - record one read's worth of bytes.
+     *
+     * @param stamp uint64_t - when the bytes were read.
+     *
+     * @param bytes unsigned char array - the bytes.
+     *
+     * @param n size_t - how many (reads of more than 64k are split).
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool append(uint64_t stamp, const unsigned char *bytes, size_t n);
+
+    /**
+     *
+     * openRead() - open an existing capture to play it back.
+     *
+     * @param fileName string - the capture file.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool openRead(const string & fileName);
+
+    /**
+     *
+     * next() - read the next record.
+     *
+     * @param stamp uint64_t - when the bytes were read.
+     *
+     * @param bytes vector - the bytes.
+     *
+     * @return bool - exactly false at the end of the capture (or on
+     * error, i.e. a truncated record; then isReady() is false too).
+     *
+     */
+
+    bool next(uint64_t & stamp, vector<unsigned char> & bytes);
+
+    /**
+     *
+     * rewind() - (reading) go back to the first record.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool rewind(void);
+
+    /**
+     *
+     * close() - finish up (flushes a capture being written).
+     *
+     */
+
+    void close(void);
+
+    /* records written or read so far */
+
+    unsigned long getRecords(void) const {
+      return records;
+    }
+
+    /* standard destructor */
+
+    virtual ~SerialCapture(void) {
+      close();
+    }
+};
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef SPSCRING_HH
+#define SPSCRING_HH
+
+#include <atomic>
+
+/**
+ *
+ * SpscRing - a lock free, fixed size FIFO between exactly one
+ * producer thread and exactly one consumer thread.  Items are
+ * copied in and out whole, so T should be a small plain struct.
+ *
+ * The producer never waits; if the consumer has fallen behind
+ * and the ring is full, push() drops the new item and counts it.
+ * That way a stalled consumer can never hold up the producer.
+ *
+ * N must be a power of two.
+ *
+ */
+
+template <typename T, unsigned int N>
+class SpscRing {
+
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "SpscRing size must be a power of two");
+
+  private:
+
+    T items[N];
+
+    /*
+     * head is only written by the producer, tail only by the
+     * consumer; keep them on separate cache lines so the two
+     * threads don't fight over one.
+     *
+     */
+
+    alignas(64) std::atomic<unsigned long> head;
+    alignas(64) std::atomic<unsigned long> tail;
+
+    std::atomic<unsigned long> dropped;
+
+    SpscRing(const SpscRing &);
+    SpscRing &operator=(const SpscRing &);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    SpscRing(void) : head(0), tail(0), dropped(0) {
+
+    }
+
+    /**
+     *
+     * push() - (producer only) copy an item into the ring.
+     *
+     * @param item T - the item to add.
+     *
+     * @return bool - exactly false if the ring was full and the
+     * item was dropped.
+     *
+     */
+
+    bool push(const T & item) {
+
+      unsigned long h = head.load(std::memory_order_relaxed);
+
+      if((h - tail.load(std::memory_order_acquire)) >= N) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      items[h & (N - 1)] = item;
+
+      head.store(h + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     *
+     * pop() - (consumer only) copy the oldest item out of the ring.
+     *
+     * @param item T - the item we took.
+     *
+     * @return bool - exactly false if the ring was empty.
+     *
+     */
+
+    bool pop(T & item) {
+
+      unsigned long t = tail.load(std::memory_order_relaxed);
+
+      if(t == head.load(std::memory_order_acquire)) {
+        return false;
+      }
+
+      item = items[t & (N - 1)];
+
+      tail.store(t + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     *
+     * pushed() - the # of items that made it into the ring so far.
+     *
+     */
+
+    unsigned long pushed(void) const {
+      return head.load(std::memory_order_relaxed);
+    }
+
+    /**
+     *
+     * drops() - the # of items dropped because the ring was full.
+     *
+     */
+
+    unsigned long drops(void) const {
+      return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     *
+     * reset() - empty the ring and zero the counters.  Only when
+     * neither the producer or the consumer is running.
+     *
+     */
+
+    void reset(void) {
+      head    = 0;
+      tail    = 0;
+      dropped = 0;
+    }
+
+    /* standard destructor */
+
+    ~SpscRing() {
+
+    }
+};
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef TRACER_HH
+#define TRACER_HH
+
+#include "Object.hh"
+
+#include <atomic>
+#include <mutex>
+
+/**
+ *
+ * Tracer - a tiny cycle profiler.  Each thread that wants to be
+ * traced attaches itself once and gets a fixed size ring of
+ * (stage, start, end) records.  Recording a stage is two clock
+ * reads and a store into the ring; no locks, no allocation, no
+ * strings, no logging, so it doesn't change the timing it is
+ * measuring.  When the ring is full the oldest records are
+ * overwritten.
+ *
+ * Stages are identified by a string literal (its address is the
+ * id, the text is only looked at when we dump).
+ *
+ * Tracepoints are compiled in only when ECUBRIDGE_TRACE is defined
+ * (see the Makefile), otherwise the TRACE_*() macros are nothing
+ * at all.  Use them like this:
+ *
+ *   TRACE_THREAD("sender");            - once at the top of a thread
+ *
+ *   {
+ *     TRACE_SCOPE("writeSamples");     - times the rest of the block
+ *     solodl->writeSamples(...);
+ *   }
+ *
+ * dump() writes all the rings out as Chrome/Perfetto trace JSON,
+ * which can be opened in chrome://tracing or ui.perfetto.dev.
+ *
+ */
+
+struct TraceRecord {
+
+  const char *stage;
+
+  uint64_t start;
+  uint64_t end;
+};
+
+/**
+ *
+ * TraceRing - the records for one thread.  Only the owning thread
+ * ever writes it.
+ *
+ */
+
+struct TraceRing {
+
+  enum { SIZE = 4096, MASK = SIZE - 1 };
+
+  string name;
+  int    tid;
+
+  TraceRecord records[SIZE];
+
+  std::atomic<uint32_t> head;
+
+  void add(const char *stage, uint64_t start, uint64_t end) {
+
+    uint32_t h = head.load(std::memory_order_relaxed);
+
+    TraceRecord & record = records[h & MASK];
+
+    record.stage = stage;
+    record.start = start;
+    record.end   = end;
+
+    head.store(h + 1, std::memory_order_release);
+  }
+};
+
+class Tracer : public Object {
+
+  private:
+
+    /*
+     * this is a singleton, like the ConfigManager, only allow
+     * the accessor method, no construction.
+     *
+     */
+
+    Tracer(void);
+    Tracer(const Tracer &);
+    Tracer &operator=(const Tracer &);
+
+    static Tracer *tracer;
+
+    /* all the rings we've handed out, guarded by lock */
+
+    vector<TraceRing *> rings;
+
+    std::mutex lock;
+
+  protected:
+
+  public:
+
+    /**
+     *
+     * local - the calling thread's ring (NULL if the thread never
+     * attached, in which case its tracepoints do nothing).
+     *
+     */
+
+    static thread_local TraceRing *local;
+
+    /**
+     *
+     * instance() - fetch the one (and only) tracer.
+     *
+     */
+
+    static Tracer & instance(void);
+
+    /**
+     *
+     * attach() - give the calling thread a ring to record into.  If
+     * a ring by that name already exists (i.e. a restarted thread)
+     * it is re-used, so we never grow without bound.
+     *
+     * @param name string - the thread name, shown in the dump.
+     *
+     */
+
+    void attach(const string & name);
+
+    /**
+     *
+     * clear() - throw away everything recorded so far.  Only safe
+     * when the traced threads aren't running, otherwise records
+     * being written right now may survive.
+     *
+     */
+
+    void clear(void);
+
+    /**
+     *
+     * dump() - write everything in the rings to a Chrome/Perfetto
+     * trace JSON file.  Safe to call while the traced threads are
+     * running; records that were overwritten while we were copying
+     * are dropped.
+     *
+     * @param fileName string - where to write the trace.
+     *
+     * @param count size_t - the # of records written.
+     *
+     * @return bool - exactly false on error.
+     *
+     */
+
+    bool dump(const string & fileName, size_t & count);
+
+    /* standard destructor */
+
+    ~Tracer() {
+
+      /* do nothing, its a singleton */
+
+    }
+};
+
+/**
+ *
+ * TraceScope - records the stage from construction to the end of the
+ * enclosing scope.  Use TRACE_SCOPE() rather than this directly.
+ *
+ */
+
+class TraceScope {
+
+  private:
+
+    TraceRing  *ring;
+    const char *stage;
+    uint64_t    start;
+
+  public:
+
+    TraceScope(const char *name) : ring(Tracer::local), stage(name), start(0) {
+
+      if(ring != NULL) {
+        start = monotonic_ns();
+      }
+    }
+
+    ~TraceScope() {
+
+      if(ring != NULL) {
+        ring->add(stage, start, monotonic_ns());
+      }
+    }
+};
+
+#ifdef ECUBRIDGE_TRACE
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b)  TRACE_JOIN2(a, b)
+
+#define TRACE_THREAD(name) Tracer::instance().attach(name)
+#define TRACE_SCOPE(stage) TraceScope TRACE_JOIN(traceScope, __LINE__)(stage)
+
+#else
+
+#define TRACE_THREAD(name) do { } while(0)
+#define TRACE_SCOPE(stage) do { } while(0)
+
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef TRIPLEBUFFER_HH
+#define TRIPLEBUFFER_HH
+
+#include <atomic>
+
+/**
+ *
+ * TripleBuffer - a lock free "latest value" mailbox between exactly
+ * one writer thread and exactly one reader thread.  There are three
+ * copies of the value; the writer always owns one (the back buffer),
+ * the reader always owns one (the front buffer), and the third sits
+ * in the middle waiting to be picked up.
+ *
+ * Publishing swaps the back buffer with the middle one, and fetching
+ * swaps the front buffer with the middle one (if something new was
+ * published).  Both are a single atomic exchange, so neither side
+ * ever waits on the other, and neither side ever sees a half written
+ * value.  If the writer publishes several times before the reader
+ * looks, the reader just gets the most recent one, which is exactly
+ * what we want for "current value" style sample data.
+ *
+ */
+
+template <typename T>
+class TripleBuffer {
+
+  private:
+
+    /**
+     *
+     * buffers - the three copies of the value.
+     *
+     */
+
+    T buffers[3];
+
+    /**
+     *
+     * middle - index of the middle buffer, with DIRTY set if
+     * the writer has published into it since the reader last
+     * picked it up.
+     *
+     */
+
+    std::atomic<unsigned int> middle;
+
+    /* back (writer owned) and front (reader owned) indexes */
+
+    unsigned int back;
+    unsigned int front;
+
+    enum { DIRTY = 0x4, INDEX = 0x3 };
+
+    TripleBuffer(const TripleBuffer &);
+    TripleBuffer &operator=(const TripleBuffer &);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    TripleBuffer(void) : middle(1), back(0), front(2) {
+
+      for(int i=0; i<3; i++) {
+        buffers[i] = T();
+      }
+    }
+
+    /**
+     *
+     * writeBuffer() - (writer only) fetch the back buffer so the
+     * writer can fill it in place before calling publish().
+     *
+     */
+
+    T & writeBuffer(void) {
+      return buffers[back];
+    }
+
+    /**
+     *
+     * publish() - (writer only) make the back buffer the latest
+     * value.  The back buffer is then some other buffer, so callers
+     * must re-fetch writeBuffer() after publishing.
+     *
+     */
+
+    void publish(void) {
+
+      unsigned int old = middle.exchange(back | DIRTY, std::memory_order_acq_rel);
+
+      back = old & INDEX;
+    }
+
+    /**
+     *
+     * publish() - (writer only) copy in a new value and publish it.
+     *
+     * @param value T - the new latest value.
+     *
+     */
+
+    void publish(const T & value) {
+
+      buffers[back] = value;
+
+      publish();
+    }
+
+    /**
+     *
+     * fetch() - (reader only) pick up the latest published value.
+     *
+     * @return bool - exactly true if the value is new since the
+     * last call to fetch().
+     *
+     */
+
+    bool fetch(void) {
+
+      if((middle.load(std::memory_order_relaxed) & DIRTY) == 0) {
+        return false;
+      }
+
+      unsigned int old = middle.exchange(front, std::memory_order_acq_rel);
+
+      front = old & INDEX;
+
+      return true;
+    }
+
+    /**
+     *
+     * readBuffer() - (reader only) the most recently fetched value.
+     *
+     */
+
+    const T & readBuffer(void) const {
+      return buffers[front];
+    }
+
+    /* standard destructor */
+
+    ~TripleBuffer() {
+
+    }
+};
+
+#endif
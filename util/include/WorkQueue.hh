@@ -0,0 +1,176 @@
+#ifndef WORKQUEUE_HH
+#define WORKQUEUE_HH
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ *
+ * WorkQueue - a small bounded FIFO for handing work from one thread
+ * to another.  The producer side never waits for room; push() just
+ * says no when the queue is full, so a flood of work can't stall the
+ * producer.  The consumer side blocks in pop() until there is work,
+ * or until the queue is closed.
+ *
+ */
+
+template <typename T>
+class WorkQueue {
+
+  private:
+
+    std::deque<T> items;
+
+    size_t limit;
+
+    bool closed;
+
+    std::mutex lock;
+
+    std::condition_variable ready;
+
+    WorkQueue(const WorkQueue &);
+    WorkQueue &operator=(const WorkQueue &);
+
+  protected:
+
+  public:
+
+    /* standard constructor */
+
+    WorkQueue(size_t maxItems=4) : limit(maxItems), closed(false) {
+
+    }
+
+    /**
+     *
+     * setLimit() - change how many items may be waiting at once.
+     *
+     */
+
+    void setLimit(size_t maxItems) {
+
+      std::lock_guard<std::mutex> guard(lock);
+
+      limit = (maxItems < 1) ? 1 : maxItems;
+    }
+
+    /**
+     *
+     * push() - (producer) add an item if there is room, never waits
+     * for the consumer.
+     *
+     * @param item T - the work to queue.
+     *
+     * @return bool - exactly false if the queue is full or closed.
+     *
+     */
+
+    bool push(const T & item) {
+
+      {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if(closed || (items.size() >= limit)) {
+          return false;
+        }
+
+        items.push_back(item);
+      }
+
+      ready.notify_one();
+
+      return true;
+    }
+
+    /**
+     *
+     * pop() - (consumer) wait for the next item.
+     *
+     * @param item T - the item we pulled off.
+     *
+     * @return bool - exactly false if the queue was closed (and
+     * there is nothing left in it).
+     *
+     */
+
+    bool pop(T & item) {
+
+      std::unique_lock<std::mutex> guard(lock);
+
+      while(items.empty() && !closed) {
+        ready.wait(guard);
+      }
+
+      if(items.empty()) {
+        return false;
+      }
+
+      item = items.front();
+      items.pop_front();
+
+      return true;
+    }
+
+    /**
+     *
+     * tryPop() - like pop() but never waits.
+     *
+     * @return bool - exactly false if there was nothing to pop.
+     *
+     */
+
+    bool tryPop(T & item) {
+
+      std::lock_guard<std::mutex> guard(lock);
+
+      if(items.empty()) {
+        return false;
+      }
+
+      item = items.front();
+      items.pop_front();
+
+      return true;
+    }
+
+    /**
+     *
+     * close() - refuse any further work and wake up the consumer,
+     * anything already queued can still be popped.
+     *
+     */
+
+    void close(void) {
+
+      {
+        std::lock_guard<std::mutex> guard(lock);
+
+        closed = true;
+      }
+
+      ready.notify_all();
+    }
+
+    /**
+     *
+     * open() - accept work again (after a close()).
+     *
+     */
+
+    void open(void) {
+
+      std::lock_guard<std::mutex> guard(lock);
+
+      closed = false;
+    }
+
+    /* standard destructor */
+
+    ~WorkQueue() {
+
+    }
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define UTIL_HH
 
 #include <stdio.h>
+#include <stdint.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <termios.h>
@@ -270,4 +271,17 @@ extern bool file_exists(string fileName);
 
 extern bool file(string fileName, vector<string> & results);
 
+/**
+ *
+ * monotonic_ns() - fetch the current CLOCK_MONOTONIC time in
+ * nanoseconds.  Unlike gettimeofday() this clock is never stepped
+ * by NTP or the RTC, so it is what we use for any kind of cycle
+ * timing or deadline math.
+ *
+ * @return uint64_t - nanoseconds since some unspecified start point.
+ *
+ */
+
+extern uint64_t monotonic_ns(void);
+
 #endif
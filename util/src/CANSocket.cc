@@ -0,0 +1,323 @@
+#include "CANSocket.hh"
+
+#include <string.h>
+
+/**
+ *
+ * CANSocket() - open a raw CAN socket on the given interface.
+ *
+ * @param name string - the interface, i.e. can0
+ *
+ */
+
+CANSocket::CANSocket(const string & name) : Object("CANSocket"), fd(-1), ifName(name) {
+
+  unReady();
+
+  memset(msgs, 0, sizeof(msgs));
+  memset(iovs, 0, sizeof(iovs));
+
+  if(ifName.empty() || (ifName.size() >= IFNAMSIZ)) {
+    error(string("bad CAN interface name: ") + ifName);
+    return;
+  }
+
+  unsigned int index = if_nametoindex(ifName.c_str());
+
+  if(index == 0) {
+    error(string("no such CAN interface: ") + ifName);
+    return;
+  }
+
+  fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+
+  if(fd < 0) {
+    error(string("can not open CAN socket: ") + strerror(errno));
+    return;
+  }
+
+  struct sockaddr_can addr;
+
+  memset(&addr, 0, sizeof(addr));
+
+  addr.can_family  = AF_CAN;
+  addr.can_ifindex = index;
+
+  if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    error(string("can not bind CAN socket to ") + ifName + string(": ") + strerror(errno));
+    close(fd);
+    fd = -1;
+    return;
+  }
+
+  /* the headers always point at iovs[], only the frame changes */
+
+  for(int i=0; i<CANSocketMaxBatch; i++) {
+    iovs[i].iov_len             = sizeof(struct can_frame);
+    msgs[i].msg_hdr.msg_iov    = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  info(string("CAN socket open on ") + ifName + string(" fd: ") + to_string(fd));
+
+  makeReady();
+}
+
+/**
+ *
+ * send() - send a batch of frames in one system call.
+ *
+ * @param frames can_frame array - the frames, in order.
+ *
+ * @param n int - how many (at most CANSocketMaxBatch).
+ *
+ * @return int - the # of frames the kernel took (fewer than n if
+ * its queue filled up, 0 if it was full already), -1 on error.
+ *
+ */
+
+int CANSocket::send(const struct can_frame *frames, int n) {
+
+  if(fd < 0) {
+    error("send() - socket is not open.");
+    return -1;
+  }
+
+  if((n < 0) || (n > CANSocketMaxBatch)) {
+    error(string("send() - bad batch size: ") + to_string(n));
+    return -1;
+  }
+
+  for(int i=0; i<n; i++) {
+    iovs[i].iov_base = (void *)&frames[i];
+  }
+
+  int done = 0;
+
+  while(done < n) {
+
+    int sent = sendmmsg(fd, msgs + done, n - done, 0);
+
+    if(sent < 0) {
+
+      if(errno == EINTR) {
+        continue;
+      }
+
+      /* the interface's queue is full, drop the rest */
+
+      if((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS)) {
+        break;
+      }
+
+      error(string("send() - can't write to ") + ifName + string(": ") + strerror(errno));
+      return -1;
+    }
+
+    done += sent;
+  }
+
+  return done;
+}
+
+/**
+ *
+ * receive() - read whatever frames are waiting (without waiting),
+ * in one system call.
+ *
+ * @param frames can_frame array - where to put them.
+ *
+ * @param n int - the most to read (at most CANSocketMaxBatch).
+ *
+ * @return int - the # of frames read, 0 if there weren't any, -1
+ * on error.
+ *
+ */
+
+int CANSocket::receive(struct can_frame *frames, int n) {
+
+  if(fd < 0) {
+    error("receive() - socket is not open.");
+    return -1;
+  }
+
+  if((n < 0) || (n > CANSocketMaxBatch)) {
+    error(string("receive() - bad batch size: ") + to_string(n));
+    return -1;
+  }
+
+  for(int i=0; i<n; i++) {
+    iovs[i].iov_base = (void *)&frames[i];
+  }
+
+  while(true) {
+
+    int got = recvmmsg(fd, msgs, n, MSG_DONTWAIT, NULL);
+
+    if(got >= 0) {
+      return got;
+    }
+
+    if(errno == EINTR) {
+      continue;
+    }
+
+    if((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      return 0;
+    }
+
+    error(string("receive() - can't read from ") + ifName + string(": ") + strerror(errno));
+    return -1;
+  }
+}
+
+/**
+ *
+ * setFilter() - only receive frames with these ids (ids with
+ * CAN_EFF_FLAG set, or above 0x7FF, are extended ids).  An empty list
+ * receives nothing, for a socket we only send on.
+ *
+ * @param ids vector<canid_t> - the ids.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool CANSocket::setFilter(const vector<canid_t> & ids) {
+
+  if(fd < 0) {
+    error("setFilter() - socket is not open.");
+    return false;
+  }
+
+  vector<struct can_filter> filters;
+
+  for(auto id : ids) {
+
+    struct can_filter filter;
+
+    /* match the id exactly, data frames only, standard vs. extended too */
+
+    if((id & CAN_EFF_FLAG) || ((id & CAN_EFF_MASK) > CAN_SFF_MASK)) {
+      filter.can_id   = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+      filter.can_mask = CAN_EFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    } else {
+      filter.can_id   = id & CAN_SFF_MASK;
+      filter.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    }
+
+    filters.push_back(filter);
+  }
+
+  if(setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.empty() ? NULL : filters.data(),
+                filters.size() * sizeof(struct can_filter)) != 0) {
+    error(string("setFilter() - can not set the CAN filter: ") + strerror(errno));
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * parseLog() - parse one line of a candump log (candump -l, or
+ * what canplayer plays back):
+ *
+ *   (1436509052.249713) vcan0 5F0#0102030405060708
+ *
+ * remote frames (5F0#R) and CAN FD frames (5F0##1...) aren't data
+ * we can use, they are treated as bad lines.
+ *
+ * @param line string - the line.
+ *
+ * @param frame can_frame - the frame.
+ *
+ * @param stamp double - the time stamp (seconds).
+ *
+ * @param ifName string - the interface it was logged on.
+ *
+ * @return bool - exactly false if the line isn't a frame.
+ *
+ */
+
+bool CANSocket::parseLog(const string & line, struct can_frame & frame, double & stamp, string & ifName) {
+
+  vector<string> tokens;
+
+  explode(trim(line), " \t", tokens);
+
+  if((tokens.size() < 3) || (tokens[0].size() < 3) || (tokens[0][0] != '(')) {
+    return false;
+  }
+
+  stamp = strtod(tokens[0].c_str() + 1, NULL);
+
+  ifName = tokens[1];
+
+  const string & text = tokens[2];
+
+  size_t hash = text.find('#');
+
+  if((hash == string::npos) || (hash == 0) || (hash > 8)) {
+    return false;
+  }
+
+  string data = text.substr(hash + 1);
+
+  if(!data.empty() && ((data[0] == 'R') || (data[0] == '#'))) {
+    return false;
+  }
+
+  if(((data.size() % 2) != 0) || (data.size() > 16)) {
+    return false;
+  }
+
+  memset(&frame, 0, sizeof(frame));
+
+  char *end = NULL;
+
+  string id = text.substr(0, hash);
+
+  frame.can_id = (canid_t)strtoul(id.c_str(), &end, 16);
+
+  if(*end != '\0') {
+    return false;
+  }
+
+  /* 3 hex digits is a standard id, 8 is extended */
+
+  if(hash == 8) {
+    frame.can_id |= CAN_EFF_FLAG;
+  } else if((hash != 3) || (frame.can_id > CAN_SFF_MASK)) {
+    return false;
+  }
+
+  frame.can_dlc = data.size() / 2;
+
+  for(int i=0; i<frame.can_dlc; i++) {
+
+    string byte = data.substr(2*i, 2);
+
+    frame.data[i] = (unsigned char)strtoul(byte.c_str(), &end, 16);
+
+    if(*end != '\0') {
+      return false;
+    }
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/* standard destructor */
+
+CANSocket::~CANSocket(void) {
+
+  if(fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
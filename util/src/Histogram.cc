@@ -0,0 +1,156 @@
+#include "Histogram.hh"
+
+/**
+ *
+ * bucketOf() - map a value to its bucket index.
+ *
+ */
+
+int Histogram::bucketOf(uint32_t value) {
+
+  if(value < LINEAR) {
+    return (int)value;
+  }
+
+  /*
+   * find the top bit, then keep SUBBITS bits below it to pick
+   * the linear bucket within that power of two.
+   *
+   */
+
+  int top   = 31 - __builtin_clz(value);
+  int shift = top - SUBBITS;
+  int sub   = (int)(value >> shift) - (1 << SUBBITS);
+
+  return LINEAR + ((shift - 1) << SUBBITS) + sub;
+}
+
+/**
+ *
+ * valueOf() - the highest value that lands in the given
+ * bucket (what we report for percentiles, so we never under
+ * state a latency).
+ *
+ */
+
+uint32_t Histogram::valueOf(int bucket) {
+
+  if(bucket < LINEAR) {
+    return (uint32_t)bucket;
+  }
+
+  int shift = ((bucket - LINEAR) >> SUBBITS) + 1;
+  int sub   = (bucket - LINEAR) & ((1 << SUBBITS) - 1);
+
+  uint64_t low = ((uint64_t)((1 << SUBBITS) + sub)) << shift;
+  uint64_t top = low + (1ULL << shift) - 1;
+
+  if(top > 0xFFFFFFFFULL) {
+    top = 0xFFFFFFFFULL;
+  }
+
+  return (uint32_t)top;
+}
+
+/**
+ *
+ * count() - the number of values recorded so far.
+ *
+ */
+
+uint64_t Histogram::count(void) const {
+
+  uint64_t total = 0;
+
+  for(int i=0; i<BUCKETS; i++) {
+    total += counts[i].load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+/**
+ *
+ * percentile() - fetch the value at the given percentile.
+ *
+ * @param pct double - the percentile (0..100) i.e. 99.0 for p99.
+ *
+ * @return uint32_t - the value, or 0 if nothing has been recorded.
+ *
+ */
+
+uint32_t Histogram::percentile(double pct) const {
+
+  uint64_t total = count();
+
+  if(total == 0) {
+    return 0;
+  }
+
+  if(pct < 0.0) {
+    pct = 0.0;
+  } else if(pct > 100.0) {
+    pct = 100.0;
+  }
+
+  /* the rank we are looking for (1 based) */
+
+  uint64_t rank = (uint64_t)((pct / 100.0) * (double)total + 0.5);
+
+  if(rank < 1) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+
+  for(int i=0; i<BUCKETS; i++) {
+
+    seen += counts[i].load(std::memory_order_relaxed);
+
+    if(seen >= rank) {
+
+      /* never report more than we have actually seen */
+
+      uint32_t value = valueOf(i);
+
+      if(value > max()) {
+        value = max();
+      }
+
+      return value;
+    }
+  }
+
+  return max();
+}
+
+/**
+ *
+ * summary() - one line summary for humans, like:
+ *
+ *   p50: 120 p99: 480 max: 1021 n: 6000
+ *
+ */
+
+string Histogram::summary(void) const {
+
+  return string("p50: ") + to_string(percentile(50.0))
+    + string(" p99: ") + to_string(percentile(99.0))
+    + string(" max: ") + to_string(max())
+    + string(" n: ")   + to_string(count());
+}
+
+/**
+ *
+ * reset() - forget everything recorded so far.
+ *
+ */
+
+void Histogram::reset(void) {
+
+  for(int i=0; i<BUCKETS; i++) {
+    counts[i].store(0, std::memory_order_relaxed);
+  }
+
+  largest.store(0, std::memory_order_relaxed);
+}
@@ -1,5 +1,7 @@
 #include "PortMapper.hh"
 
+#include <algorithm>
+
 /**
  *
  * findFT4232H() - if we are using an FTDI quad cable
@@ -7,11 +9,11 @@
  * mapped in from the USB port.
  *
  * When this call is done devicePaths and cableOrder will
- * be filled in.
+ * be filled in, for deviceNames.
  *
  */
 
-bool PortMapper::findFT4232H(vector<string> & devices) {
+bool PortMapper::findFT4232H(void) {
 
   /*
    * run 'dmesg' to look for the "attached" messages
@@ -76,21 +78,18 @@ bool PortMapper::findFT4232H(vector<string> & devices) {
    *
    */
 
-  for(auto & devEnum : deviceEnums) {
-
-    string device = devEnum.first;
-    Device code   = devEnum.second;
+  for(auto & device : deviceNames) {
 
-    if(cableOrder.count(code) == 0) {
+    if(cableOrder.count(device) == 0) {
 
       warning(string("findFT4232H() - Can't find cable for device: ") + device);
       continue;
     }
 
-    int cable         = cableOrder[code];
-    string terminal   = terminals[cable-1];
+    int cable           = cableOrder[device];
+    string terminal     = terminals[cable-1];
 
-    devicePaths[code] = string("/dev/") + terminal;
+    devicePaths[device] = string("/dev/") + terminal;
   }
 
   /*
@@ -118,8 +117,9 @@ bool PortMapper::configure(void) {
   unReady();
 
   devicePaths.clear();
+  fixedPaths.clear();
   cableOrder.clear();
-  deviceEnums.clear();
+  deviceNames.clear();
 
   /*
    * figure out our general configuration
@@ -162,32 +162,31 @@ bool PortMapper::configure(void) {
   }
 
   /*
-   * map the devices to known enums, and make sure device names
-   * are sanitized.
+   * the DL-32 and SoloDL have to be there, anything else is an extra
+   * device on one of the spare ports (see [ECU Bridge] sinks).
    *
    */
 
   for(auto & devName : devices) {
 
-    if(devName == "dl32") {
-
-      deviceEnums[devName] = Device::DL32;
-
-    } else if(devName == "solodl") {
-
-      deviceEnums[devName] = Device::SOLODL;
+    if(std::find(deviceNames.begin(), deviceNames.end(), devName) != deviceNames.end()) {
+      warning(string("configure() - device listed twice: ") + devName);
+      continue;
+    }
 
-    } else {
+    deviceNames.push_back(devName);
+  }
 
-      warning(string("configure() - unknown device: ") + devName);
+  for(auto & code : { Device::DL32, Device::SOLODL }) {
 
+    if(std::find(deviceNames.begin(), deviceNames.end(), deviceName(code)) == deviceNames.end()) {
+      warning(string("configure() - device not listed: ") + deviceName(code));
     }
-
   }
 
   /* map out the device slots */
 
-  for(auto & devName : devices) {
+  for(auto & devName : deviceNames) {
 
     value = ini.getValue(devName, "usb_slot");
     if(is_numeric(value)) {
@@ -201,13 +200,13 @@ bool PortMapper::configure(void) {
 
       /* make sure we don't have conflicting slots */
 
-      if(cableOrder.count(deviceEnums[devName])) {
+      if(cableOrder.count(devName)) {
 
         warning(string("configure() - device (") + devName + ") already has a usb_slot (ignoring).");
         continue;
       }
 
-      for (map<Device,int>::iterator it = cableOrder.begin(); it != cableOrder.end(); ++it) {
+      for (map<string,int>::iterator it = cableOrder.begin(); it != cableOrder.end(); ++it) {
 
         if (it->second == slot) {
 
@@ -218,7 +217,7 @@ bool PortMapper::configure(void) {
         }
       }
 
-      cableOrder[deviceEnums[devName]] = slot;
+      cableOrder[devName] = slot;
 
     } else {
 
@@ -239,11 +238,31 @@ bool PortMapper::configure(void) {
    *
    */
 
-  if(cable == "ft4232h") {
+  /*
+   * a device can also be given a fixed path (the "device" setting in
+   * its section), i.e. a pty from the replay tool or simulator.  If
+   * they all are, we don't need the cable at all.
+   *
+   */
+
+  for(auto & devName : deviceNames) {
+
+    string path = trim(ini.getValue(devName, "device"));
+
+    if(!path.empty()) {
+      fixedPaths[devName] = path;
+    }
+  }
+
+  if(fixedPaths.size() == deviceNames.size()) {
+
+    info("configure() - all devices have fixed paths, not scanning for the cable.");
+
+  } else if(cable == "ft4232h") {
 
     info("configure() - scanning for ft4232h cable devices...");
 
-    if(!findFT4232H(devices)) {
+    if(!findFT4232H()) {
       error("configure() - can not map out FTDI devices.");
       return false;
     }
@@ -254,6 +273,10 @@ bool PortMapper::configure(void) {
     return false;
   }
 
+  for(auto & fixed : fixedPaths) {
+    devicePaths[fixed.first] = fixed.second;
+  }
+
   /*
    * at this point the devices have been mapped and we should
    * be ready for use.
@@ -266,9 +289,9 @@ bool PortMapper::configure(void) {
 
   info(".");
 
-  for(auto & devName : devices) {
+  for(auto & devName : deviceNames) {
 
-    string path = devicePaths[deviceEnums[devName]];
+    string path = devicePaths[devName];
 
     info(string(" . ") + devName + string(" => ") + path);
   }
@@ -0,0 +1,215 @@
+#include "PseudoTerminal.hh"
+
+#include <string.h>
+
+/**
+ *
+ * PseudoTerminal() - create the pty pair, the slave is put in raw
+ * mode so nothing we write is echoed or mangled.
+ *
+ * @param link string - if not empty, make this a symlink to the
+ * slave (replacing any old symlink).
+ *
+ */
+
+PseudoTerminal::PseudoTerminal(const string & link) :
+  Object("PseudoTerminal"), master(-1), slave(-1), slaveName(""), linkName("") {
+
+  unReady();
+
+  /* posix_openpt() rather than openpty(), so we don't need the system libutil */
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+
+  if(master < 0) {
+    error(string("can not open a pty: ") + strerror(errno));
+    return;
+  }
+
+  if((grantpt(master) != 0) || (unlockpt(master) != 0)) {
+    error(string("can not unlock pty: ") + strerror(errno));
+    return;
+  }
+
+  char *name = ptsname(master);
+
+  if(name == NULL) {
+    error(string("can not get pty name: ") + strerror(errno));
+    return;
+  }
+
+  slaveName = name;
+
+  slave = open(slaveName.c_str(), O_RDWR | O_NOCTTY);
+
+  if(slave < 0) {
+    error(string("can not open pty slave ") + slaveName + string(": ") + strerror(errno));
+    return;
+  }
+
+  /* raw, no echo, no line editing, no CR/LF games */
+
+  struct termios options;
+
+  if(tcgetattr(slave, &options) != 0) {
+    error(string("can not get pty options: ") + strerror(errno));
+    return;
+  }
+
+  cfmakeraw(&options);
+
+  if(tcsetattr(slave, TCSANOW, &options) != 0) {
+    error(string("can not set pty options: ") + strerror(errno));
+    return;
+  }
+
+  /* we don't want drain() to ever wait */
+
+  int flags = fcntl(master, F_GETFL, 0);
+
+  if((flags < 0) || (fcntl(master, F_SETFL, flags | O_NONBLOCK) != 0)) {
+    error(string("can not make pty non-blocking: ") + strerror(errno));
+    return;
+  }
+
+  if(!link.empty()) {
+
+    unlink(link.c_str());
+
+    if(symlink(slaveName.c_str(), link.c_str()) != 0) {
+      error(string("can not link ") + link + string(" to ") + slaveName + string(": ") + strerror(errno));
+      return;
+    }
+
+    linkName = link;
+  }
+
+  makeReady();
+
+  info(string("pty ready: ") + slaveName + (linkName.empty() ? string("") : (string(" (") + linkName + string(")"))));
+}
+
+/**
+ *
+ * send() - write all the given bytes to the slave side, waiting if
+ * the pty is full (the program under test is behind).  While waiting
+ * it looks at 'stop' every SendWaitMs, so a program that has stopped
+ * reading can't hang us.
+ *
+ * @param bytes unsigned char array - the bytes.
+ *
+ * @param n size_t - how many.
+ *
+ * @param stop sig_atomic_t pointer - if not NULL, give up (false)
+ * once it's set (i.e. by a signal handler).
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool PseudoTerminal::send(const unsigned char *bytes, size_t n, volatile sig_atomic_t *stop) {
+
+  while(n > 0) {
+
+    if((stop != NULL) && *stop) {
+      error("send() - stopped.");
+      return false;
+    }
+
+    ssize_t wrote = write(master, bytes, n);
+
+    if(wrote < 0) {
+
+      if(errno == EINTR) {
+        continue;
+      }
+
+      if((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+
+        /* full; wait for room (a while at a time) */
+
+        fd_set         fdSet;
+        struct timeval tv;
+
+        FD_ZERO(&fdSet);
+        FD_SET(master, &fdSet);
+
+        tv.tv_sec  = 0;
+        tv.tv_usec = SendWaitMs * 1000;
+
+        select(master+1, (fd_set *)0, &fdSet, (fd_set *)0, &tv);
+
+        continue;
+      }
+
+      error(string("send() - can not write to pty: ") + strerror(errno));
+      return false;
+    }
+
+    bytes += wrote;
+    n     -= (size_t)wrote;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * drain() - read (and throw away) whatever the program under test
+ * wrote to the slave, without waiting.
+ *
+ * @return long - the # of bytes drained, -1 on error.
+ *
+ */
+
+long PseudoTerminal::drain(void) {
+
+  unsigned char buf[1024];
+  long          total = 0;
+
+  while(true) {
+
+    ssize_t got = read(master, buf, sizeof(buf));
+
+    if(got > 0) {
+      total += got;
+      continue;
+    }
+
+    if((got < 0) && (errno == EINTR)) {
+      continue;
+    }
+
+    if((got < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+      break;
+    }
+
+    if(got == 0) {
+      break;
+    }
+
+    error(string("drain() - can not read from pty: ") + strerror(errno));
+    return -1;
+  }
+
+  return total;
+}
+
+/* standard destructor */
+
+PseudoTerminal::~PseudoTerminal(void) {
+
+  if(!linkName.empty()) {
+    unlink(linkName.c_str());
+  }
+
+  if(slave >= 0) {
+    close(slave);
+  }
+
+  if(master >= 0) {
+    close(master);
+  }
+}
@@ -1,5 +1,9 @@
 #include "RS232Port.hh"
 
+#include <linux/serial.h>
+#include <limits.h>
+#include <stdlib.h>
+
 
 /**
  *
@@ -300,7 +304,8 @@ bool RS232Port::closePort(void) {
   args     = "";
   mode     = "";
   device   = "";
-  blocking = false;
+  blocking   = false;
+  lowLatency = false;
 
   memset(&oldOptions, 0, sizeof(struct termios));
   memset(&options, 0, sizeof(struct termios));
@@ -312,6 +317,396 @@ bool RS232Port::closePort(void) {
   return true;
 }
 
+/**
+ *
+ * setNonBlocking() - turn O_NONBLOCK on (or off) for the open port,
+ * so read() returns right away (EAGAIN) when there is nothing there.
+ *
+ * @param on bool - true for non-blocking.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool RS232Port::setNonBlocking(bool on) {
+
+  if(fd < 0) {
+    error("setNonBlocking() - port is not open.");
+    return false;
+  }
+
+  int flags = fcntl(fd, F_GETFL, 0);
+
+  if(flags < 0) {
+    error(string("setNonBlocking() - can not get port flags: ") + strerror(errno));
+    return false;
+  }
+
+  if(on) {
+    flags |= O_NONBLOCK;
+  } else {
+    flags &= ~O_NONBLOCK;
+  }
+
+  if(fcntl(fd, F_SETFL, flags) != 0) {
+    error(string("setNonBlocking() - can not set port flags: ") + strerror(errno));
+    return false;
+  }
+
+  blocking = !on;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * outputQueued() - how many bytes we've written that are still
+ * waiting in the kernel to go out (TIOCOUTQ).
+ *
+ * @return long - the # of bytes, -1 on error.
+ *
+ */
+
+long RS232Port::outputQueued(void) {
+
+  if(fd < 0) {
+    error("outputQueued() - port is not open.");
+    return -1;
+  }
+
+  int queued = 0;
+
+  if(ioctl(fd, TIOCOUTQ, &queued) != 0) {
+    error(string("outputQueued() - can not get output queue: ") + strerror(errno));
+    return -1;
+  }
+
+  return (long)queued;
+}
+
+/**
+ *
+ * flushOutput() - throw away anything written that hasn't gone out
+ * yet (tcflush(TCOFLUSH)).
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool RS232Port::flushOutput(void) {
+
+  if(fd < 0) {
+    error("flushOutput() - port is not open.");
+    return false;
+  }
+
+  if(tcflush(fd, TCOFLUSH) != 0) {
+    error(string("flushOutput() - can not flush: ") + strerror(errno));
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * setLowLatency() - ask the serial driver to hand us received bytes
+ * right away (ASYNC_LOW_LATENCY via TIOCSSERIAL) instead of batching
+ * them up.  Not every driver supports it.
+ *
+ * @param on bool - true for low latency.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool RS232Port::setLowLatency(bool on) {
+
+  if(fd < 0) {
+    error("setLowLatency() - port is not open.");
+    return false;
+  }
+
+  struct serial_struct serial;
+
+  memset(&serial, 0, sizeof(serial));
+
+  if(ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+    error(string("setLowLatency() - can not get serial settings: ") + strerror(errno));
+    return false;
+  }
+
+  if(on) {
+    serial.flags |= ASYNC_LOW_LATENCY;
+  } else {
+    serial.flags &= ~ASYNC_LOW_LATENCY;
+  }
+
+  if(ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+    error(string("setLowLatency() - can not set serial settings: ") + strerror(errno));
+    return false;
+  }
+
+  lowLatency = on;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * latencyTimerFile() - (helper) the sysfs latency_timer file for the
+ * given device, i.e. /dev/ttyUSB1 (or a symlink to it) is
+ * /sys/bus/usb-serial/devices/ttyUSB1/latency_timer.
+ *
+ */
+
+static string latencyTimerFile(const string & device) {
+
+  char real[PATH_MAX];
+
+  string path = device;
+
+  if(realpath(device.c_str(), real) != NULL) {
+    path = real;
+  }
+
+  size_t slash = path.find_last_of('/');
+
+  if(slash != string::npos) {
+    path = path.substr(slash+1);
+  }
+
+  return string("/sys/bus/usb-serial/devices/") + path + string("/latency_timer");
+}
+
+/**
+ *
+ * setLatencyTimer() - program the USB serial adapter's latency timer
+ * (/sys/bus/usb-serial/devices/<tty>/latency_timer), this is how long
+ * an FTDI chip holds on to a partly full buffer before sending it to
+ * us; 16ms out of the box.  Only FTDI style adapters have one.
+ *
+ * @param ms int - 1..255 milliseconds.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool RS232Port::setLatencyTimer(int ms) {
+
+  if((ms < 1) || (ms > 255)) {
+    error(string("setLatencyTimer() - latency timer must be 1..255 ms, not: ") + to_string(ms));
+    return false;
+  }
+
+  string fileName = latencyTimerFile(device);
+
+  FILE *fp = fopen(fileName.c_str(), "w");
+
+  if(fp == NULL) {
+    error(string("setLatencyTimer() - can not open ") + fileName + string(": ") + strerror(errno));
+    return false;
+  }
+
+  int wrote = fprintf(fp, "%d\n", ms);
+
+  if((fclose(fp) != 0) || (wrote < 0)) {
+    error(string("setLatencyTimer() - can not write ") + fileName + string(": ") + strerror(errno));
+    return false;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * getLatencyTimer() - read back the adapter's latency timer (ms),
+ * -1 if it doesn't have one (or we can't read it).
+ *
+ */
+
+int RS232Port::getLatencyTimer(void) {
+
+  FILE *fp = fopen(latencyTimerFile(device).c_str(), "r");
+
+  if(fp == NULL) {
+    return -1;
+  }
+
+  int ms = -1;
+
+  if(fscanf(fp, "%d", &ms) != 1) {
+    ms = -1;
+  }
+
+  fclose(fp);
+
+  return ms;
+}
+
+/**
+ *
+ * setReadTiming() - set VMIN/VTIME; a blocking read() waits for 'vmin'
+ * bytes, or until the line has been quiet for 'vtime' tenths of a
+ * second.  (Non-blocking reads ignore both.)
+ *
+ * @param vmin int - 0..255 bytes.
+ *
+ * @param vtime int - 0..255 tenths of a second.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool RS232Port::setReadTiming(int vmin, int vtime) {
+
+  if(fd < 0) {
+    error("setReadTiming() - port is not open.");
+    return false;
+  }
+
+  if((vmin < 0) || (vmin > 255) || (vtime < 0) || (vtime > 255)) {
+    error(string("setReadTiming() - vmin/vtime must be 0..255, not: ") + to_string(vmin) + string("/") + to_string(vtime));
+    return false;
+  }
+
+  struct termios newOptions = options;
+
+  newOptions.c_cc[VMIN]  = (cc_t)vmin;
+  newOptions.c_cc[VTIME] = (cc_t)vtime;
+
+  if(tcsetattr(fd, TCSANOW, &newOptions) != 0) {
+    error(string("setReadTiming() - can not set options on port: ") + device);
+    return false;
+  }
+
+  options = newOptions;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * configureLatency() - apply the latency settings from the given
+ * section of the configuration, all optional:
+ *
+ *   low_latency   - true/false, ASYNC_LOW_LATENCY
+ *   latency_timer - 1..255 ms, the adapter's latency timer
+ *   vmin, vtime   - read timing for blocking reads (a non-blocking
+ *                   port doesn't use them, and says so)
+ *
+ * Settings the port/driver doesn't support are only warned about,
+ * the port still works, just not as quickly.
+ *
+ * @param section string - the .ini section (i.e. "dl32")
+ *
+ * @return bool - exactly false if a setting is invalid.
+ *
+ */
+
+bool RS232Port::configureLatency(const string & section) {
+
+  IniFile & ini = ConfigManager::instance();
+
+  if(!ini.isReady()) {
+
+    /* no configuration, nothing to do */
+
+    return true;
+  }
+
+  if(ini.enabled(section, "low_latency")) {
+    if(!setLowLatency(true)) {
+      warning(string("configureLatency() - [") + section + string("] low_latency not supported by this port."));
+    }
+  }
+
+  string tmp = trim(ini.getValue(section, "latency_timer"));
+
+  if(!tmp.empty()) {
+
+    if(!is_numeric(tmp)) {
+      error(string("configureLatency() - [") + section + string("] latency_timer must be a number (ms): ") + tmp);
+      return false;
+    }
+
+    int ms = (int)strtol(tmp.c_str(), NULL, 10);
+
+    if((ms < 1) || (ms > 255)) {
+      error(string("configureLatency() - [") + section + string("] latency_timer must be 1..255 ms, not: ") + tmp);
+      return false;
+    }
+
+    if(!setLatencyTimer(ms)) {
+      warning(string("configureLatency() - [") + section + string("] can not set latency_timer on ") + device + string(" (not an FTDI adapter?)"));
+    }
+  }
+
+  string vminStr  = trim(ini.getValue(section, "vmin"));
+  string vtimeStr = trim(ini.getValue(section, "vtime"));
+
+  if(!vminStr.empty() || !vtimeStr.empty()) {
+
+    int vmin  = options.c_cc[VMIN];
+    int vtime = options.c_cc[VTIME];
+
+    if(!vminStr.empty()) {
+      vmin = is_numeric(vminStr) ? (int)strtol(vminStr.c_str(), NULL, 10) : -1;
+    }
+
+    if(!vtimeStr.empty()) {
+      vtime = is_numeric(vtimeStr) ? (int)strtol(vtimeStr.c_str(), NULL, 10) : -1;
+    }
+
+    if(!setReadTiming(vmin, vtime)) {
+      error(string("configureLatency() - [") + section + string("] bad vmin/vtime."));
+      return false;
+    }
+
+    if(!blocking) {
+      warning(string("configureLatency() - [") + section + string("] vmin/vtime have no effect, ") + device + string(" is non-blocking."));
+    }
+  }
+
+  info(string("configureLatency() - ") + device + string(" ") + describeLatency());
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * describeLatency() - human readable summary of the effective
+ * latency settings, i.e. "low latency: on, latency timer: 1 ms,
+ * vmin: 12, vtime: 1"; a non-blocking port doesn't use vmin/vtime,
+ * so it just says "non-blocking" instead.
+ *
+ */
+
+string RS232Port::describeLatency(void) {
+
+  int    ms    = getLatencyTimer();
+  string timer = (ms < 0) ? string("n/a") : (to_string(ms) + string(" ms"));
+
+  string reads = blocking ?
+    (string(", vmin: ") + to_string((int)options.c_cc[VMIN]) + string(", vtime: ") + to_string((int)options.c_cc[VTIME])) :
+    string(", non-blocking");
+
+  return string("low latency: ") + (lowLatency ? string("on") : string("off"))
+    + string(", latency timer: ") + timer + reads;
+}
+
 /**
  *
  * waitForBytes() - sit on the port and wait for data to arrive...
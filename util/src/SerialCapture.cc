@@ -0,0 +1,224 @@
+#include "SerialCapture.hh"
+
+#include <algorithm>
+#include <string.h>
+
+static const char CaptureMagic[8] = { 'E', 'C', 'U', 'C', 'A', 'P', '0', '1' };
+
+/**
+ *
+ * create() - start a new capture file (replacing any old one).
+ *
+ * @param fileName string - the capture file.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialCapture::create(const string & fileName) {
+
+  close();
+
+  fp = fopen(fileName.c_str(), "wb");
+
+  if(fp == NULL) {
+    error(string("create() - can not create capture file ") + fileName + string(": ") + strerror(errno));
+    return false;
+  }
+
+  if(fwrite(CaptureMagic, sizeof(CaptureMagic), 1, fp) != 1) {
+    error(string("create() - can not write capture file ") + fileName + string(": ") + strerror(errno));
+    close();
+    return false;
+  }
+
+  writing = true;
+  records = 0;
+
+  makeReady();
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * append() - record one read's worth of bytes.
+ *
+ * @param stamp uint64_t - when the bytes were read.
+ *
+ * @param bytes unsigned char array - the bytes.
+ *
+ * @param n size_t - how many (reads of more than 64k are split).
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialCapture::append(uint64_t stamp, const unsigned char *bytes, size_t n) {
+
+  if(!isReady() || !writing) {
+    error("append() - capture is not open for writing.");
+    return false;
+  }
+
+  while(n > 0) {
+
+    uint16_t length = (uint16_t)std::min(n, (size_t)0xFFFF);
+
+    if((fwrite(&stamp, sizeof(stamp), 1, fp) != 1) ||
+       (fwrite(&length, sizeof(length), 1, fp) != 1) ||
+       (fwrite(bytes, length, 1, fp) != 1)) {
+
+      error(string("append() - can not write capture: ") + strerror(errno));
+      close();
+      return false;
+    }
+
+    records++;
+
+    bytes += length;
+    n     -= length;
+  }
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * openRead() - open an existing capture to play it back.
+ *
+ * @param fileName string - the capture file.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialCapture::openRead(const string & fileName) {
+
+  close();
+
+  fp = fopen(fileName.c_str(), "rb");
+
+  if(fp == NULL) {
+    error(string("openRead() - can not open capture file ") + fileName + string(": ") + strerror(errno));
+    return false;
+  }
+
+  char magic[sizeof(CaptureMagic)];
+
+  if((fread(magic, sizeof(magic), 1, fp) != 1) || (memcmp(magic, CaptureMagic, sizeof(magic)) != 0)) {
+    error(string("openRead() - not a capture file: ") + fileName);
+    close();
+    return false;
+  }
+
+  writing = false;
+  records = 0;
+
+  makeReady();
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * next() - read the next record.
+ *
+ * @param stamp uint64_t - when the bytes were read.
+ *
+ * @param bytes vector - the bytes.
+ *
+ * @return bool - exactly false at the end of the capture (or on
+ * error, i.e. a truncated record; then isReady() is false too).
+ *
+ */
+
+bool SerialCapture::next(uint64_t & stamp, vector<unsigned char> & bytes) {
+
+  if(!isReady() || writing) {
+    error("next() - capture is not open for reading.");
+    return false;
+  }
+
+  uint16_t length = 0;
+
+  size_t got = fread(&stamp, 1, sizeof(stamp), fp);
+
+  if(got == 0) {
+
+    /* the end */
+
+    return false;
+  }
+
+  if((got != sizeof(stamp)) || (fread(&length, sizeof(length), 1, fp) != 1)) {
+    setError("next() - capture ends part way through a record.");
+    unReady();
+    return false;
+  }
+
+  bytes.resize(length);
+
+  if((length > 0) && (fread(&bytes[0], length, 1, fp) != 1)) {
+    setError("next() - capture ends part way through a record.");
+    unReady();
+    return false;
+  }
+
+  records++;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * rewind() - (reading) go back to the first record.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool SerialCapture::rewind(void) {
+
+  if(!isReady() || writing) {
+    error("rewind() - capture is not open for reading.");
+    return false;
+  }
+
+  if(fseek(fp, sizeof(CaptureMagic), SEEK_SET) != 0) {
+    error(string("rewind() - can not seek: ") + strerror(errno));
+    return false;
+  }
+
+  records = 0;
+
+  /* all done */
+
+  return true;
+}
+
+/**
+ *
+ * close() - finish up (flushes a capture being written).
+ *
+ */
+
+void SerialCapture::close(void) {
+
+  if(fp != NULL) {
+    fclose(fp);
+    fp = NULL;
+  }
+
+  writing = false;
+
+  unReady();
+}
@@ -0,0 +1,222 @@
+#include "Tracer.hh"
+
+#include <sys/syscall.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+
+Tracer *Tracer::tracer = NULL;
+
+thread_local TraceRing *Tracer::local = NULL;
+
+/* standard constructor */
+
+Tracer::Tracer(void) : Object("Tracer") {
+
+}
+
+/**
+ *
+ * instance() - fetch the one (and only) tracer.
+ *
+ */
+
+Tracer & Tracer::instance(void) {
+
+  static std::once_flag once;
+
+  std::call_once(once, []() { tracer = new Tracer(); });
+
+  return *tracer;
+}
+
+/**
+ *
+ * attach() - give the calling thread a ring to record into.  If
+ * a ring by that name already exists (i.e. a restarted thread)
+ * it is re-used, so we never grow without bound.
+ *
+ * @param name string - the thread name, shown in the dump.
+ *
+ */
+
+void Tracer::attach(const string & name) {
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  int tid = (int)syscall(SYS_gettid);
+
+  for(size_t i=0; i<rings.size(); i++) {
+
+    if(rings[i]->name == name) {
+
+      rings[i]->tid = tid;
+      local         = rings[i];
+
+      return;
+    }
+  }
+
+  TraceRing *ring = new TraceRing();
+
+  ring->name = name;
+  ring->tid  = tid;
+  ring->head = 0;
+
+  rings.push_back(ring);
+
+  local = ring;
+
+  info(string("attach() - tracing thread: ") + name);
+}
+
+/**
+ *
+ * clear() - throw away everything recorded so far.  Only safe
+ * when the traced threads aren't running, otherwise records
+ * being written right now may survive.
+ *
+ */
+
+void Tracer::clear(void) {
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  for(size_t i=0; i<rings.size(); i++) {
+    rings[i]->head = 0;
+  }
+}
+
+/**
+ *
+ * dump() - write everything in the rings to a Chrome/Perfetto
+ * trace JSON file.  Safe to call while the traced threads are
+ * running; records that were overwritten while we were copying
+ * are dropped.
+ *
+ * @param fileName string - where to write the trace.
+ *
+ * @param count size_t - the # of records written.
+ *
+ * @return bool - exactly false on error.
+ *
+ */
+
+bool Tracer::dump(const string & fileName, size_t & count) {
+
+  count = 0;
+
+  if(fileName.empty()) {
+    error("dump() - no file name.");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  /*
+   * snapshot each ring; the owner keeps writing while we copy, so
+   * note the head before and after, anything that the owner may
+   * have lapped in between is suspect and gets dropped.
+   *
+   */
+
+  vector< vector<TraceRecord> > copies(rings.size());
+
+  uint64_t origin = 0;
+
+  for(size_t r=0; r<rings.size(); r++) {
+
+    TraceRing *ring = rings[r];
+
+    uint32_t before = ring->head.load(std::memory_order_acquire);
+    uint32_t first  = (before > TraceRing::SIZE) ? (before - TraceRing::SIZE) : 0;
+
+    vector<TraceRecord> & copy = copies[r];
+
+    copy.reserve(before - first);
+
+    for(uint32_t i=first; i<before; i++) {
+      copy.push_back(ring->records[i & TraceRing::MASK]);
+    }
+
+    uint32_t after  = ring->head.load(std::memory_order_acquire);
+    uint32_t lapped = (after > TraceRing::SIZE) ? (after - TraceRing::SIZE) : 0;
+
+    if(lapped > first) {
+
+      size_t drop = std::min((size_t)(lapped - first), copy.size());
+
+      copy.erase(copy.begin(), copy.begin() + drop);
+    }
+
+    for(size_t i=0; i<copy.size(); i++) {
+      if((origin == 0) || (copy[i].start < origin)) {
+        origin = copy[i].start;
+      }
+    }
+  }
+
+  /* write it out, times are in microseconds from the first record */
+
+  ofstream out(fileName.c_str(), ios::out | ios::trunc);
+
+  if(!out.is_open()) {
+    error(string("dump() - can not open trace file: ") + fileName + string(": ") + strerror(errno));
+    return false;
+  }
+
+  int  pid   = (int)getpid();
+  bool first = true;
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+  for(size_t r=0; r<rings.size(); r++) {
+
+    /* name the thread */
+
+    out << (first ? "\n" : ",\n");
+    first = false;
+
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+        << ",\"tid\":" << rings[r]->tid
+        << ",\"args\":{\"name\":\"" << rings[r]->name << "\"}}";
+
+    vector<TraceRecord> & copy = copies[r];
+
+    for(size_t i=0; i<copy.size(); i++) {
+
+      const TraceRecord & record = copy[i];
+
+      if((record.stage == NULL) || (record.end < record.start)) {
+        continue;
+      }
+
+      char line[256];
+
+      snprintf(line, sizeof(line),
+        ",\n{\"name\":\"%s\",\"cat\":\"ecubridge\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        record.stage, pid, rings[r]->tid,
+        (double)(record.start - origin) / 1000.0,
+        (double)(record.end - record.start) / 1000.0);
+
+      out << line;
+
+      count++;
+    }
+  }
+
+  out << "\n]}\n";
+
+  out.close();
+
+  if(out.fail()) {
+    error(string("dump() - problem writing trace file: ") + fileName);
+    return false;
+  }
+
+  info(string("dump() - wrote ") + to_string(count) + string(" trace records to: ") + fileName);
+
+  /* all done */
+
+  return true;
+}
@@ -767,3 +767,23 @@ bool file(string fileName, vector<string> & results) {
 
   return true;
 }
+
+/**
+ *
+ * monotonic_ns() - fetch the current CLOCK_MONOTONIC time in
+ * nanoseconds.  Unlike gettimeofday() this clock is never stepped
+ * by NTP or the RTC, so it is what we use for any kind of cycle
+ * timing or deadline math.
+ *
+ * @return uint64_t - nanoseconds since some unspecified start point.
+ *
+ */
+
+uint64_t monotonic_ns(void) {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
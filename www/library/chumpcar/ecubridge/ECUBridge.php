@@ -404,6 +404,74 @@ class chumpcar_ecubridge_ECUBridge
     return $results;
   }
   
+  /**
+   * 
+   * curve() - fetch a channel's whole transfer function, what it
+   * does to every DL-32 value from 0 to 4095 (or every $step'th
+   * one), in one go.  Each row is:
+   * 
+   *   input, normal, output
+   * 
+   * @param $channel integer - the (output) channel, 1..15.
+   * 
+   * @param $step integer - (Optional) only every $step'th input.
+   * 
+   * @return mixed - exactly false on error, otherwise the rows.
+   * 
+   */
+  
+  public function curve($channel, $step=1) {
+    
+    if(!$this->isReady()) {
+      $this->error("curve() - not ready.");
+      return false;
+    }
+    
+    if(!is_numeric($channel) || ($channel < 1) || ($channel > 15)) {
+      $this->error("curve() - channel must be in the range 1..15: $channel");
+      return false;
+    }
+    
+    if(!is_numeric($step) || ($step < 1)) {
+      $this->error("curve() - step must be 1 or more: $step");
+      return false;
+    }
+    
+    $channel = (int)$channel;
+    $step    = (int)$step;
+    
+    $details = $this->doCommand("channels,curve,$channel,$step");
+    
+    if(!$details) {
+      $this->error("curve() - could not get the curve: ".$this->getError());
+      return false;
+    }
+    
+    $results = array();
+    
+    foreach($details as $idx => $line) {
+      
+      $line = trim($line);
+      
+      if(empty($line)) {
+        continue;
+      }
+      
+      if(strpos($line, "ERROR") === 0) {
+        $this->error("curve() - $line");
+        return false;
+      }
+      
+      $cols = explode(',', $line);
+      
+      $results[] = array((int)$cols[0], (int)$cols[1], (int)$cols[2]);
+    }
+    
+    /* pass it back */
+    
+    return $results;
+  }
+  
   /**
    * 
    * resetPatch() - reset the patch ording to whatever it was
@@ -0,0 +1,94 @@
+<?php
+
+/**
+ *
+ * Curve - a channel's transfer function, for plotting.
+ *
+ * @package chumpcar
+ *
+ * @author Little m Design (Michael Garvin)
+ * @copyright Copyright (c) 2016-, Little m Design
+ *
+ */
+
+{ /* make sure we can auto-load */
+
+  if(strtoupper(substr(PHP_OS, 0, 3)) === 'WIN')
+  { $DS = "\\"; } else { $DS = "/";}
+
+  $path = dirname(__FILE__); while(!empty($path)) {
+    if(is_readable($path.$DS."configure.php")) {
+      require_once($path.$DS."configure.php"); break;
+    }
+    $path = dirname($path);
+  }
+}
+
+autorequire('littlemdesign\web\http\Resource');
+autorequire('chumpcar\ecubridge\ECUBridge');
+
+/**
+ *
+ * Curve - let the GUI plot what a channel does to every DL-32
+ * value (?channel=N, and optionally &step=N for fewer points).
+ *
+ */
+
+class Curve extends Resource {
+
+  public function __construct() {
+    parent::__construct("Curve");
+  }
+
+  public function get() {
+
+    $jsonObj = (object)array(
+      "data"   => "",
+      "status" => "OK",
+      "error"  => ""
+    );
+
+    $channel = $this->arg("channel");
+    $step    = $this->arg("step");
+
+    if(($step === false) || empty($step)) {
+      $step = 16;
+    }
+
+    $cmdr = new ECUBridge;
+
+    if(!$cmdr->isReady()) {
+      $jsonObj->status = "ERROR";
+      $jsonObj->error  = "Can't make ECUBridge: ".$cmdr->getError();
+      return json_encode($jsonObj);
+    }
+
+    $rows = $cmdr->curve($channel, $step);
+
+    if(!$rows) {
+      $jsonObj->status = "ERROR";
+      $jsonObj->error  = "Can't get channel curve: ".$cmdr->getError();
+      return json_encode($jsonObj);
+    }
+
+    $results = array();
+
+    foreach($rows as $idx => $row) {
+
+      $results[] = (object)array(
+        "input"  => $row[0],
+        "normal" => $row[1],
+        "output" => $row[2]
+      );
+    }
+
+    $jsonObj->data = $results;
+
+    /* all done, pass it back */
+
+    return json_encode($jsonObj);
+  }
+
+}
+
+?>